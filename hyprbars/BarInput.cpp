@@ -0,0 +1,119 @@
+#include "BarInput.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// Matches VECINRECT: both edges are inside.
+static bool inRect(SBarPoint p, float x1, float y1, float x2, float y2) {
+    return p.x >= x1 && p.x <= x2 && p.y >= y1 && p.y <= y2;
+}
+
+float barContentY(float barHeight, float contentHeight, eBarContentAlign align, float offset) {
+    float y = (barHeight - contentHeight) / 2.F;
+    if (align == eBarContentAlign::TOP)
+        y = 0.F;
+    else if (align == eBarContentAlign::BOTTOM)
+        y = barHeight - contentHeight;
+
+    y += offset;
+
+    return std::clamp(y, -contentHeight, barHeight);
+}
+
+SBarPoint barButtonPos(const SBarButtonLayout& layout, float buttonSize, float offset) {
+    const float X = layout.buttonsRight ? layout.barWidth - layout.buttonPadding - buttonSize - offset : offset;
+    return {std::floor(X), std::floor(barContentY(layout.barHeight, buttonSize, layout.align, layout.alignOffset))};
+}
+
+std::optional<size_t> barButtonAt(const SBarButtonLayout& layout, const std::vector<float>& buttonSizes, SBarPoint point) {
+    float offset = layout.padding;
+    for (size_t i = 0; i < buttonSizes.size(); ++i) {
+        const auto POS = barButtonPos(layout, buttonSizes[i], offset);
+        if (inRect(point, POS.x, POS.y, POS.x + buttonSizes[i] + layout.buttonPadding, POS.y + buttonSizes[i]))
+            return i;
+
+        offset += layout.buttonPadding + buttonSizes[i];
+    }
+
+    return std::nullopt;
+}
+
+SBarDown barPointerDown(SBarInputState& state, const SBarButtonLayout& layout, const std::vector<float>& buttonSizes, SBarPoint point, std::optional<int> touchId,
+                        double nowMs, bool doubleClickBound) {
+    state.touch = touchId.has_value();
+    if (touchId)
+        state.touchId = *touchId;
+
+    SBarDown down;
+    if (!inRect(point, 0.F, 0.F, layout.barWidth, layout.barHeight - 1)) {
+        down.endedDrag      = state.dragging;
+        down.touch          = state.touch;
+        state.dragging      = false;
+        state.dragPending   = false;
+        state.touch         = false;
+        return down;
+    }
+
+    state.cancelledDown = true;
+
+    if (const auto BUTTON = barButtonAt(layout, buttonSizes, point)) {
+        down.result = eBarDownResult::BUTTON;
+        down.button = *BUTTON;
+        return down;
+    }
+
+    // Arbitrary delay found suitable.
+    if (doubleClickBound && nowMs - state.lastDownMs < 400.0) {
+        down.result       = eBarDownResult::DOUBLE_CLICK;
+        state.dragPending = false;
+        return down;
+    }
+
+    down.result       = eBarDownResult::DRAG_PENDING;
+    state.lastDownMs  = nowMs;
+    state.dragPending = true;
+    return down;
+}
+
+SBarUp barPointerUp(SBarInputState& state, bool focused) {
+    if (!focused)
+        return {};
+
+    const SBarUp UP = {.consume = state.cancelledDown, .endedDrag = state.dragging, .touch = state.touch};
+
+    state.cancelledDown = false;
+    state.dragging      = false;
+    state.dragPending   = false;
+    state.touch         = false;
+    state.touchId       = 0;
+    return UP;
+}
+
+SBarUp barTouchUp(SBarInputState& state, int touchId, bool focused) {
+    if (!state.dragPending || !state.touch || touchId != state.touchId)
+        return {};
+
+    return barPointerUp(state, focused);
+}
+
+bool barAcceptsTouch(int touchId) {
+    return touchId == 0;
+}
+
+bool barPointerMotion(SBarInputState& state) {
+    if (!state.dragPending || state.touch || state.touchId != 0)
+        return false;
+
+    state.dragPending = false;
+    state.dragging    = true;
+    return true;
+}
+
+eBarTouchMotion barTouchMotion(SBarInputState& state, int touchId) {
+    if (!state.dragPending || !state.touch || touchId != state.touchId)
+        return eBarTouchMotion::IGNORED;
+
+    const bool STARTED = !state.dragging;
+    state.dragging     = true;
+    return STARTED ? eBarTouchMotion::DRAG_START : eBarTouchMotion::DRAG_MOVE;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+// Bar input decisions, kept free of compositor state so recorded input can
+// be replayed against mocked bars. CHyprBar carries out what they decide.
+
+enum class eBarContentAlign {
+    CENTER = 0,
+    TOP,
+    BOTTOM,
+};
+
+// y of content contentHeight tall inside a bar barHeight tall.
+float barContentY(float barHeight, float contentHeight, eBarContentAlign align, float offset);
+
+struct SBarButtonLayout {
+    float            barWidth      = 0.F;
+    float            barHeight     = 0.F;
+    float            padding       = 0.F; // bar_padding
+    float            buttonPadding = 0.F; // bar_button_padding
+    bool             buttonsRight  = true;
+    eBarContentAlign align         = eBarContentAlign::CENTER;
+    float            alignOffset   = 0.F; // bar_content_vertical_offset
+};
+
+struct SBarPoint {
+    float x = 0.F;
+    float y = 0.F;
+};
+
+// Top-left of a button of buttonSize placed `offset` from the bar's button
+// edge, in unscaled bar-local pixels.
+SBarPoint barButtonPos(const SBarButtonLayout& layout, float buttonSize, float offset);
+
+// Index of the button under the bar-local point, in config order. A button's
+// hit area includes the padding that follows it.
+std::optional<size_t> barButtonAt(const SBarButtonLayout& layout, const std::vector<float>& buttonSizes, SBarPoint point);
+
+struct SBarInputState {
+    bool   dragPending   = false;
+    bool   dragging      = false;
+    bool   touch         = false;
+    int    touchId       = 0;
+    bool   cancelledDown = false;
+    double lastDownMs    = -1e9; // steady clock
+};
+
+enum class eBarDownResult {
+    OUTSIDE = 0,  // not on this bar; any drag ended
+    BUTTON,       // run the button's command
+    DOUBLE_CLICK, // run on_double_click
+    DRAG_PENDING, // a drag starts with the next motion
+};
+
+struct SBarDown {
+    eBarDownResult result    = eBarDownResult::OUTSIDE;
+    size_t         button    = 0;
+    bool           endedDrag = false; // a drag was running and has to be ended
+    bool           touch     = false; // the drag that ended was a touch drag
+};
+
+// A pointer press (no touchId) or touch down at the bar-local point.
+SBarDown barPointerDown(SBarInputState& state, const SBarButtonLayout& layout, const std::vector<float>& buttonSizes, SBarPoint point, std::optional<int> touchId,
+                        double nowMs, bool doubleClickBound);
+
+struct SBarUp {
+    bool consume   = false; // the press was cancelled, so its release is too
+    bool endedDrag = false; // a drag was running and has to be ended
+    bool touch     = false; // the drag that ended was a touch drag
+};
+
+// Pointer release. Only the bar of the focused window handles it.
+SBarUp barPointerUp(SBarInputState& state, bool focused);
+
+// Touch up. Only the touch point that pressed the bar releases it.
+SBarUp barTouchUp(SBarInputState& state, int touchId, bool focused);
+
+// Bars take only the first finger, so a second one can't grab another window.
+bool barAcceptsTouch(int touchId);
+
+// Pointer motion. True if it turns a pending press into a drag.
+bool barPointerMotion(SBarInputState& state);
+
+enum class eBarTouchMotion {
+    IGNORED = 0,
+    DRAG_START, // first motion: set the window up for dragging, then move it
+    DRAG_MOVE,
+};
+
+eBarTouchMotion barTouchMotion(SBarInputState& state, int touchId);
@@ -15,12 +15,40 @@
 #include <algorithm>
 
 #include "globals.hpp"
+#include "BarInput.hpp"
 #include "BarPassElement.hpp"
 
 namespace {
 uint32_t barEdgeFromConfig(const std::string& edge) {
     return edge == "bottom" ? DECORATION_EDGE_BOTTOM : DECORATION_EDGE_TOP;
 }
+
+eBarContentAlign contentAlignFromConfig(const std::string& align) {
+    if (align == "top")
+        return eBarContentAlign::TOP;
+    if (align == "bottom")
+        return eBarContentAlign::BOTTOM;
+    return eBarContentAlign::CENTER;
+}
+
+double steadyMs() {
+    return std::chrono::duration<double, std::milli>(Time::steadyNow().time_since_epoch()).count();
+}
+
+// bar_color and title_color share one cache. A config normally names a
+// handful of colors; the cap only matters if something keeps feeding the
+// rules new ones, and then starting over is cheap.
+CHyprColor internRuleColor(const std::string& str) {
+    auto& colors = g_pGlobalState->ruleColors;
+    if (colors.size() >= 256 && !colors.contains(str))
+        colors.clear();
+
+    auto [it, inserted] = colors.try_emplace(str);
+    if (inserted)
+        it->second = CHyprColor(configStringToInt(str).value_or(0));
+
+    return it->second;
+}
 }
 
 uint32_t CHyprBar::getBarEdge() const {
@@ -59,7 +87,30 @@ CBox CHyprBar::getResolvedBarBox(const bool includeWorkspaceOffset) const {
 Vector2D CHyprBar::getButtonLogicalPos(const float barWidth, const float barHeight, const float buttonSize, const float offset, const float buttonPadding,
                                        const bool buttonsRight) const {
     // bar/button values are in logical (unscaled) pixels; callers can scale the result where needed.
-    return Vector2D{buttonsRight ? barWidth - buttonPadding - buttonSize - offset : offset, getBarContentY(barHeight, buttonSize)}.floor();
+    auto layout          = getButtonLayout(barWidth);
+    layout.barHeight     = barHeight;
+    layout.buttonPadding = buttonPadding;
+    layout.buttonsRight  = buttonsRight;
+
+    const auto POS = barButtonPos(layout, buttonSize, offset);
+    return {POS.x, POS.y};
+}
+
+SBarButtonLayout CHyprBar::getButtonLayout(const float barWidth) const {
+    static auto* const PHEIGHT           = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_height")->getDataStaticPtr();
+    static auto* const PBARBUTTONPADDING = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_button_padding")->getDataStaticPtr();
+    static auto* const PBARPADDING       = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_padding")->getDataStaticPtr();
+    static auto* const PALIGNBUTTONS     = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_buttons_alignment")->getDataStaticPtr();
+    static auto* const PVERTICALALIGN    = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_content_v_align")->getDataStaticPtr();
+    static auto* const PVERTICALOFFSET   = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_content_vertical_offset")->getDataStaticPtr();
+
+    return {.barWidth      = barWidth,
+            .barHeight     = static_cast<float>(**PHEIGHT),
+            .padding       = static_cast<float>(**PBARPADDING),
+            .buttonPadding = static_cast<float>(**PBARBUTTONPADDING),
+            .buttonsRight  = std::string{*PALIGNBUTTONS} != "left",
+            .align         = contentAlignFromConfig(*PVERTICALALIGN),
+            .alignOffset   = static_cast<float>(**PVERTICALOFFSET)};
 }
 
 CHyprBar::CHyprBar(PHLWINDOW pWindow) : IHyprWindowDecoration(pWindow) {
@@ -178,7 +229,7 @@ void CHyprBar::onMouseButton(SCallbackInfo& info, IPointer::SButtonEvent e) {
         return;
 
     if (e.state != WL_POINTER_BUTTON_STATE_PRESSED) {
-        handleUpEvent(info);
+        handleUpEvent(info, barPointerUp(m_input, m_pWindow.lock() == Desktop::focusState()->window()));
         return;
     }
 
@@ -187,17 +238,14 @@ void CHyprBar::onMouseButton(SCallbackInfo& info, IPointer::SButtonEvent e) {
 
 void CHyprBar::onTouchDown(SCallbackInfo& info, ITouch::SDownEvent e) {
     // Don't do anything if you're already grabbed a window with another finger
-    if (!inputIsValid() || e.touchID != 0)
+    if (!inputIsValid() || !barAcceptsTouch(e.touchID))
         return;
 
     handleDownEvent(info, e);
 }
 
 void CHyprBar::onTouchUp(SCallbackInfo& info, ITouch::SUpEvent e) {
-    if (!m_bDragPending || !m_bTouchEv || e.touchID != m_touchId)
-        return;
-
-    handleUpEvent(info);
+    handleUpEvent(info, barTouchUp(m_input, e.touchID, m_pWindow.lock() == Desktop::focusState()->window()));
 }
 
 void CHyprBar::onMouseMove(Vector2D coords) {
@@ -206,22 +254,25 @@ void CHyprBar::onMouseMove(Vector2D coords) {
     if (**PICONONHOVER)
         damageOnButtonHover();
 
-    if (!m_bDragPending || m_bTouchEv || !validMapped(m_pWindow) || m_touchId != 0)
+    if (!validMapped(m_pWindow) || !barPointerMotion(m_input))
         return;
 
-    m_bDragPending = false;
     handleMovement();
 }
 
 void CHyprBar::onTouchMove(SCallbackInfo& info, ITouch::SMotionEvent e) {
-    if (!m_bDragPending || !m_bTouchEv || !validMapped(m_pWindow) || e.touchID != m_touchId)
+    if (!validMapped(m_pWindow))
+        return;
+
+    const auto MOTION = barTouchMotion(m_input, e.touchID);
+    if (MOTION == eBarTouchMotion::IGNORED)
         return;
 
     auto PMONITOR     = m_pWindow->m_monitor.lock();
     PMONITOR          = PMONITOR ? PMONITOR : Desktop::focusState()->monitor();
     const auto COORDS = Vector2D(PMONITOR->m_position.x + e.pos.x * PMONITOR->m_size.x, PMONITOR->m_position.y + e.pos.y * PMONITOR->m_size.y);
 
-    if (!m_bDraggingThis) {
+    if (MOTION == eBarTouchMotion::DRAG_START) {
         // Initial setup for dragging a window.
         g_pKeybindManager->m_dispatchers["setfloating"]("activewindow");
         g_pKeybindManager->m_dispatchers["resizewindowpixel"]("exact 50% 50%,activewindow");
@@ -229,45 +280,37 @@ void CHyprBar::onTouchMove(SCallbackInfo& info, ITouch::SMotionEvent e) {
         g_pKeybindManager->m_dispatchers["pin"]("activewindow");
     }
     g_pKeybindManager->m_dispatchers["movewindowpixel"](std::format("exact {} {},activewindow", (int)(COORDS.x - (assignedBoxGlobal().w / 2)), (int)COORDS.y));
-    m_bDraggingThis = true;
 }
 
 void CHyprBar::handleDownEvent(SCallbackInfo& info, std::optional<ITouch::SDownEvent> touchEvent) {
-    m_bTouchEv = touchEvent.has_value();
-    if (m_bTouchEv)
-        m_touchId = touchEvent.value().touchID;
-
     const auto PWINDOW = m_pWindow.lock();
 
     auto       COORDS = cursorRelativeToBar();
-    if (m_bTouchEv) {
+    if (touchEvent) {
         ITouch::SDownEvent e        = touchEvent.value();
         auto               PMONITOR = g_pCompositor->getMonitorFromName(!e.device->m_boundOutput.empty() ? e.device->m_boundOutput : "");
         PMONITOR                    = PMONITOR ? PMONITOR : Desktop::focusState()->monitor();
         COORDS = Vector2D(PMONITOR->m_position.x + e.pos.x * PMONITOR->m_size.x, PMONITOR->m_position.y + e.pos.y * PMONITOR->m_size.y) - assignedBoxGlobal().pos();
     }
 
-    static auto* const PHEIGHT           = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_height")->getDataStaticPtr();
-    static auto* const PBARBUTTONPADDING = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_button_padding")->getDataStaticPtr();
-    static auto* const PBARPADDING       = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_padding")->getDataStaticPtr();
-    static auto* const PALIGNBUTTONS     = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_buttons_alignment")->getDataStaticPtr();
-    static auto* const PONDOUBLECLICK    = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:on_double_click")->getDataStaticPtr();
-
-    const bool         BUTTONSRIGHT    = std::string{*PALIGNBUTTONS} != "left";
+    static auto* const PONDOUBLECLICK = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:on_double_click")->getDataStaticPtr();
     const std::string  ON_DOUBLE_CLICK = *PONDOUBLECLICK;
 
-    if (!VECINRECT(COORDS, 0, 0, assignedBoxGlobal().w, **PHEIGHT - 1)) {
+    std::vector<float> buttonSizes;
+    buttonSizes.reserve(g_pGlobalState->buttons.size());
+    for (const auto& b : g_pGlobalState->buttons)
+        buttonSizes.push_back(b.size);
 
-        if (m_bDraggingThis) {
-            if (m_bTouchEv)
+    const auto DOWN = barPointerDown(m_input, getButtonLayout(static_cast<float>(assignedBoxGlobal().w)), buttonSizes, {(float)COORDS.x, (float)COORDS.y},
+                                     touchEvent ? std::optional<int>{touchEvent->touchID} : std::nullopt, steadyMs(), !ON_DOUBLE_CLICK.empty());
+
+    if (DOWN.result == eBarDownResult::OUTSIDE) {
+        if (DOWN.endedDrag) {
+            if (DOWN.touch)
                 g_pKeybindManager->m_dispatchers["settiled"]("activewindow");
             g_pKeybindManager->m_dispatchers["mouse"]("0movewindow");
             Log::logger->log(Log::DEBUG, "[hyprbars] Dragging ended on {:x}", (uintptr_t)PWINDOW.get());
         }
-
-        m_bDraggingThis = false;
-        m_bDragPending  = false;
-        m_bTouchEv      = false;
         return;
     }
 
@@ -277,72 +320,33 @@ void CHyprBar::handleDownEvent(SCallbackInfo& info, std::optional<ITouch::SDownE
     if (PWINDOW->m_isFloating)
         g_pCompositor->changeWindowZOrder(PWINDOW, true);
 
-    info.cancelled   = true;
-    m_bCancelledDown = true;
-
-    if (doButtonPress(PBARPADDING, PBARBUTTONPADDING, PHEIGHT, COORDS, BUTTONSRIGHT))
-        return;
+    info.cancelled = true;
 
-    if (!ON_DOUBLE_CLICK.empty() &&
-        std::chrono::duration_cast<std::chrono::milliseconds>(Time::steadyNow() - m_lastMouseDown).count() < 400 /* Arbitrary delay I found suitable */) {
+    if (DOWN.result == eBarDownResult::BUTTON)
+        g_pKeybindManager->m_dispatchers["exec"](g_pGlobalState->buttons[DOWN.button].cmd);
+    else if (DOWN.result == eBarDownResult::DOUBLE_CLICK)
         g_pKeybindManager->m_dispatchers["exec"](ON_DOUBLE_CLICK);
-        m_bDragPending = false;
-    } else {
-        m_lastMouseDown = Time::steadyNow();
-        m_bDragPending  = true;
-    }
 }
 
-void CHyprBar::handleUpEvent(SCallbackInfo& info) {
-    if (m_pWindow.lock() != Desktop::focusState()->window())
-        return;
-
-    if (m_bCancelledDown)
+void CHyprBar::handleUpEvent(SCallbackInfo& info, const SBarUp& up) {
+    if (up.consume)
         info.cancelled = true;
 
-    m_bCancelledDown = false;
-
-    if (m_bDraggingThis) {
+    if (up.endedDrag) {
         g_pKeybindManager->m_dispatchers["mouse"]("0movewindow");
-        m_bDraggingThis = false;
-        if (m_bTouchEv)
+        if (up.touch)
             g_pKeybindManager->m_dispatchers["settiled"]("activewindow");
 
         Log::logger->log(Log::DEBUG, "[hyprbars] Dragging ended on {:x}", (uintptr_t)m_pWindow.lock().get());
     }
-
-    m_bDragPending = false;
-    m_bTouchEv     = false;
-    m_touchId      = 0;
 }
 
 void CHyprBar::handleMovement() {
     g_pKeybindManager->m_dispatchers["mouse"]("1movewindow");
-    m_bDraggingThis = true;
     Log::logger->log(Log::DEBUG, "[hyprbars] Dragging initiated on {:x}", (uintptr_t)m_pWindow.lock().get());
     return;
 }
 
-bool CHyprBar::doButtonPress(Hyprlang::INT* const* PBARPADDING, Hyprlang::INT* const* PBARBUTTONPADDING, Hyprlang::INT* const* PHEIGHT, Vector2D COORDS, const bool BUTTONSRIGHT) {
-    //check if on a button
-    float offset = **PBARPADDING;
-    const auto barWidth = static_cast<float>(assignedBoxGlobal().w);
-    const auto barHeight = static_cast<float>(**PHEIGHT);
-
-    for (auto& b : g_pGlobalState->buttons) {
-        Vector2D currentPos = getButtonLogicalPos(barWidth, barHeight, b.size, offset, static_cast<float>(**PBARBUTTONPADDING), BUTTONSRIGHT);
-
-        if (VECINRECT(COORDS, currentPos.x, currentPos.y, currentPos.x + b.size + **PBARBUTTONPADDING, currentPos.y + b.size)) {
-            // hit on close
-            g_pKeybindManager->m_dispatchers["exec"](b.cmd);
-            return true;
-        }
-
-        offset += **PBARBUTTONPADDING + b.size;
-    }
-    return false;
-}
-
 void CHyprBar::renderText(SP<CTexture> out, const std::string& text, const CHyprColor& color, const Vector2D& bufferSize, const float scale, const int fontSize) {
     const auto CAIROSURFACE = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, bufferSize.x, bufferSize.y);
     const auto CAIRO        = cairo_create(CAIROSURFACE);
@@ -408,17 +412,7 @@ float CHyprBar::getBarContentY(const float barHeight, const float contentHeight)
     static auto* const PVERTICALALIGN  = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_content_v_align")->getDataStaticPtr();
     static auto* const PVERTICALOFFSET = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_content_vertical_offset")->getDataStaticPtr();
 
-    const auto align = std::string{*PVERTICALALIGN};
-
-    float      y = (barHeight - contentHeight) / 2.F;
-    if (align == "top")
-        y = 0.F;
-    else if (align == "bottom")
-        y = barHeight - contentHeight;
-
-    y += **PVERTICALOFFSET;
-
-    return std::clamp(y, -contentHeight, barHeight);
+    return barContentY(barHeight, contentHeight, contentAlignFromConfig(*PVERTICALALIGN), static_cast<float>(**PVERTICALOFFSET));
 }
 
 void CHyprBar::renderBarTitle(const Vector2D& bufferSize, const float scale) {
@@ -825,26 +819,35 @@ PHLWINDOW CHyprBar::getOwner() {
     return m_pWindow.lock();
 }
 
-void CHyprBar::updateRules() {
-    const auto PWINDOW              = m_pWindow.lock();
-    auto       prevHidden           = m_hidden;
-    auto       prevForcedTitleColor = m_bForcedTitleColor;
+bool CHyprBar::updateRules() {
+    const auto PWINDOW = m_pWindow.lock();
+    const auto& props  = PWINDOW->m_ruleApplicator->m_otherProps.props;
+
+    SRuleSnapshot snapshot;
+    if (const auto it = props.find(g_pGlobalState->nobarRuleIdx); it != props.end())
+        snapshot.noBar = it->second->effect;
+    if (const auto it = props.find(g_pGlobalState->barColorRuleIdx); it != props.end())
+        snapshot.barColor = it->second->effect;
+    if (const auto it = props.find(g_pGlobalState->titleColorRuleIdx); it != props.end())
+        snapshot.titleColor = it->second->effect;
 
-    m_bForcedBarColor   = std::nullopt;
-    m_bForcedTitleColor = std::nullopt;
-    m_hidden            = false;
+    if (snapshot == m_ruleSnapshot)
+        return false;
 
-    if (PWINDOW->m_ruleApplicator->m_otherProps.props.contains(g_pGlobalState->nobarRuleIdx))
-        m_hidden = truthy(PWINDOW->m_ruleApplicator->m_otherProps.props.at(g_pGlobalState->nobarRuleIdx)->effect);
-    if (PWINDOW->m_ruleApplicator->m_otherProps.props.contains(g_pGlobalState->barColorRuleIdx))
-        m_bForcedBarColor = CHyprColor(configStringToInt(PWINDOW->m_ruleApplicator->m_otherProps.props.at(g_pGlobalState->barColorRuleIdx)->effect).value_or(0));
-    if (PWINDOW->m_ruleApplicator->m_otherProps.props.contains(g_pGlobalState->titleColorRuleIdx))
-        m_bForcedTitleColor = CHyprColor(configStringToInt(PWINDOW->m_ruleApplicator->m_otherProps.props.at(g_pGlobalState->titleColorRuleIdx)->effect).value_or(0));
+    m_ruleSnapshot = std::move(snapshot);
+
+    auto prevHidden           = m_hidden;
+    auto prevForcedTitleColor = m_bForcedTitleColor;
+
+    m_hidden            = m_ruleSnapshot.noBar && truthy(*m_ruleSnapshot.noBar);
+    m_bForcedBarColor   = m_ruleSnapshot.barColor ? std::optional{internRuleColor(*m_ruleSnapshot.barColor)} : std::nullopt;
+    m_bForcedTitleColor = m_ruleSnapshot.titleColor ? std::optional{internRuleColor(*m_ruleSnapshot.titleColor)} : std::nullopt;
 
     if (prevHidden != m_hidden)
         g_pDecorationPositioner->repositionDeco(this);
     if (prevForcedTitleColor != m_bForcedTitleColor)
         m_bTitleColorChanged = true;
+    return true;
 }
 
 void CHyprBar::damageOnButtonHover() {
@@ -10,6 +10,7 @@
 #include <hyprland/src/helpers/AnimatedVariable.hpp>
 #include <hyprland/src/helpers/time/Time.hpp>
 #include "globals.hpp"
+#include "BarInput.hpp"
 
 #define private public
 #include <hyprland/src/managers/input/InputManager.hpp>
@@ -42,7 +43,8 @@ class CHyprBar : public IHyprWindowDecoration {
 
     PHLWINDOW                          getOwner();
 
-    void                               updateRules();
+    // Returns whether any bar rule changed since the last call.
+    bool                               updateRules();
 
     WP<CHyprBar>                       m_self;
 
@@ -65,7 +67,14 @@ class CHyprBar : public IHyprWindowDecoration {
     std::optional<CHyprColor> m_bForcedBarColor;
     std::optional<CHyprColor> m_bForcedTitleColor;
 
-    Time::steady_tp           m_lastMouseDown = Time::steadyNow();
+    // Raw rule effects from the last updateRules, for change detection.
+    struct SRuleSnapshot {
+        std::optional<std::string> noBar;
+        std::optional<std::string> barColor;
+        std::optional<std::string> titleColor;
+
+        bool                       operator==(const SRuleSnapshot&) const = default;
+    } m_ruleSnapshot;
 
     PHLANIMVAR<CHyprColor>    m_cRealBarColor;
 
@@ -82,6 +91,7 @@ class CHyprBar : public IHyprWindowDecoration {
     int                       getConfiguredBarWidth() const;
     CBox                      getResolvedBarBox(bool includeWorkspaceOffset) const;
     Vector2D                  getButtonLogicalPos(float barWidth, float barHeight, float buttonSize, float offset, float buttonPadding, bool buttonsRight) const;
+    SBarButtonLayout          getButtonLayout(float barWidth) const;
 
     bool                      inputIsValid();
     void                      onMouseButton(SCallbackInfo& info, IPointer::SButtonEvent e);
@@ -91,9 +101,8 @@ class CHyprBar : public IHyprWindowDecoration {
     void                      onTouchMove(SCallbackInfo& info, ITouch::SMotionEvent e);
 
     void                      handleDownEvent(SCallbackInfo& info, std::optional<ITouch::SDownEvent> touchEvent);
-    void                      handleUpEvent(SCallbackInfo& info);
+    void                      handleUpEvent(SCallbackInfo& info, const SBarUp& up);
     void                      handleMovement();
-    bool doButtonPress(Hyprlang::INT* const* PBARPADDING, Hyprlang::INT* const* PBARBUTTONPADDING, Hyprlang::INT* const* PHEIGHT, Vector2D COORDS, bool BUTTONSRIGHT);
 
     CBox assignedBoxGlobal();
 
@@ -106,11 +115,7 @@ class CHyprBar : public IHyprWindowDecoration {
 
     std::string          m_szLastTitle;
 
-    bool                 m_bDraggingThis  = false;
-    bool                 m_bTouchEv       = false;
-    bool                 m_bDragPending   = false;
-    bool                 m_bCancelledDown = false;
-    int                  m_touchId        = 0;
+    SBarInputState       m_input;
 
     // store hover state for buttons as a bitfield
     unsigned int m_iButtonHoverState = 0;
@@ -2,6 +2,8 @@
 
 #include <hyprland/src/plugins/PluginAPI.hpp>
 #include <hyprland/src/render/Texture.hpp>
+#include <string>
+#include <unordered_map>
 
 inline HANDLE PHANDLE = nullptr;
 
@@ -23,6 +25,9 @@ struct SGlobalState {
     uint32_t                  nobarRuleIdx = 0;
     uint32_t                  barColorRuleIdx = 0;
     uint32_t                  titleColorRuleIdx = 0;
+
+    // Color rule strings parsed once, shared by all windows.
+    std::unordered_map<std::string, CHyprColor> ruleColors;
 };
 
 inline UP<SGlobalState> g_pGlobalState;
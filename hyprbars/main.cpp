@@ -57,8 +57,8 @@ static void onUpdateWindowRules(PHLWINDOW window) {
     if (BARIT == g_pGlobalState->bars.end())
         return;
 
-    (*BARIT)->updateRules();
-    window->updateWindowDecos();
+    if ((*BARIT)->updateRules())
+        window->updateWindowDecos();
 }
 
 Hyprlang::CParseResult onNewButton(const char* K, const char* V) {
@@ -0,0 +1,103 @@
+#include "DragSession.hpp"
+
+#include <hyprland/src/Compositor.hpp>
+#include <hyprland/src/desktop/view/Window.hpp>
+#include <hyprland/src/managers/input/InputManager.hpp>
+#include <algorithm>
+#include <cmath>
+
+static int64_t cellKey(int64_t cx, int64_t cy) {
+    return (cx << 32) ^ (cy & 0xFFFFFFFF);
+}
+
+void CWindowSpatialHash::clear() {
+    m_entries.clear();
+    m_cells.clear();
+    m_seen.clear();
+}
+
+void CWindowSpatialHash::insert(PHLWINDOW pWindow, const CBox& box, size_t z) {
+    const auto IDX = static_cast<uint32_t>(m_entries.size());
+    m_entries.push_back({pWindow, box, z});
+    m_seen.push_back(0);
+
+    const auto X1 = static_cast<int64_t>(std::floor(box.x / CELL_SIZE));
+    const auto Y1 = static_cast<int64_t>(std::floor(box.y / CELL_SIZE));
+    const auto X2 = static_cast<int64_t>(std::floor((box.x + box.w) / CELL_SIZE));
+    const auto Y2 = static_cast<int64_t>(std::floor((box.y + box.h) / CELL_SIZE));
+    for (auto cx = X1; cx <= X2; ++cx) {
+        for (auto cy = Y1; cy <= Y2; ++cy) {
+            m_cells[cellKey(cx, cy)].push_back(IDX);
+        }
+    }
+}
+
+void CWindowSpatialHash::query(const CBox& box, std::vector<const SEntry*>& out) const {
+    if (++m_stamp == 0) {
+        std::ranges::fill(m_seen, 0);
+        m_stamp = 1;
+    }
+
+    const auto X1 = static_cast<int64_t>(std::floor(box.x / CELL_SIZE));
+    const auto Y1 = static_cast<int64_t>(std::floor(box.y / CELL_SIZE));
+    const auto X2 = static_cast<int64_t>(std::floor((box.x + box.w) / CELL_SIZE));
+    const auto Y2 = static_cast<int64_t>(std::floor((box.y + box.h) / CELL_SIZE));
+    for (auto cx = X1; cx <= X2; ++cx) {
+        for (auto cy = Y1; cy <= Y2; ++cy) {
+            const auto IT = m_cells.find(cellKey(cx, cy));
+            if (IT == m_cells.end())
+                continue;
+
+            for (const auto IDX : IT->second) {
+                if (m_seen[IDX] == m_stamp)
+                    continue;
+
+                m_seen[IDX] = m_stamp;
+                if (m_entries[IDX].box.overlaps(box))
+                    out.push_back(&m_entries[IDX]);
+            }
+        }
+    }
+}
+
+void SPillDragSession::snapshot() {
+    const auto PWINDOW = window.lock();
+    neighbours.clear();
+    hasSnapshot   = false;
+    snapshotCount = g_pCompositor->m_windows.size();
+    if (!PWINDOW)
+        return;
+
+    // Goal geometry: neighbours re-tiling around a window that just went
+    // floating are snapshotted where they will settle.
+    for (size_t z = 0; z < g_pCompositor->m_windows.size(); ++z) {
+        const auto& w = g_pCompositor->m_windows[z];
+        if (w == PWINDOW) {
+            ownerZ = z;
+            continue;
+        }
+
+        if (!w || w->isHidden() || !w->m_isMapped || !w->m_workspace || !w->m_workspace->isVisible() || w->m_monitor != PWINDOW->m_monitor)
+            continue;
+
+        neighbours.insert(w, CBox{w->m_realPosition->goal() + w->m_floatingOffset, w->m_realSize->goal()}, z);
+    }
+
+    hasSnapshot = true;
+}
+
+bool SPillDragSession::stillValid() const {
+    const auto PWINDOW = window.lock();
+    if (!PWINDOW || !PWINDOW->m_isMapped)
+        return false;
+
+    // Moving between workspaces or monitors mid-drag ends the session.
+    if (PWINDOW->m_workspace != workspace.lock() || !PWINDOW->m_workspace || !PWINDOW->m_workspace->isVisible())
+        return false;
+
+    return g_pInputManager->m_exclusiveLSes.empty();
+}
+
+bool SPillDragSession::snapshotCurrent() const {
+    return hasSnapshot && snapshotCount == g_pCompositor->m_windows.size();
+}
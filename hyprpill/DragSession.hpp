@@ -0,0 +1,57 @@
+#pragma once
+
+#include <hyprland/src/desktop/DesktopTypes.hpp>
+#include <hyprland/src/helpers/math/Math.hpp>
+#include <hyprland/src/helpers/time/Time.hpp>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// Buckets window boxes into a coarse grid so a region query only looks at
+// the windows near it.
+class CWindowSpatialHash {
+  public:
+    struct SEntry {
+        PHLWINDOWREF window;
+        CBox         box;
+        size_t       z = 0;
+    };
+
+    void clear();
+    void insert(PHLWINDOW pWindow, const CBox& box, size_t z);
+    // Appends every entry whose box overlaps `box`, each at most once.
+    void query(const CBox& box, std::vector<const SEntry*>& out) const;
+
+  private:
+    static constexpr double                             CELL_SIZE = 256.0;
+
+    std::vector<SEntry>                                 m_entries;
+    std::unordered_map<int64_t, std::vector<uint32_t>> m_cells;
+    mutable std::vector<uint32_t>                       m_seen;
+    mutable uint32_t                                    m_stamp = 0;
+};
+
+// State of one pill drag, from beginDrag until endDrag. Neighbour geometry
+// is snapshotted once the window starts moving, so per-event work does not
+// rescan the compositor.
+struct SPillDragSession {
+    PHLWINDOWREF            window;
+    PHLWORKSPACEREF         workspace;
+    Vector2D                cursorOffset;
+    // Latest touch position, applied once per frame by CHyprPill::flushTouchDrags.
+    std::optional<Vector2D> pendingTouchCoords;
+    // When the oldest of those motion events arrived, for telemetry.
+    std::optional<Time::steady_tp> pendingTouchTime;
+
+    bool                    hasSnapshot   = false;
+    size_t                  snapshotCount = 0;
+    size_t                  ownerZ        = 0;
+    CWindowSpatialHash      neighbours;
+
+    void                    snapshot();
+    // Cheap per-event replacement for CHyprPill::inputIsValid while dragging.
+    bool                    stillValid() const;
+    // Snapshot is stale once a window was mapped or unmapped.
+    bool                    snapshotCurrent() const;
+};
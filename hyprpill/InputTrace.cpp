@@ -0,0 +1,99 @@
+#include "InputTrace.hpp"
+
+#include <cstring>
+#include <format>
+#include <fstream>
+
+namespace {
+    constexpr char     TRACEMAGIC[4] = {'H', 'P', 'T', 'R'};
+    constexpr uint32_t TRACEVERSION  = 2;
+
+    struct STraceHeader {
+        char     magic[4];
+        uint32_t version = TRACEVERSION;
+        uint64_t count   = 0;
+    };
+    static_assert(sizeof(STraceHeader) == 16);
+}
+
+void CInputTrace::start() {
+    m_records.clear();
+    m_windowIds.clear();
+    m_dropped   = 0;
+    m_start     = std::chrono::steady_clock::now();
+    m_recording = true;
+}
+
+bool CInputTrace::recording() const {
+    return m_recording;
+}
+
+void CInputTrace::record(STraceRecord rec) {
+    if (!m_recording)
+        return;
+
+    if (m_records.size() >= CAPACITY) {
+        m_dropped++;
+        return;
+    }
+
+    rec.timeUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count();
+    m_records.push_back(rec);
+}
+
+size_t CInputTrace::size() const {
+    return m_records.size();
+}
+
+size_t CInputTrace::dropped() const {
+    return m_dropped;
+}
+
+uint32_t CInputTrace::windowId(uintptr_t window) {
+    return m_windowIds.try_emplace(window, m_windowIds.size()).first->second;
+}
+
+std::string CInputTrace::stop(const std::string& path) {
+    if (!m_recording)
+        return "not recording";
+
+    m_recording = false;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.good())
+        return std::format("cannot open {} for writing", path);
+
+    STraceHeader header;
+    std::memcpy(header.magic, TRACEMAGIC, sizeof(TRACEMAGIC));
+    header.count = m_records.size();
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(m_records.data()), m_records.size() * sizeof(STraceRecord));
+
+    m_records.clear();
+    m_records.shrink_to_fit();
+
+    return file.good() ? "" : std::format("failed writing {}", path);
+}
+
+std::string CInputTrace::load(const std::string& path, std::vector<STraceRecord>& out) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.good())
+        return std::format("cannot open {}", path);
+
+    STraceHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(header.magic, TRACEMAGIC, sizeof(TRACEMAGIC)) != 0)
+        return std::format("{} is not a hyprpill trace", path);
+
+    if (header.version != TRACEVERSION)
+        return std::format("unsupported trace version {}", header.version);
+
+    if (header.count > CAPACITY)
+        return std::format("trace holds {} records, more than the {} supported", header.count, CAPACITY);
+
+    out.resize(header.count);
+    if (!file.read(reinterpret_cast<char*>(out.data()), out.size() * sizeof(STraceRecord)))
+        return std::format("{} is truncated", path);
+
+    return "";
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class eTraceEvent : uint8_t {
+    MOTION = 0,
+    BUTTON,
+    TOUCH_DOWN,
+    TOUCH_UP,
+    TOUCH_MOTION,
+    WINDOW,
+    LAYOUT,
+    MONITOR,
+};
+
+// WINDOW record state bits.
+constexpr uint8_t TRACE_WINDOW_FLOATING = 1 << 0;
+constexpr uint8_t TRACE_WINDOW_FOCUSED  = 1 << 1;
+
+// One fixed-size record per event. Pointer events carry global layout
+// coordinates in x/y, touch events the normalized position on their monitor.
+// Whenever the layout may have changed a LAYOUT record is followed by one
+// MONITOR record per monitor and one WINDOW record per visible window, bottom
+// of the stack first, which together replace the previous layout. Windows
+// are numbered in the order the trace first saw them, so windows of the same
+// app stay apart.
+struct STraceRecord {
+    uint64_t timeUs   = 0; // since recording started
+    uint32_t id       = 0; // button code, touch id, window or monitor number
+    uint8_t  type     = 0;
+    uint8_t  state    = 0; // button/touch pressed, or TRACE_WINDOW_* bits
+    uint16_t reserved = 0; // a window's monitor number
+    float    x        = 0.F;
+    float    y        = 0.F;
+    float    w        = 0.F;
+    float    h        = 0.F;
+};
+static_assert(sizeof(STraceRecord) == 32);
+
+// Records the input hyprpill routes, in memory, and writes it out as a
+// little header followed by the raw records in host byte order.
+class CInputTrace {
+  public:
+    static constexpr size_t CAPACITY = 1 << 20;
+
+    void                    start();
+    bool                    recording() const;
+    void                    record(STraceRecord rec);
+    size_t                  size() const;
+    size_t                  dropped() const;
+    // This trace's number for window, handed out on first use.
+    uint32_t                windowId(uintptr_t window);
+
+    // Stops recording and writes the trace. Returns an error, or an empty string.
+    std::string             stop(const std::string& path);
+
+    // Returns an error, or an empty string with the records in out.
+    static std::string      load(const std::string& path, std::vector<STraceRecord>& out);
+
+  private:
+    bool                                  m_recording = false;
+    std::chrono::steady_clock::time_point m_start;
+    std::vector<STraceRecord>             m_records;
+    size_t                                m_dropped = 0;
+    std::unordered_map<uintptr_t, uint32_t> m_windowIds;
+};
@@ -0,0 +1,266 @@
+#include "PillBatch.hpp"
+
+#include <hyprland/src/debug/log/Logger.hpp>
+#include <algorithm>
+
+static const char* PILL_VERT_SRC = R"glsl(#version 320 es
+precision highp float;
+
+#define CURVE_SAMPLES 32
+
+layout(location = 0) in vec2 a_corner;
+layout(location = 1) in vec4 a_rect;
+layout(location = 2) in vec4 a_color;
+layout(location = 3) in vec4 a_colorTo;
+layout(location = 4) in vec4 a_round; // from, to, rounding power, curve
+layout(location = 5) in vec2 a_time;  // start, duration (ms)
+
+uniform mat3  u_proj;
+uniform float u_time;
+uniform float u_curves[2 * CURVE_SAMPLES];
+
+out vec2      v_local;
+flat out vec2 v_halfSize;
+flat out vec4 v_color;
+flat out vec2 v_round;
+
+float ease(float t, int curve) {
+    float x = clamp(t, 0.0, 1.0) * float(CURVE_SAMPLES - 1);
+    int   i = min(int(x), CURVE_SAMPLES - 2);
+    return mix(u_curves[curve * CURVE_SAMPLES + i], u_curves[curve * CURVE_SAMPLES + i + 1], x - float(i));
+}
+
+void main() {
+    float t = a_time.y > 0.0 ? ease((u_time - a_time.x) / a_time.y, int(a_round.w)) : 1.0;
+
+    vec2 pos    = a_rect.xy + a_corner * a_rect.zw;
+    v_local     = (a_corner - 0.5) * a_rect.zw;
+    v_halfSize  = a_rect.zw * 0.5;
+    v_color     = mix(a_color, a_colorTo, t);
+    v_round     = vec2(floor(mix(a_round.x, a_round.y, t) + 0.5), a_round.z);
+    gl_Position = vec4((u_proj * vec3(pos, 1.0)).xy, 0.0, 1.0);
+}
+)glsl";
+
+static const char* PILL_FRAG_SRC = R"glsl(#version 320 es
+precision highp float;
+
+in vec2      v_local;
+flat in vec2 v_halfSize;
+flat in vec4 v_color;
+flat in vec2 v_round;
+
+out vec4 fragColor;
+
+void main() {
+    float r = min(v_round.x, min(v_halfSize.x, v_halfSize.y));
+    vec2  q = abs(v_local) - (v_halfSize - r);
+
+    // Superellipse corners, matching Hyprland's rounding_power.
+    vec2  c    = max(q, 0.0);
+    float p    = max(v_round.y, 1.0);
+    float dist = pow(pow(c.x, p) + pow(c.y, p), 1.0 / p) + min(max(q.x, q.y), 0.0) - r;
+
+    float alpha = clamp(0.5 - dist, 0.0, 1.0);
+    if (alpha <= 0.0)
+        discard;
+
+    fragColor = vec4(v_color.rgb * v_color.a, v_color.a) * alpha;
+}
+)glsl";
+
+// Floats per instance: rect (4), color and target color (8), rounding and
+// curve (4), transition timing (2).
+static constexpr size_t INSTANCE_FLOATS = 18;
+static_assert(PILL_CURVE_SAMPLES == 32, "keep CURVE_SAMPLES in the vertex shader in sync");
+
+SPillInstance SPillInstance::resolved(const CPillCurveTable& curves, float nowMs) const {
+    if (durationMs <= 0.F)
+        return *this;
+
+    const float t = evaluatePillCurve(curves, curve, (nowMs - startMs) / durationMs);
+
+    SPillInstance result = *this;
+    result.color         = CHyprColor{color.r + (colorTo.r - color.r) * t, color.g + (colorTo.g - color.g) * t, color.b + (colorTo.b - color.b) * t,
+                                      color.a + (colorTo.a - color.a) * t};
+    result.round         = std::round(round + (roundTo - round) * t);
+    result.durationMs    = 0.F;
+    return result;
+}
+
+static GLuint compileShader(GLenum type, const char* src) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &src, nullptr);
+    glCompileShader(shader);
+
+    GLint compiled = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (!compiled) {
+        char log[512];
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        Log::logger->log(Log::ERR, "[hyprpill] Shader compile error: {}", log);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+bool CPillBatchRenderer::init() {
+    GLuint vert = compileShader(GL_VERTEX_SHADER, PILL_VERT_SRC);
+    GLuint frag = compileShader(GL_FRAGMENT_SHADER, PILL_FRAG_SRC);
+
+    if (!vert || !frag) {
+        if (vert)
+            glDeleteShader(vert);
+        if (frag)
+            glDeleteShader(frag);
+        return false;
+    }
+
+    m_program = glCreateProgram();
+    glAttachShader(m_program, vert);
+    glAttachShader(m_program, frag);
+    glLinkProgram(m_program);
+    glDeleteShader(vert);
+    glDeleteShader(frag);
+
+    GLint linked = 0;
+    glGetProgramiv(m_program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        char log[512];
+        glGetProgramInfoLog(m_program, sizeof(log), nullptr, log);
+        Log::logger->log(Log::ERR, "[hyprpill] Shader link error: {}", log);
+        glDeleteProgram(m_program);
+        m_program = 0;
+        return false;
+    }
+
+    m_projLoc   = glGetUniformLocation(m_program, "u_proj");
+    m_timeLoc   = glGetUniformLocation(m_program, "u_time");
+    m_curvesLoc = glGetUniformLocation(m_program, "u_curves");
+
+    // clang-format off
+    const float corners[] = {
+        0.F, 0.F,
+        1.F, 0.F,
+        1.F, 1.F,
+        0.F, 1.F,
+    };
+    // clang-format on
+
+    glGenVertexArrays(1, &m_vao);
+    glGenBuffers(1, &m_quadVBO);
+    glGenBuffers(1, &m_instanceVBO);
+
+    glBindVertexArray(m_vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    const GLsizei stride = INSTANCE_FLOATS * sizeof(float);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*)0);
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void*)(4 * sizeof(float)));
+    glVertexAttribDivisor(2, 1);
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, (void*)(8 * sizeof(float)));
+    glVertexAttribDivisor(3, 1);
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, stride, (void*)(12 * sizeof(float)));
+    glVertexAttribDivisor(4, 1);
+    glEnableVertexAttribArray(5);
+    glVertexAttribPointer(5, 2, GL_FLOAT, GL_FALSE, stride, (void*)(16 * sizeof(float)));
+    glVertexAttribDivisor(5, 1);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return true;
+}
+
+void CPillBatchRenderer::destroy() {
+    if (m_program)
+        glDeleteProgram(m_program);
+    if (m_vao)
+        glDeleteVertexArrays(1, &m_vao);
+    if (m_quadVBO)
+        glDeleteBuffers(1, &m_quadVBO);
+    if (m_instanceVBO)
+        glDeleteBuffers(1, &m_instanceVBO);
+
+    m_program          = 0;
+    m_vao              = 0;
+    m_quadVBO          = 0;
+    m_instanceVBO      = 0;
+    m_instanceCapacity = 0;
+    m_curvesUploaded   = false;
+    m_uploaded.clear();
+}
+
+void CPillBatchRenderer::render(const std::vector<SPillInstance>& instances, const CRegion& damage, const CPillCurveTable& curves, float nowMs) {
+    if (instances.empty() || m_initFailed)
+        return;
+
+    if (!m_program && !init()) {
+        m_initFailed = true;
+        destroy();
+        return;
+    }
+
+    auto& renderData = g_pHyprOpenGL->m_renderData;
+
+    m_upload.clear();
+    m_upload.reserve(instances.size() * INSTANCE_FLOATS);
+    for (const auto& inst : instances) {
+        CBox box = inst.box;
+        renderData.renderModif.applyToBox(box);
+
+        // Static instances repeat their color and rounding as the target.
+        const bool  ANIMATED = inst.durationMs > 0.F;
+        const auto& TO       = ANIMATED ? inst.colorTo : inst.color;
+        m_upload.insert(m_upload.end(),
+                        {(float)box.x, (float)box.y, (float)box.w, (float)box.h, inst.color.r, inst.color.g, inst.color.b, inst.color.a, TO.r, TO.g, TO.b, TO.a, inst.round,
+                         ANIMATED ? inst.roundTo : inst.round, inst.roundingPower, (float)inst.curve, inst.startMs, ANIMATED ? inst.durationMs : 0.F});
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    if (instances.size() > m_instanceCapacity) {
+        // Grow geometrically so a few windows opening do not reallocate every frame.
+        m_instanceCapacity = std::max(instances.size(), m_instanceCapacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, m_instanceCapacity * INSTANCE_FLOATS * sizeof(float), nullptr, GL_STREAM_DRAW);
+        m_uploaded.clear();
+    }
+    if (m_upload != m_uploaded) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, m_upload.size() * sizeof(float), m_upload.data());
+        m_uploaded.swap(m_upload);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    const auto PROJ = renderData.projection.copy().multiply(renderData.monitorProjection);
+
+    glUseProgram(m_program);
+    glUniformMatrix3fv(m_projLoc, 1, GL_TRUE, PROJ.getMatrix().data());
+    glUniform1f(m_timeLoc, nowMs);
+    if (!m_curvesUploaded || curves != m_uploadedCurves) {
+        glUniform1fv(m_curvesLoc, curves.size(), curves.data());
+        m_uploadedCurves = curves;
+        m_curvesUploaded = true;
+    }
+    glBindVertexArray(m_vao);
+
+    g_pHyprOpenGL->blend(true);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    damage.forEachRect([&](const auto& RECT) {
+        g_pHyprOpenGL->scissor(&RECT);
+        glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, instances.size());
+    });
+    g_pHyprOpenGL->scissor(nullptr);
+
+    glBindVertexArray(0);
+    glUseProgram(0);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <hyprland/src/render/OpenGL.hpp>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "PillMotion.hpp"
+
+// One rounded rect in the batched pill pass, in the same monitor-local
+// coordinates renderRect takes.
+struct SPillInstance {
+    CBox       box;
+    CHyprColor color;
+    float      round         = 0.F;
+    float      roundingPower = 2.F;
+
+    // With durationMs > 0, color and round ease to colorTo and roundTo from
+    // startMs on, timed against the clock passed to the renderer.
+    CHyprColor colorTo;
+    float      roundTo    = 0.F;
+    float      startMs    = 0.F;
+    float      durationMs = 0.F;
+    uint8_t    curve      = 0;
+
+    // This instance as it looks at nowMs, for the non-batched path.
+    SPillInstance resolved(const CPillCurveTable& curves, float nowMs) const;
+};
+
+// Draws every batched pill on a monitor with a single instanced SDF call.
+class CPillBatchRenderer {
+  public:
+    void render(const std::vector<SPillInstance>& instances, const CRegion& damage, const CPillCurveTable& curves, float nowMs);
+    void destroy();
+
+  private:
+    bool               init();
+
+    GLuint             m_program          = 0;
+    GLuint             m_vao              = 0;
+    GLuint             m_quadVBO          = 0;
+    GLuint             m_instanceVBO      = 0;
+    GLint              m_projLoc          = -1;
+    GLint              m_timeLoc          = -1;
+    GLint              m_curvesLoc        = -1;
+    size_t             m_instanceCapacity = 0;
+    bool               m_initFailed       = false;
+
+    // Curves last uploaded; they only change on config reload.
+    CPillCurveTable    m_uploadedCurves   = {};
+    bool               m_curvesUploaded   = false;
+
+    std::vector<float> m_upload;
+    // What the instance buffer holds. Transitions are uploaded once as
+    // from/to/start/duration, so it only changes when one starts or
+    // retargets, or when a pill moves or resizes.
+    std::vector<float> m_uploaded;
+};
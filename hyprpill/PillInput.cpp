@@ -0,0 +1,350 @@
+#include "PillInput.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <linux/input-event-codes.h>
+
+bool SPillRect::contains(double px, double py) const {
+    return px >= x && px <= x + w && py >= y && py <= y + h;
+}
+
+SPillRect pillHitbox(const SPillRect& visible, double padW, double padH, double offsetY) {
+    return {visible.x - padW, std::round(visible.y - padH + offsetY), visible.w + padW * 2.0, visible.h + padH * 2.0};
+}
+
+static bool pastThreshold(double dragThresholdPx, const SPillTarget& pill, double x, double y) {
+    return std::hypot(x - pill.input.dragStartX, y - pill.input.dragStartY) >= std::max(0.0, dragThresholdPx);
+}
+
+std::optional<size_t> pillAt(const SPillRouting& routing, double x, double y, bool click) {
+    const auto HIT = [&](size_t i) {
+        const auto& PILL = routing.pills[i];
+        return PILL.acceptsInput && (click ? PILL.click : PILL.hover).contains(x, y);
+    };
+
+    if (routing.hovered && *routing.hovered < routing.pills.size() && HIT(*routing.hovered))
+        return routing.hovered;
+
+    for (size_t i = 0; i < routing.pills.size(); ++i) {
+        if (HIT(i))
+            return i;
+    }
+
+    return std::nullopt;
+}
+
+SPillMotionRoute routePointerMotion(const SPillRouting& routing, double x, double y) {
+    SPillMotionRoute route;
+    route.target = routing.pointerDrag ? routing.pointerDrag : pillAt(routing, x, y, false);
+    if (routing.hovered && routing.hovered != route.target)
+        route.unhover = routing.hovered;
+
+    if (!route.target)
+        return route;
+
+    const auto& PILL = routing.pills[*route.target];
+
+    // A touch drag owns the pill; the pointer only passes over it.
+    if (PILL.input.touchId) {
+        route.action = ePillMotion::IGNORED;
+        return route;
+    }
+
+    const bool ACTIVEDRAG = PILL.input.dragPending || PILL.input.dragging;
+    if (ACTIVEDRAG ? !PILL.dragValid : !PILL.acceptsInput) {
+        route.action  = ePillMotion::INVALID;
+        route.consume = ACTIVEDRAG;
+        return route;
+    }
+
+    if (PILL.input.dragging) {
+        route.action  = ePillMotion::DRAG_MOVE;
+        route.consume = true;
+        return route;
+    }
+
+    route.hovered = PILL.hover.contains(x, y);
+
+    if (!PILL.input.dragPending) {
+        route.action  = ePillMotion::HOVER;
+        route.consume = route.hovered;
+        return route;
+    }
+
+    route.action  = pastThreshold(routing.dragThresholdPx, PILL, x, y) ? ePillMotion::DRAG_START : ePillMotion::PRESSED;
+    route.consume = true;
+    return route;
+}
+
+SPillButtonRoute routePointerButton(const SPillRouting& routing, uint32_t button, bool pressed, double x, double y, double nowMs) {
+    SPillButtonRoute route;
+
+    if (!pressed) {
+        if (routing.pointerDrag) {
+            route.target = routing.pointerDrag;
+            route.action = ePillButton::RELEASE;
+        }
+        return route;
+    }
+
+    route.target = pillAt(routing, x, y, true);
+    if (!route.target)
+        return route;
+
+    const auto& PILL = routing.pills[*route.target];
+
+    // Held by a touch point.
+    if (PILL.input.touchId)
+        return route;
+
+    switch (button) {
+        case BTN_MIDDLE: route.action = ePillButton::CLOSE; break;
+        case BTN_RIGHT: route.action = PILL.floating ? ePillButton::NONE : ePillButton::PSEUDO; break;
+        case BTN_LEFT:
+            if (nowMs - PILL.input.lastLeftDownMs <= std::max(0.0, routing.doubleClickMs))
+                route.action = ePillButton::TOGGLE_FLOATING;
+            else
+                // One drag per pill, and the pointer drives at most one.
+                route.action = PILL.input.dragPending || PILL.input.dragging || routing.pointerDrag ? ePillButton::CLICK : ePillButton::PRESS;
+            break;
+        default: break;
+    }
+
+    return route;
+}
+
+void touchToGlobal(const SPillRect& monitor, double nx, double ny, double& x, double& y) {
+    x = monitor.x + nx * monitor.w;
+    y = monitor.y + ny * monitor.h;
+}
+
+std::optional<size_t> routeTouchDown(const SPillRouting& routing, int32_t touchId, double nx, double ny) {
+    // The touch point already holds a pill.
+    if (std::ranges::any_of(routing.pills, [touchId](const auto& pill) { return pill.input.touchId == touchId; }))
+        return std::nullopt;
+
+    for (size_t i = 0; i < routing.pills.size(); ++i) {
+        const auto& PILL = routing.pills[i];
+
+        double x = 0.0, y = 0.0;
+        touchToGlobal(PILL.monitor, nx, ny, x, y);
+        if (!PILL.acceptsInput || !PILL.click.contains(x, y))
+            continue;
+
+        // The first pill hit takes the touch, even when it is already dragged.
+        if (PILL.input.dragPending || PILL.input.dragging)
+            return std::nullopt;
+
+        return i;
+    }
+
+    return std::nullopt;
+}
+
+SPillTouchRoute routeTouchMotion(const SPillTarget& pill, double dragThresholdPx, double nx, double ny) {
+    SPillTouchRoute route;
+    if ((!pill.input.dragPending && !pill.input.dragging) || !pill.dragValid) {
+        route.action = ePillMotion::IGNORED;
+        return route;
+    }
+
+    touchToGlobal(pill.monitor, nx, ny, route.x, route.y);
+
+    if (pill.input.dragging)
+        route.action = ePillMotion::DRAG_MOVE;
+    else
+        route.action = pastThreshold(dragThresholdPx, pill, route.x, route.y) ? ePillMotion::DRAG_START : ePillMotion::PRESSED;
+
+    return route;
+}
+
+static SPillEffects press(SPillInputState& state, std::optional<int32_t> touchId, double x, double y, bool floating) {
+    // One drag per pill.
+    if (state.dragPending || state.dragging)
+        return {};
+
+    state.dragPending  = true;
+    state.floatForDrag = !floating;
+    state.touchId      = touchId;
+    state.dragStartX   = x;
+    state.dragStartY   = y;
+    return {.consume = true, .focus = true, .beginDrag = true, .raise = floating};
+}
+
+// The press turned into a drag, or the drag goes on.
+static SPillEffects moveDragged(SPillInputState& state) {
+    SPillEffects effects = {.consume = true, .focus = true, .floatWindow = !state.dragging && state.floatForDrag, .moveWindow = true};
+    state.dragPending    = false;
+    state.dragging       = true;
+    return effects;
+}
+
+static SPillEffects release(SPillInputState& state) {
+    const SPillEffects EFFECTS = {.consume = state.dragPending || state.dragging, .endDrag = true, .retile = state.dragging && state.floatForDrag};
+    state.dragPending          = false;
+    state.dragging             = false;
+    state.floatForDrag         = false;
+    state.touchId.reset();
+    return EFFECTS;
+}
+
+SPillEffects pillClearHover(SPillInputState& state) {
+    const SPillEffects EFFECTS = {.damage = state.hovered};
+    state.hovered              = false;
+    return EFFECTS;
+}
+
+SPillEffects pillPointerMotion(SPillInputState& state, const SPillMotionRoute& route) {
+    switch (route.action) {
+        case ePillMotion::NONE:
+        case ePillMotion::IGNORED: return {};
+        case ePillMotion::INVALID: {
+            auto effects    = pillClearHover(state);
+            effects.consume = route.consume;
+            return effects;
+        }
+        case ePillMotion::DRAG_MOVE: return moveDragged(state);
+        default: break;
+    }
+
+    SPillEffects effects = {.consume = route.consume, .damage = state.hovered != route.hovered};
+    state.hovered        = route.hovered;
+    // Hovering focuses the window; a pending drag keeps it focused.
+    effects.focus = state.hovered || state.dragPending;
+
+    if (route.action != ePillMotion::DRAG_START || !state.dragPending)
+        return effects;
+
+    const auto MOVE     = moveDragged(state);
+    effects.focus       = true;
+    effects.floatWindow = MOVE.floatWindow;
+    effects.moveWindow  = MOVE.moveWindow;
+    return effects;
+}
+
+SPillEffects pillPointerButton(SPillInputState& state, ePillButton action, double x, double y, double nowMs, bool floating) {
+    switch (action) {
+        case ePillButton::NONE: return {};
+        case ePillButton::RELEASE: return release(state);
+        case ePillButton::CLOSE:
+        case ePillButton::PSEUDO: return {.consume = true, .focus = true, .dispatch = action};
+        case ePillButton::TOGGLE_FLOATING: {
+            // So a third click doesn't toggle it back. togglefloating
+            // replaces the retile.
+            const bool DRAG      = state.dragPending || state.dragging;
+            state.lastLeftDownMs = -1e9;
+            auto effects         = release(state);
+            effects.endDrag      = DRAG;
+            effects.consume      = true;
+            effects.focus        = true;
+            effects.retile       = false;
+            effects.dispatch     = action;
+            return effects;
+        }
+        case ePillButton::CLICK: state.lastLeftDownMs = nowMs; return {};
+        case ePillButton::PRESS: state.lastLeftDownMs = nowMs; return press(state, std::nullopt, x, y, floating);
+    }
+
+    return {};
+}
+
+SPillEffects pillTouchDown(SPillInputState& state, int32_t touchId, double x, double y, bool floating) {
+    return press(state, touchId, x, y, floating);
+}
+
+SPillEffects pillTouchMotion(SPillInputState& state, ePillMotion action) {
+    if (action != ePillMotion::DRAG_START && action != ePillMotion::DRAG_MOVE)
+        return {};
+
+    return moveDragged(state);
+}
+
+SPillEffects pillTouchUp(SPillInputState& state) {
+    return release(state);
+}
+
+void recordPointerSample(SPointerHistory& history, double x, double y, double timeMs) {
+    history.samples[history.head] = {.x = x, .y = y, .timeMs = timeMs};
+    history.head                  = (history.head + 1) % history.samples.size();
+    history.count                 = std::min(history.count + 1, history.samples.size());
+}
+
+std::optional<SPointerSample> predictPointer(const SPointerHistory& history, double horizonMs) {
+    constexpr double WINDOWMS = 50.0;
+    constexpr double MINSPEED = 0.05; // px/ms
+    constexpr double MAXSPEED = 5.0;
+
+    const auto& SAMPLES = history.samples;
+    if (history.count < 3)
+        return std::nullopt;
+
+    const auto            AT     = [&](size_t age) -> const SPointerSample& { return SAMPLES[(history.head + SAMPLES.size() - age) % SAMPLES.size()]; };
+    const auto&           NEWEST = AT(1);
+
+    const SPointerSample* oldest = nullptr;
+    for (size_t i = history.count; i >= 2 && !oldest; --i) {
+        if (NEWEST.timeMs - AT(i).timeMs <= WINDOWMS)
+            oldest = &AT(i);
+    }
+
+    if (!oldest)
+        return std::nullopt;
+
+    const double DT = NEWEST.timeMs - oldest->timeMs;
+    if (DT < 1.0)
+        return std::nullopt;
+
+    const double VX    = (NEWEST.x - oldest->x) / DT;
+    const double VY    = (NEWEST.y - oldest->y) / DT;
+    const double SPEED = std::hypot(VX, VY);
+    if (SPEED < MINSPEED || SPEED > MAXSPEED)
+        return std::nullopt;
+
+    return SPointerSample{.x = NEWEST.x + VX * horizonMs, .y = NEWEST.y + VY * horizonMs, .timeMs = NEWEST.timeMs + horizonMs};
+}
+
+bool pillHoverPredicted(const SPillInputState& state, double nowMs) {
+    return state.predictedAtMs && nowMs < state.predictedUntilMs;
+}
+
+bool pillPredictHover(SPillInputState& state, double nowMs, double horizonMs) {
+    const bool WASPREDICTED = pillHoverPredicted(state, nowMs);
+
+    state.predictedUntilMs = nowMs + horizonMs * 2.0;
+    if (WASPREDICTED)
+        return false;
+
+    state.predictedAtMs = nowMs;
+    return true;
+}
+
+SPillPredictionResult pillSettlePrediction(SPillInputState& state, double nowMs) {
+    if (!state.predictedAtMs)
+        return {};
+
+    const bool PREDICTED = pillHoverPredicted(state, nowMs);
+    if (!state.hovered && PREDICTED)
+        return {};
+
+    SPillPredictionResult result = {.result = ePillPrediction::LAPSED};
+    if (state.hovered && PREDICTED)
+        result = {.result = ePillPrediction::CONFIRMED, .leadMs = nowMs - *state.predictedAtMs};
+
+    state.predictedAtMs.reset();
+    return result;
+}
+
+ePillCursor pillCursorAt(const SPillRouting& routing, double x, double y) {
+    if (routing.pointerDrag) {
+        const auto& PILL = routing.pills[*routing.pointerDrag];
+        if (PILL.input.dragPending || PILL.input.dragging)
+            return ePillCursor::GRAB;
+    }
+
+    for (const auto& pill : routing.pills) {
+        if (pill.acceptsCursor && pill.hover.contains(x, y))
+            return ePillCursor::HOVER;
+    }
+
+    return ePillCursor::DEFAULT;
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// Pill input routing and the input state machine, kept free of compositor
+// state so recorded input can be replayed against mocked windows. main.cpp
+// snapshots every pill and asks these functions which pill an event is for
+// and what it means; CHyprPill runs the transition and carries out the
+// effects it returns. The replay runs the same transitions on mock pills.
+
+struct SPillRect {
+    double x = 0.0;
+    double y = 0.0;
+    double w = 0.0;
+    double h = 0.0;
+
+    // Both edges are inside, like VECINRECT.
+    bool   contains(double px, double py) const;
+};
+
+// A hitbox padW and padH around the visible pill, moved down by offsetY.
+SPillRect pillHitbox(const SPillRect& visible, double padW, double padH, double offsetY);
+
+// The input state of one pill. Only the transitions below change it.
+struct SPillInputState {
+    bool                   hovered        = false;
+    bool                   dragPending    = false;
+    bool                   dragging       = false;
+    bool                   floatForDrag   = false; // the window was tiled when the drag began
+    std::optional<int32_t> touchId;                // the touch point holding the pill
+    double                 dragStartX     = 0.0;
+    double                 dragStartY     = 0.0;
+    double                 lastLeftDownMs = -1e9; // steady clock
+    std::optional<double>  predictedAtMs;         // a hover prediction started then
+    double                 predictedUntilMs = 0.0;
+};
+
+// A pill as routing sees it.
+struct SPillTarget {
+    SPillRect       hover;
+    SPillRect       click;
+    SPillRect       monitor;               // touch positions are normalized to it
+    bool            acceptsInput  = false; // inputIsValid()
+    bool            acceptsCursor = false; // inputIsValid(true)
+    bool            floating      = false;
+    bool            dragValid     = false; // a running drag may go on
+    SPillInputState input;
+};
+
+struct SPillRouting {
+    std::vector<SPillTarget> pills; // in creation order
+    std::optional<size_t>    hovered;
+    std::optional<size_t>    pointerDrag;
+    double                   dragThresholdPx = 8.0;
+    double                   doubleClickMs   = 250.0;
+};
+
+// The pill under the point, trying the hovered one first. click picks the
+// click hitbox over the hover one.
+std::optional<size_t> pillAt(const SPillRouting& routing, double x, double y, bool click);
+
+enum class ePillMotion : uint8_t {
+    NONE = 0,   // no pill involved
+    IGNORED,    // a touch point holds the pill
+    INVALID,    // the pill can't take input: drop its hover
+    HOVER,      // update the hover state
+    PRESSED,    // as HOVER, under a press that hasn't moved far enough yet
+    DRAG_START, // as PRESSED, then start moving the window
+    DRAG_MOVE,
+};
+
+struct SPillMotionRoute {
+    std::optional<size_t> target;  // the pill that is hovered from now on
+    std::optional<size_t> unhover; // the previously hovered pill, if it isn't the target
+    ePillMotion           action  = ePillMotion::NONE;
+    bool                  hovered = false; // the target's hover hitbox contains the point
+    bool                  consume = false; // cancel the event
+};
+
+SPillMotionRoute routePointerMotion(const SPillRouting& routing, double x, double y);
+
+enum class ePillButton : uint8_t {
+    NONE = 0,
+    RELEASE,         // end the pointer drag
+    CLOSE,           // killactive
+    PSEUDO,          // pseudo
+    TOGGLE_FLOATING, // togglefloating on a double click
+    CLICK,           // a left click that can't start a drag
+    PRESS,           // a left click that starts a pending drag
+};
+
+struct SPillButtonRoute {
+    std::optional<size_t> target;
+    ePillButton           action = ePillButton::NONE;
+};
+
+// nowMs is on the clock of SPillInputState::lastLeftDownMs.
+SPillButtonRoute routePointerButton(const SPillRouting& routing, uint32_t button, bool pressed, double x, double y, double nowMs);
+
+// Global layout coordinates of a touch position normalized to monitor.
+void touchToGlobal(const SPillRect& monitor, double nx, double ny, double& x, double& y);
+
+// The pill a new touch point starts a drag on.
+std::optional<size_t> routeTouchDown(const SPillRouting& routing, int32_t touchId, double nx, double ny);
+
+struct SPillTouchRoute {
+    ePillMotion action = ePillMotion::NONE; // IGNORED, PRESSED, DRAG_START or DRAG_MOVE
+    double      x      = 0.0;               // global position of the point
+    double      y      = 0.0;
+};
+
+// Motion of the touch point holding pill. Only that pill is involved, so
+// callers look it up by touch id instead of snapshotting every pill.
+SPillTouchRoute routeTouchMotion(const SPillTarget& pill, double dragThresholdPx, double nx, double ny);
+
+// What a transition asks the caller to do, in this order.
+struct SPillEffects {
+    bool        consume     = false;             // cancel the event
+    bool        damage      = false;             // the hover state changed
+    bool        focus       = false;             // focus the pill's window
+    bool        beginDrag   = false;             // start a drag session at the event position
+    bool        raise       = false;             // bring the floating window to the top
+    bool        floatWindow = false;             // float the tiled window on the first drag move
+    bool        moveWindow  = false;             // move the dragged window to the event position
+    bool        endDrag     = false;             // drop the drag session and its ownership
+    bool        retile      = false;             // tile the window the drag floated again
+    ePillButton dispatch    = ePillButton::NONE; // CLOSE, PSEUDO or TOGGLE_FLOATING
+};
+
+// The transitions, one per routed event. x and y are global coordinates.
+SPillEffects pillPointerMotion(SPillInputState& state, const SPillMotionRoute& route);
+// A PRESS that can't start a drag must be passed as a CLICK.
+SPillEffects pillPointerButton(SPillInputState& state, ePillButton action, double x, double y, double nowMs, bool floating);
+SPillEffects pillTouchDown(SPillInputState& state, int32_t touchId, double x, double y, bool floating);
+SPillEffects pillTouchMotion(SPillInputState& state, ePillMotion action);
+SPillEffects pillTouchUp(SPillInputState& state);
+// The pointer left the pill, or the pill stopped taking input.
+SPillEffects pillClearHover(SPillInputState& state);
+
+// Recent pointer motion for hover_prediction.
+struct SPointerSample {
+    double x      = 0.0;
+    double y      = 0.0;
+    double timeMs = 0.0; // steady clock
+};
+
+struct SPointerHistory {
+    std::array<SPointerSample, 4> samples;
+    size_t                        head  = 0;
+    size_t                        count = 0;
+};
+
+void recordPointerSample(SPointerHistory& history, double x, double y, double timeMs);
+
+// Extrapolates the pointer horizonMs ahead from its motion over the last
+// 50ms. Idle pointers and fast flicks are not predicted: the former would
+// only add jitter, the latter mostly fly past the pill.
+std::optional<SPointerSample> predictPointer(const SPointerHistory& history, double horizonMs);
+
+// Shows the hover state ahead of the pointer until 2x horizonMs from now.
+// True if the pill wasn't predicted yet, so a new prediction started.
+bool pillPredictHover(SPillInputState& state, double nowMs, double horizonMs);
+bool pillHoverPredicted(const SPillInputState& state, double nowMs);
+
+enum class ePillPrediction : uint8_t {
+    NONE = 0,  // nothing predicted, or still waiting for the pointer
+    CONFIRMED, // the pointer reached the pill in time
+    LAPSED,    // it didn't; drop the predicted hover
+};
+
+struct SPillPredictionResult {
+    ePillPrediction result = ePillPrediction::NONE;
+    double          leadMs = 0.0; // how long before the real hover it showed
+};
+
+// Called once the hover state is known.
+SPillPredictionResult pillSettlePrediction(SPillInputState& state, double nowMs);
+
+enum class ePillCursor : uint8_t {
+    DEFAULT = 0,
+    HOVER,
+    GRAB,
+};
+
+ePillCursor pillCursorAt(const SPillRouting& routing, double x, double y);
@@ -0,0 +1,151 @@
+#include "PillLayout.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+static bool intervalsOverlap(const SHorizontalInterval& a, const SHorizontalInterval& b) {
+    return a.start < b.end && b.start < a.end;
+}
+
+std::vector<SHorizontalInterval> subtractForbiddenIntervals(const SHorizontalInterval& domain, std::vector<SHorizontalInterval> forbidden) {
+    if (domain.end <= domain.start)
+        return {};
+
+    if (forbidden.empty())
+        return {domain};
+
+    std::sort(forbidden.begin(), forbidden.end(), [](const auto& a, const auto& b) { return a.start < b.start; });
+
+    std::vector<SHorizontalInterval> merged;
+    merged.reserve(forbidden.size());
+    for (const auto& interval : forbidden) {
+        SHorizontalInterval clipped = {std::max(domain.start, interval.start), std::min(domain.end, interval.end)};
+        if (clipped.end <= clipped.start)
+            continue;
+
+        if (!merged.empty() && intervalsOverlap(merged.back(), clipped))
+            merged.back().end = std::max(merged.back().end, clipped.end);
+        else
+            merged.push_back(clipped);
+    }
+
+    std::vector<SHorizontalInterval> allowed;
+    float                           cursor = domain.start;
+    for (const auto& blocked : merged) {
+        if (blocked.start > cursor)
+            allowed.push_back({cursor, blocked.start});
+        cursor = std::max(cursor, blocked.end);
+    }
+
+    if (cursor < domain.end)
+        allowed.push_back({cursor, domain.end});
+
+    return allowed;
+}
+
+SPillPlacement solvePillPlacement(const SHorizontalInterval& window, float centerX, float width, float hitPad, const std::vector<SHorizontalInterval>& occluders) {
+    const float halfW = std::max(0.5F, width / 2.F);
+    SHorizontalInterval domain{window.start + halfW, window.end - halfW};
+    domain.end = std::max(domain.end, domain.start);
+
+    std::vector<SHorizontalInterval> forbidden;
+    forbidden.reserve(occluders.size());
+    const float avoidDistance = hitPad + halfW;
+    for (const auto& occ : occluders)
+        forbidden.push_back({occ.start - avoidDistance, occ.end + avoidDistance});
+
+    const auto allowed = subtractForbiddenIntervals(domain, forbidden);
+    const bool centerAllowed = std::ranges::any_of(allowed, [&](const auto& interval) { return centerX >= interval.start && centerX <= interval.end; });
+
+    bool  dodging        = false;
+    float resolvedCenter = std::clamp(centerX, domain.start, domain.end);
+    if (!allowed.empty()) {
+        if (centerAllowed) {
+            resolvedCenter = std::clamp(centerX, domain.start, domain.end);
+            dodging = false;
+        } else {
+            dodging = true;
+            bool foundLeftOfCenter  = false;
+            bool foundRightOfCenter = false;
+
+            SHorizontalInterval bestLeft;
+            SHorizontalInterval bestRight;
+
+            for (const auto& interval : allowed) {
+                if (interval.end <= centerX) {
+                    if (!foundLeftOfCenter || interval.end > bestLeft.end) {
+                        bestLeft = interval;
+                        foundLeftOfCenter = true;
+                    }
+                } else if (interval.start >= centerX) {
+                    if (!foundRightOfCenter || interval.start < bestRight.start) {
+                        bestRight = interval;
+                        foundRightOfCenter = true;
+                    }
+                }
+            }
+
+            if (foundLeftOfCenter && foundRightOfCenter) {
+                const float leftGap  = bestLeft.end - bestLeft.start;
+                const float rightGap = bestRight.end - bestRight.start;
+
+                if (std::abs(leftGap - rightGap) < 0.001F) {
+                    // Perfectly centered ambiguity prefers left side.
+                    resolvedCenter = bestLeft.end;
+                } else {
+                    resolvedCenter = leftGap > rightGap ? bestLeft.end : bestRight.start;
+                }
+            } else if (foundLeftOfCenter) {
+                resolvedCenter = bestLeft.end;
+            } else if (foundRightOfCenter) {
+                resolvedCenter = bestRight.start;
+            } else {
+                const auto& nearest = *std::min_element(allowed.begin(), allowed.end(), [&](const auto& a, const auto& b) {
+                    const float da = std::min(std::abs(centerX - a.start), std::abs(centerX - a.end));
+                    const float db = std::min(std::abs(centerX - b.start), std::abs(centerX - b.end));
+                    return da < db;
+                });
+                resolvedCenter = std::clamp(centerX, nearest.start, nearest.end);
+            }
+        }
+    } else {
+        // All positions are blocked; the pill is fully occluded and needs
+        // a scoot to make room.  Keep dodging = true so that the scoot
+        // logic fires.
+        dodging = true;
+        resolvedCenter = std::clamp(centerX, domain.start, domain.end);
+    }
+
+    float leftLimit  = window.start;
+    float rightLimit = window.end;
+    for (const auto& occ : occluders) {
+        if (resolvedCenter <= occ.start)
+            rightLimit = std::min(rightLimit, occ.start - hitPad);
+        else if (resolvedCenter >= occ.end)
+            leftLimit = std::max(leftLimit, occ.end + hitPad);
+    }
+
+    const float maxHalfWidth = std::max(0.5F, std::min(resolvedCenter - leftLimit, rightLimit - resolvedCenter));
+    const float maxWidth = std::max(1.F, maxHalfWidth * 2.F);
+    return {resolvedCenter, std::min(width, maxWidth), dodging};
+}
+
+SPillOcclusionBand pillOcclusionBand(const SHorizontalInterval& window, float ownerTop, float pillHeight, float offsetY, float hoverPadH, float hoverOffsetY) {
+    const float PILLY = std::round(ownerTop - pillHeight - offsetY);
+    const float TOP   = std::round(PILLY - hoverPadH + hoverOffsetY);
+    return {.window = window, .top = TOP, .bottom = TOP + pillHeight + hoverPadH * 2.F, .ownerTop = ownerTop};
+}
+
+std::optional<SHorizontalInterval> pillOccluderInterval(const SPillOcclusionBand& band, float x, float y, float w, float h, float margin) {
+    if (x + w <= band.window.start || x >= band.window.end || y + h <= band.top || y >= band.bottom)
+        return std::nullopt;
+
+    if (y >= band.ownerTop || y + h <= band.ownerTop)
+        return std::nullopt;
+
+    const SHorizontalInterval CLIPPED = {std::max(band.window.start, x - margin), std::min(band.window.end, x + w + margin)};
+    if (CLIPPED.end <= CLIPPED.start)
+        return std::nullopt;
+
+    return CLIPPED;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+
+struct SHorizontalInterval {
+    float start = 0.F;
+    float end   = 0.F;
+};
+
+struct SPillPlacement {
+    float center  = 0.F;
+    float width   = 0.F;
+    bool  dodging = false; // the pill could not stay centered
+};
+
+// The parts of `domain` not covered by any forbidden interval, in order.
+std::vector<SHorizontalInterval> subtractForbiddenIntervals(const SHorizontalInterval& domain, std::vector<SHorizontalInterval> forbidden);
+
+// Places a pill of `width` on the top edge of `window`, as close to centerX as
+// the occluders allow while keeping hitPad clear of them, and shrinks it to
+// the free space around the chosen center.
+SPillPlacement solvePillPlacement(const SHorizontalInterval& window, float centerX, float width, float hitPad, const std::vector<SHorizontalInterval>& occluders);
+
+// Where other windows can hide a pill: the owner's un-scooted span, over the
+// rows of the pill's hover hitbox.
+struct SPillOcclusionBand {
+    SHorizontalInterval window;
+    float               top      = 0.F;
+    float               bottom   = 0.F;
+    float               ownerTop = 0.F;
+};
+
+SPillOcclusionBand pillOcclusionBand(const SHorizontalInterval& window, float ownerTop, float pillHeight, float offsetY, float hoverPadH, float hoverOffsetY);
+
+// The part of the owner a window stacked above it hides, widened by margin.
+// Only windows inside the band that cross the owner's top edge count.
+std::optional<SHorizontalInterval> pillOccluderInterval(const SPillOcclusionBand& band, float x, float y, float w, float h, float margin);
@@ -0,0 +1,73 @@
+#include "PillMotion.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+static float cubic(float p1, float p2, float s) {
+    // Bezier with end points 0 and 1.
+    const float INV = 1.F - s;
+    return 3.F * INV * INV * s * p1 + 3.F * INV * s * s * p2 + s * s * s;
+}
+
+float evaluatePillBezier(const SPillBezier& bezier, float t) {
+    t = std::clamp(t, 0.F, 1.F);
+
+    // x(s) is monotonic for control points in [0, 1], so bisect for s.
+    float lo = 0.F, hi = 1.F;
+    for (int i = 0; i < 32; ++i) {
+        const float MID = (lo + hi) / 2.F;
+        if (cubic(bezier.points[0], bezier.points[2], MID) < t)
+            lo = MID;
+        else
+            hi = MID;
+    }
+
+    return cubic(bezier.points[1], bezier.points[3], (lo + hi) / 2.F);
+}
+
+float exponentialEase(float t) {
+    t = std::clamp(t, 0.F, 1.F);
+    return (1.F - std::exp(-EXPONENTIAL_TIME_CONSTANTS * t)) / (1.F - std::exp(-EXPONENTIAL_TIME_CONSTANTS));
+}
+
+float geometryTransitionMs(float speed, bool exponential) {
+    return (exponential ? EXPONENTIAL_TIME_CONSTANTS : 1.F) * 1000.F / std::max(0.01F, speed);
+}
+
+float evaluatePillCurve(const CPillCurveTable& curves, uint8_t curve, float t) {
+    const float x = std::clamp(t, 0.F, 1.F) * (PILL_CURVE_SAMPLES - 1);
+    const auto  i = std::min<size_t>(x, PILL_CURVE_SAMPLES - 2);
+    const auto* row = curves.data() + std::min<size_t>(curve, PILL_CURVES - 1) * PILL_CURVE_SAMPLES;
+    return row[i] + (row[i + 1] - row[i]) * (x - i);
+}
+
+ePillVisualState pillVisualState(bool focused, bool hovered, bool pressed) {
+    if (pressed)
+        return ePillVisualState::PRESSED;
+    if (hovered)
+        return ePillVisualState::HOVERED;
+    return focused ? ePillVisualState::ACTIVE : ePillVisualState::INACTIVE;
+}
+
+SPillTargets pillStateTargets(const SPillStyle& style, ePillVisualState state, bool focused) {
+    SPillTargets targets = {.width   = focused ? style.width : style.widthInactive,
+                            .height  = focused ? style.height : style.heightInactive,
+                            .radius  = focused ? style.radius : style.radiusInactive,
+                            .opacity = focused ? style.opacityActive : style.opacityInactive,
+                            .offsetY = focused ? style.offsetYActive : style.offsetYInactive,
+                            .color   = focused ? style.colorActive : style.colorInactive};
+
+    if (state == ePillVisualState::HOVERED) {
+        targets.width   = style.widthHover;
+        targets.height  = style.heightHover;
+        targets.color   = style.colorHover;
+        targets.opacity = style.opacityActive;
+    } else if (state == ePillVisualState::PRESSED) {
+        targets.width   = style.widthHover;
+        targets.height  = style.heightHover;
+        targets.color   = style.colorPressed;
+        targets.opacity = 1.F;
+    }
+
+    return targets;
+}
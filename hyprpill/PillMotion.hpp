@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// A cubic bezier easing curve from (0, 0) to (1, 1), given by its two inner
+// control points like Hyprland's `bezier` keyword.
+struct SPillBezier {
+    std::string_view     name;
+    std::array<float, 4> points = {}; // x1, y1, x2, y2
+};
+
+// Time constants the `exponential` curve spans before it is cut off at 1.
+constexpr float EXPONENTIAL_TIME_CONSTANTS = 5.F;
+
+// The easing names hyprpill has always accepted, registered as
+// `hyprpill_<name>`. `exponential` is a fit of 1 - e^(-5t), normalized to end
+// at 1; it is within 0.1% of the true decay but, being a bezier, it reaches
+// the target after exactly five time constants instead of asymptotically.
+constexpr std::array<SPillBezier, 6> PILL_BEZIERS = {{
+    {"linear", {0.F, 0.F, 1.F, 1.F}},
+    {"easeIn", {0.11F, 0.F, 0.5F, 0.F}},
+    {"easeOut", {0.5F, 1.F, 0.89F, 1.F}},
+    {"easeInOut", {0.45F, 0.F, 0.55F, 1.F}},
+    {"easeOutExpo", {0.16F, 1.F, 0.3F, 1.F}},
+    {"exponential", {0.182F, 0.909F, 0.425F, 0.981F}},
+}};
+
+// y of the curve at x = t, for t in [0, 1].
+float evaluatePillBezier(const SPillBezier& bezier, float t);
+
+// Normalized 1 - e^(-5t), what the `exponential` curve approximates.
+float exponentialEase(float t);
+
+// How long a dodge geometry or scoot transition takes, in ms, for
+// geometry_lerp_speed. The speed is the old per-second lerp rate, so a step
+// takes 1/speed seconds; with `exponential` it is the decay rate, and the
+// transition spans EXPONENTIAL_TIME_CONSTANTS of it.
+float geometryTransitionMs(float speed, bool exponential);
+
+// Easing curves sampled for transitions evaluated on the GPU: one row for
+// hover/state changes and one for presses.
+constexpr size_t PILL_CURVES        = 2;
+constexpr size_t PILL_CURVE_SAMPLES = 32;
+using CPillCurveTable               = std::array<float, PILL_CURVES * PILL_CURVE_SAMPLES>;
+
+float evaluatePillCurve(const CPillCurveTable& curves, uint8_t curve, float t);
+
+enum class ePillVisualState {
+    INACTIVE = 0,
+    ACTIVE,
+    HOVERED,
+    PRESSED,
+};
+
+// The pill_* options a pill animates towards.
+struct SPillStyle {
+    float    width           = 0.F;
+    float    height          = 0.F;
+    float    radius          = 0.F;
+    float    widthInactive   = 0.F;
+    float    heightInactive  = 0.F;
+    float    radiusInactive  = 0.F;
+    float    widthHover      = 0.F;
+    float    heightHover     = 0.F;
+    float    opacityActive   = 1.F;
+    float    opacityInactive = 1.F;
+    float    offsetYActive   = 0.F;
+    float    offsetYInactive = 0.F;
+    uint64_t colorActive     = 0;
+    uint64_t colorInactive   = 0;
+    uint64_t colorHover      = 0;
+    uint64_t colorPressed    = 0;
+};
+
+struct SPillTargets {
+    float    width   = 0.F;
+    float    height  = 0.F;
+    float    radius  = 0.F;
+    float    opacity = 1.F;
+    float    offsetY = 0.F;
+    uint64_t color   = 0; // 0xAARRGGBB
+};
+
+// A press wins over hover, hover over focus.
+ePillVisualState pillVisualState(bool focused, bool hovered, bool pressed);
+
+// What a pill in `state` animates to. Radius and offset only follow focus.
+SPillTargets pillStateTargets(const SPillStyle& style, ePillVisualState state, bool focused);
@@ -1,6 +1,7 @@
 #include "PillPassElement.hpp"
 
 #include <hyprland/src/render/OpenGL.hpp>
+#include <algorithm>
 
 #include "globals.hpp"
 #include "pillDeco.hpp"
@@ -26,3 +27,38 @@ bool CPillPassElement::needsPrecomputeBlur() {
 std::optional<CBox> CPillPassElement::boundingBox() {
     return data.deco->visibleBoxGlobal().translate(-g_pHyprOpenGL->m_renderData.pMonitor->m_position).expand(10);
 }
+
+CPillBatchPassElement::CPillBatchPassElement(CPillBatchPassElement::SBatchData&& data_) : data(std::move(data_)) {
+    ;
+}
+
+void CPillBatchPassElement::draw(const CRegion& damage) {
+    g_pGlobalState->batchRenderer.render(data.instances, damage, g_pGlobalState->animCurves, pillAnimClockMs());
+}
+
+bool CPillBatchPassElement::needsLiveBlur() {
+    // pill_blur is global, so a monitor's batch is a single blur group.
+    static auto* const PBLUR    = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:pill_blur")->getDataStaticPtr();
+    static auto* const PBLURGLB = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "decoration:blur:enabled")->getDataStaticPtr();
+    return **PBLUR && **PBLURGLB;
+}
+
+bool CPillBatchPassElement::needsPrecomputeBlur() {
+    return false;
+}
+
+std::optional<CBox> CPillBatchPassElement::boundingBox() {
+    if (data.instances.empty())
+        return CBox{};
+
+    double x1 = data.instances.front().box.x, y1 = data.instances.front().box.y;
+    double x2 = x1, y2 = y1;
+    for (const auto& inst : data.instances) {
+        x1 = std::min(x1, inst.box.x);
+        y1 = std::min(y1, inst.box.y);
+        x2 = std::max(x2, inst.box.x + inst.box.w);
+        y2 = std::max(y2, inst.box.y + inst.box.h);
+    }
+
+    return CBox{x1, y1, x2 - x1, y2 - y1}.expand(10);
+}
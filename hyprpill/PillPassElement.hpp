@@ -2,6 +2,8 @@
 
 #include <hyprland/src/render/pass/PassElement.hpp>
 
+#include "PillBatch.hpp"
+
 class CHyprPill;
 
 class CPillPassElement : public IPassElement {
@@ -26,3 +28,26 @@ class CPillPassElement : public IPassElement {
   private:
     SPillData data;
 };
+
+// All unoccluded pills of one monitor, drawn after the windows in one call.
+class CPillBatchPassElement : public IPassElement {
+  public:
+    struct SBatchData {
+        std::vector<SPillInstance> instances;
+    };
+
+    CPillBatchPassElement(SBatchData&& data_);
+    virtual ~CPillBatchPassElement() = default;
+
+    virtual void                draw(const CRegion& damage);
+    virtual bool                needsLiveBlur();
+    virtual bool                needsPrecomputeBlur();
+    virtual std::optional<CBox> boundingBox();
+
+    virtual const char*         passName() {
+        return "CPillBatchPassElement";
+    }
+
+  private:
+    SBatchData data;
+};
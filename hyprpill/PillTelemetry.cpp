@@ -0,0 +1,64 @@
+#include "PillTelemetry.hpp"
+
+#include <algorithm>
+#include <format>
+
+void CPillTelemetry::push(const SPillFrameSample& sample) {
+    m_samples[m_head] = sample;
+    m_head            = (m_head + 1) % CAPACITY;
+    m_count           = std::min(m_count + 1, CAPACITY);
+}
+
+void CPillTelemetry::clear() {
+    m_head  = 0;
+    m_count = 0;
+}
+
+void CPillTelemetry::stampInputToRender(uintptr_t window, double inputMs, double renderMs) {
+    // Newest first; the sample of the frame being rendered is near the head.
+    for (size_t i = 0; i < m_count; ++i) {
+        auto& s = m_samples[(m_head + CAPACITY - 1 - i) % CAPACITY];
+        if (s.window != window)
+            continue;
+
+        if (s.timeMs >= inputMs)
+            s.inputToRenderMs = (float)(renderMs - inputMs);
+        return;
+    }
+}
+
+size_t CPillTelemetry::size() const {
+    return m_count;
+}
+
+template <typename F>
+void CPillTelemetry::forEach(F&& fn) const {
+    // Oldest first.
+    const size_t start = (m_head + CAPACITY - m_count) % CAPACITY;
+    for (size_t i = 0; i < m_count; ++i)
+        fn(m_samples[(start + i) % CAPACITY]);
+}
+
+std::string CPillTelemetry::toJSON() const {
+    std::string result = "[";
+    bool        first  = true;
+    forEach([&](const SPillFrameSample& s) {
+        if (!first)
+            result += ",";
+        first = false;
+        result += std::format(R"({{"window": "0x{:x}", "timeMs": {:.3f}, "dtMs": {:.3f}, "geometryX": {:.2f}, "geometryW": {:.2f}, "geometryH": {:.2f}, "stepX": {:.3f}, )"
+                              R"("stepW": {:.3f}, "scoot": {:.2f}, "scootDir": {}, "scootFlip": {}, "inputToRenderMs": {:.3f}}})",
+                              s.window, s.timeMs, s.dtMs, s.geometryX, s.geometryW, s.geometryH, s.stepX, s.stepW, s.scoot, s.scootDir, s.scootFlip, s.inputToRenderMs);
+    });
+    result += "]";
+    return result;
+}
+
+std::string CPillTelemetry::toCSV() const {
+    std::string result = "window,time_ms,dt_ms,geometry_x,geometry_w,geometry_h,step_x,step_w,scoot,scoot_dir,scoot_flip,input_to_render_ms\n";
+    forEach([&](const SPillFrameSample& s) {
+        result += std::format("0x{:x},{:.3f},{:.3f},{:.2f},{:.2f},{:.2f},{:.3f},{:.3f},{:.2f},{},{},{:.3f}\n", s.window, s.timeMs, s.dtMs, s.geometryX, s.geometryW, s.geometryH,
+                              s.stepX, s.stepW, s.scoot, s.scootDir, s.scootFlip ? 1 : 0, s.inputToRenderMs);
+    });
+    return result;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// One sample per pill per drawn frame, recorded while
+// plugin:hyprpill:debug_telemetry is enabled.
+struct SPillFrameSample {
+    uintptr_t window    = 0;
+    double    timeMs    = 0.0; // steady clock
+    float     dtMs      = 0.F; // since this pill's previous frame
+    float     geometryX = 0.F; // relative to the window's left edge
+    float     geometryW = 0.F;
+    float     geometryH = 0.F;
+    float     stepX     = 0.F; // geometry change since the previous frame
+    float     stepW     = 0.F;
+    float     scoot     = 0.F;
+    int       scootDir  = 0;
+    bool      scootFlip = false; // scoot direction reversed since the previous frame
+    // For frames that applied a drag move: from the oldest input event behind
+    // it until the frame was rendered, before scanout. -1 otherwise.
+    float     inputToRenderMs = -1.F;
+};
+
+class CPillTelemetry {
+  public:
+    static constexpr size_t CAPACITY = 8192;
+
+    void                    push(const SPillFrameSample& sample);
+    void                    clear();
+    // Sets inputToRenderMs on window's latest sample, if that sample was
+    // drawn after inputMs (both steady clock, like timeMs).
+    void                    stampInputToRender(uintptr_t window, double inputMs, double renderMs);
+    size_t                  size() const;
+
+    std::string             toJSON() const;
+    std::string             toCSV() const;
+
+  private:
+    template <typename F>
+    void                                    forEach(F&& fn) const;
+
+    std::array<SPillFrameSample, CAPACITY> m_samples;
+    size_t                                  m_head  = 0;
+    size_t                                  m_count = 0;
+};
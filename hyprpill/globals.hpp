@@ -1,16 +1,132 @@
 #pragma once
 
 #include <hyprland/src/plugins/PluginAPI.hpp>
+#include <hyprland/src/helpers/AnimatedVariable.hpp>
+#include <hyprland/src/helpers/time/Time.hpp>
+
+#include <array>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "DragSession.hpp"
+#include "InputTrace.hpp"
+#include "PillBatch.hpp"
+#include "PillInput.hpp"
+#include "PillTelemetry.hpp"
 
 inline HANDLE PHANDLE = nullptr;
 
 class CHyprPill;
 
+struct SPendingWindowMove {
+    PHLWINDOWREF                   window;
+    Vector2D                       target;
+    // Arrival of the oldest drag input folded into this move.
+    std::optional<Time::steady_tp> inputTime;
+};
+
+// A drag move that has been applied but not yet rendered.
+struct SUnrenderedInput {
+    PHLWINDOWREF    window;
+    Time::steady_tp inputTime;
+};
+
+// Where a mapped window is headed, as last seen by the occluder tracking.
+struct SWindowGeometryStamp {
+    uintptr_t window    = 0;
+    uintptr_t workspace = 0;
+    Vector2D  position;
+    Vector2D  size;
+
+    bool      operator==(const SWindowGeometryStamp&) const = default;
+};
+
+// Every visible window's full box in stacking order, for the batching check.
+// Rebuilt when the occluder generation moves, so it is as current as the
+// pills' own occluders.
+struct SWindowStacking {
+    uint64_t                              generation = 0;
+    CWindowSpatialHash                    windows;
+    std::unordered_map<uintptr_t, size_t> z; // of every window, visible or not
+};
+
 struct SGlobalState {
     std::vector<WP<CHyprPill>> pills;
     uint32_t                   noPillRuleIdx    = 0;
     uint32_t                   pillColorRuleIdx = 0;
+    // The pointer drives at most one drag; every touch point can drive its own.
     WP<CHyprPill>              dragPill;
+    std::unordered_map<int32_t, WP<CHyprPill>> touchDrags;
+
+    // pill_color rule strings parsed once, shared by all windows.
+    std::unordered_map<std::string, CHyprColor> ruleColors;
+    WP<CHyprPill>              hoveredPill;
+    // Every pill as the last routed event saw it, indexed like pills.
+    SPillRouting               inputRouting;
+
+    // Recent pointer motion for hover_prediction.
+    SPointerHistory               pointerHistory;
+
+    // Predicted hovers started, how many the pointer actually reached, and
+    // how far ahead of the real hover those showed in total.
+    uint64_t                      hoverPredictions      = 0;
+    uint64_t                      hoverPredictionHits   = 0;
+    double                        hoverPredictionLeadMs = 0.0;
+
+    // Cursor override currently applied by hyprpill, and how many times the
+    // override controller was called (see `hyprctl hyprpillstats`).
+    bool                       cursorOverridden    = false;
+    std::string                appliedCursor;
+    uint64_t                   cursorOverrideCalls = 0;
+
+    // Bumped whenever window geometry or stacking may have changed; pills
+    // reuse their occluders while it stays put. Events and changes in
+    // windowGeometry set occludersDirty, and the layout is then rechecked
+    // every frame until it stops animating. windowGeometry is only rescanned
+    // while something animates or is dragged.
+    uint64_t                   occluderGeneration     = 1;
+    bool                       occludersDirty         = true;
+    bool                       occludersSettling      = false;
+    bool                       windowsMovingLastFrame = true;
+    std::vector<SWindowGeometryStamp> windowGeometry;
+    SWindowStacking            stacking;
+
+    // Window moves requested by scoots and drags, applied once per frame.
+    std::vector<SPendingWindowMove> pendingMoves;
+    // With debug_telemetry, applied drag moves waiting for their frame, so
+    // the frame's telemetry sample can carry the input-to-render latency.
+    std::vector<SUnrenderedInput>   unrenderedInput;
+
+    // Shared animation configs for all pills, refreshed on config reload.
+    SP<Hyprutils::Animation::SAnimationPropertyConfig> hoverAnimConfig;
+    SP<Hyprutils::Animation::SAnimationPropertyConfig> pressAnimConfig;
+    SP<Hyprutils::Animation::SAnimationPropertyConfig> geometryAnimConfig;
+
+    // With gpu_paint_animation, pill paint transitions are eased by the batch
+    // shader from these curves, timed in ms since animEpoch.
+    CPillCurveTable                                    animCurves = {};
+    Time::steady_tp                                    animEpoch  = Time::steadyNow();
+
+    // Pills collected for the monitor being rendered, flushed as one batched
+    // pass element after its windows.
+    std::vector<SPillInstance> pillBatch;
+    CPillBatchRenderer         batchRenderer;
+
+    // Per-frame pill samples, dumped by `hyprctl hyprpilltelemetry`.
+    CPillTelemetry telemetry;
+
+    // Input recorded by `hyprctl hyprpilltrace record`.
+    CInputTrace    trace;
 };
 
 inline UP<SGlobalState> g_pGlobalState;
+
+// The steady clock in ms, as the input routing takes it.
+inline double pillInputClockMs(const Time::steady_tp& tp = Time::steadyNow()) {
+    return std::chrono::duration<double, std::milli>(tp.time_since_epoch()).count();
+}
+
+inline float pillAnimClockMs(const Time::steady_tp& tp = Time::steadyNow()) {
+    return std::chrono::duration<float, std::milli>(tp - g_pGlobalState->animEpoch).count();
+}
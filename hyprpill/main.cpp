@@ -2,12 +2,23 @@
 
 #include <algorithm>
 #include <any>
+#include <array>
+#include <chrono>
+#include <format>
+#include <optional>
 #include <hyprland/src/Compositor.hpp>
+#include <hyprland/src/SharedDefs.hpp>
 #include <hyprland/src/config/ConfigManager.hpp>
 #include <hyprland/src/desktop/rule/windowRule/WindowRuleEffectContainer.hpp>
+#include <hyprland/src/desktop/state/FocusState.hpp>
 #include <hyprland/src/desktop/view/Window.hpp>
+#include <hyprland/src/managers/animation/AnimationManager.hpp>
+#include <hyprland/src/managers/cursor/CursorShapeOverrideController.hpp>
+#include <hyprland/src/managers/input/InputManager.hpp>
 #include <hyprland/src/render/Renderer.hpp>
 
+#include "PillMotion.hpp"
+#include "PillPassElement.hpp"
 #include "globals.hpp"
 #include "pillDeco.hpp"
 
@@ -37,8 +48,365 @@ static void onUpdateWindowRules(PHLWINDOW window) {
     if (PILLIT == g_pGlobalState->pills.end())
         return;
 
-    (*PILLIT)->updateRules();
-    window->updateWindowDecos();
+    if ((*PILLIT)->updateRules())
+        window->updateWindowDecos();
+}
+
+// Input is routed once per event for all pills by the pure functions in
+// PillInput, over a snapshot of every pill taken once per event; the pill
+// they pick carries the decision out.
+static SP<CHyprPill> routedPill(std::optional<size_t> index) {
+    const auto& PILLS = g_pGlobalState->pills;
+    return index && *index < PILLS.size() ? PILLS[*index].lock() : nullptr;
+}
+
+static void recordTrace(eTraceEvent type, uint32_t id, uint8_t state, const Vector2D& pos) {
+    if (!g_pGlobalState->trace.recording())
+        return;
+
+    g_pGlobalState->trace.record(STraceRecord{.id = id, .type = (uint8_t)type, .state = state, .x = (float)pos.x, .y = (float)pos.y});
+}
+
+static void recordTraceLayout() {
+    if (!g_pGlobalState->trace.recording())
+        return;
+
+    auto& trace = g_pGlobalState->trace;
+    trace.record(STraceRecord{.type = (uint8_t)eTraceEvent::LAYOUT});
+
+    for (size_t i = 0; i < g_pCompositor->m_monitors.size(); ++i) {
+        const auto& M = g_pCompositor->m_monitors[i];
+        trace.record(STraceRecord{.id   = (uint32_t)i,
+                                  .type = (uint8_t)eTraceEvent::MONITOR,
+                                  .x    = (float)M->m_position.x,
+                                  .y    = (float)M->m_position.y,
+                                  .w    = (float)M->m_size.x,
+                                  .h    = (float)M->m_size.y});
+    }
+
+    const auto PFOCUSED = Desktop::focusState()->window();
+    for (const auto& w : g_pCompositor->m_windows) {
+        if (!w || !w->m_isMapped || w->isHidden() || !w->m_workspace || !w->m_workspace->isVisible())
+            continue;
+
+        const auto MONITORIT = std::ranges::find(g_pCompositor->m_monitors, w->m_monitor.lock());
+        const auto POS       = w->m_realPosition->goal() + w->m_floatingOffset;
+        const auto SIZE      = w->m_realSize->goal();
+        trace.record(STraceRecord{.id       = trace.windowId((uintptr_t)w.get()),
+                                  .type     = (uint8_t)eTraceEvent::WINDOW,
+                                  .state    = (uint8_t)((w->m_isFloating ? TRACE_WINDOW_FLOATING : 0) | (w == PFOCUSED ? TRACE_WINDOW_FOCUSED : 0)),
+                                  .reserved = (uint16_t)std::distance(g_pCompositor->m_monitors.begin(), MONITORIT),
+                                  .x        = (float)POS.x,
+                                  .y        = (float)POS.y,
+                                  .w        = (float)SIZE.x,
+                                  .h        = (float)SIZE.y});
+    }
+}
+
+static void onMouseMove(SCallbackInfo& info, const Vector2D& coords) {
+    static auto* const PPREDICT = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:hover_prediction")->getDataStaticPtr();
+
+    recordTrace(eTraceEvent::MOTION, 0, 0, coords);
+    recordPointerSample(g_pGlobalState->pointerHistory, coords.x, coords.y, pillInputClockMs());
+
+    const auto& ROUTING = CHyprPill::snapshotInputRouting();
+    const auto  ROUTE   = routePointerMotion(ROUTING, coords.x, coords.y);
+    const auto  PTARGET = routedPill(ROUTE.target);
+
+    if (const auto PLAST = routedPill(ROUTE.unhover))
+        PLAST->clearHover();
+
+    g_pGlobalState->hoveredPill = PTARGET;
+
+    if (PTARGET)
+        PTARGET->onMouseMove(info, coords, ROUTE);
+    else if (**PPREDICT > 0) {
+        const double HORIZON = std::clamp<double>(**PPREDICT, 1.0, 50.0);
+        if (const auto PREDICTED = predictPointer(g_pGlobalState->pointerHistory, HORIZON)) {
+            if (const auto PPILL = routedPill(pillAt(ROUTING, PREDICTED->x, PREDICTED->y, false)))
+                PPILL->predictHover(HORIZON);
+        }
+    }
+
+    CHyprPill::updateCursorShape(CHyprPill::refreshInputTarget(ROUTE.target), coords);
+}
+
+static void onMouseButton(SCallbackInfo& info, const IPointer::SButtonEvent& e, const Vector2D& coords) {
+    recordTrace(eTraceEvent::BUTTON, e.button, e.state == WL_POINTER_BUTTON_STATE_PRESSED, coords);
+
+    const auto& ROUTING = CHyprPill::snapshotInputRouting();
+    const auto  ROUTE   = routePointerButton(ROUTING, e.button, e.state == WL_POINTER_BUTTON_STATE_PRESSED, coords.x, coords.y, pillInputClockMs());
+    if (const auto PTARGET = routedPill(ROUTE.target))
+        PTARGET->onMouseButton(info, ROUTE.action, coords);
+
+    CHyprPill::updateCursorShape(CHyprPill::refreshInputTarget(ROUTE.target), coords);
+}
+
+static void onTouchDown(SCallbackInfo& info, const ITouch::SDownEvent& e) {
+    recordTrace(eTraceEvent::TOUCH_DOWN, e.touchID, 1, e.pos);
+
+    const auto& ROUTING = CHyprPill::snapshotInputRouting();
+    const auto  TARGET  = routeTouchDown(ROUTING, e.touchID, e.pos.x, e.pos.y);
+    if (const auto PPILL = routedPill(TARGET)) {
+        Vector2D coords;
+        touchToGlobal(ROUTING.pills[*TARGET].monitor, e.pos.x, e.pos.y, coords.x, coords.y);
+        PPILL->onTouchDown(info, coords, e.touchID);
+    }
+}
+
+// Touch up and motion only concern the pill holding the touch point, so
+// they skip the snapshot and look it up directly.
+static SP<CHyprPill> touchDragPill(int32_t touchId) {
+    const auto IT = g_pGlobalState->touchDrags.find(touchId);
+    return IT != g_pGlobalState->touchDrags.end() ? IT->second.lock() : nullptr;
+}
+
+static void onTouchUp(SCallbackInfo& info, const ITouch::SUpEvent& e) {
+    recordTrace(eTraceEvent::TOUCH_UP, e.touchID, 0, {});
+
+    if (const auto PDRAG = touchDragPill(e.touchID))
+        PDRAG->onTouchUp(info);
+}
+
+static void onTouchMove(SCallbackInfo& info, const ITouch::SMotionEvent& e) {
+    static auto* const PDRAGTHRESH = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:drag_pixel_threshold")->getDataStaticPtr();
+
+    recordTrace(eTraceEvent::TOUCH_MOTION, e.touchID, 0, e.pos);
+
+    if (const auto PDRAG = touchDragPill(e.touchID)) {
+        const auto ROUTE = routeTouchMotion(PDRAG->dragTarget(), **PDRAGTHRESH, e.pos.x, e.pos.y);
+        PDRAG->onTouchMove(info, {ROUTE.x, ROUTE.y}, ROUTE.action);
+    }
+}
+
+static void markOccludersDirty() {
+    g_pGlobalState->occludersDirty = true;
+}
+
+// Compares every mapped window's target geometry with the last scan's.
+// Events don't cover everything that moves a window (keyboard resizes,
+// floating resizes from an edge, windows without a pill), so this catches
+// the rest; it's a few compares per window.
+static bool windowGeometryChanged() {
+    auto&  stamps  = g_pGlobalState->windowGeometry;
+    bool   changed = false;
+    size_t count   = 0;
+
+    for (const auto& w : g_pCompositor->m_windows) {
+        if (!w || !w->m_isMapped || w->isHidden())
+            continue;
+
+        const SWindowGeometryStamp STAMP{.window    = (uintptr_t)w.get(),
+                                         .workspace = (uintptr_t)w->m_workspace.get(),
+                                         .position  = w->m_realPosition->goal() + w->m_floatingOffset,
+                                         .size      = w->m_realSize->goal()};
+        if (count == stamps.size())
+            stamps.push_back(STAMP);
+        else if (stamps[count] != STAMP)
+            stamps[count] = STAMP;
+        else {
+            count++;
+            continue;
+        }
+
+        changed = true;
+        count++;
+    }
+
+    if (count != stamps.size()) {
+        stamps.resize(count);
+        changed = true;
+    }
+
+    return changed;
+}
+
+static void updateOccluderTracking() {
+    auto& state = *g_pGlobalState;
+
+    // Outside the hooked events, window geometry only changes through an
+    // animation or an interactive drag, so steady frames skip the scan. The
+    // frame after the last one catches a final warp. Moves that skip
+    // animation entirely (animations off) wait for the next hooked event.
+    const bool MOVING = g_pAnimationManager->shouldTickForNext() || !g_pInputManager->m_currentlyDraggedWindow.expired();
+    if ((MOVING || state.windowsMovingLastFrame) && windowGeometryChanged())
+        state.occludersDirty = true;
+    state.windowsMovingLastFrame = MOVING;
+
+    if (!state.occludersDirty && !state.occludersSettling)
+        return;
+
+    state.occludersDirty = false;
+    state.occluderGeneration++;
+    recordTraceLayout();
+
+    // Geometry keeps changing while the layout animates, so keep invalidating
+    // until every window has settled.
+    state.occludersSettling = std::ranges::any_of(g_pCompositor->m_windows, [](const auto& w) {
+        return w && w->m_isMapped && (w->m_realPosition->isBeingAnimated() || w->m_realSize->isBeingAnimated() ||
+                                       (w->m_workspace && w->m_workspace->m_renderOffset->isBeingAnimated()));
+    });
+}
+
+static void stampInputToRender() {
+    auto& unrendered = g_pGlobalState->unrenderedInput;
+    if (unrendered.empty())
+        return;
+
+    // RENDER_POST follows the frame's last draw and precedes the commit. The
+    // wait for scanout isn't included, so this is input-to-render, not
+    // motion-to-photon.
+    const auto PMONITOR = g_pHyprOpenGL->m_renderData.pMonitor.lock();
+    const auto RENDERMS = std::chrono::duration<double, std::milli>(Time::steadyNow().time_since_epoch()).count();
+    std::erase_if(unrendered, [&](const auto& u) {
+        const auto PWINDOW = u.window.lock();
+        if (!PWINDOW)
+            return true;
+        if (PWINDOW->m_monitor.lock() != PMONITOR)
+            return false;
+
+        g_pGlobalState->telemetry.stampInputToRender((uintptr_t)PWINDOW.get(), std::chrono::duration<double, std::milli>(u.inputTime.time_since_epoch()).count(), RENDERMS);
+        return true;
+    });
+}
+
+static void onRenderStage(eRenderStage stage) {
+    if (stage == RENDER_PRE) {
+        g_pGlobalState->pillBatch.clear();
+
+        // Transition start times are taken relative to the epoch every frame,
+        // so it can move freely; this keeps the float clock precise.
+        const auto NOW = Time::steadyNow();
+        if (NOW - g_pGlobalState->animEpoch > std::chrono::hours(1))
+            g_pGlobalState->animEpoch = NOW;
+        return;
+    }
+
+    if (stage == RENDER_POST) {
+        stampInputToRender();
+        return;
+    }
+
+    if (stage != RENDER_POST_WINDOWS || g_pGlobalState->pillBatch.empty())
+        return;
+
+    CPillBatchPassElement::SBatchData data;
+    data.instances = std::move(g_pGlobalState->pillBatch);
+    g_pGlobalState->pillBatch.clear();
+    g_pHyprRenderer->m_renderPass.add(makeUnique<CPillBatchPassElement>(std::move(data)));
+}
+
+static std::string onStatsCommand(eHyprCtlOutputFormat format, std::string request) {
+    const auto   HITS   = g_pGlobalState->hoverPredictionHits;
+    const double LEADMS = HITS ? g_pGlobalState->hoverPredictionLeadMs / HITS : 0.0;
+
+    if (format == eHyprCtlOutputFormat::FORMAT_JSON)
+        return std::format(
+            R"({{"pills": {}, "cursorOverridden": {}, "cursorShape": "{}", "cursorOverrideCalls": {}, "hoverPredictions": {}, "hoverPredictionHits": {}, "hoverPredictionLeadMs": {:.2f}}})",
+            g_pGlobalState->pills.size(), g_pGlobalState->cursorOverridden, g_pGlobalState->appliedCursor, g_pGlobalState->cursorOverrideCalls, g_pGlobalState->hoverPredictions,
+            HITS, LEADMS);
+
+    return std::format("pills: {}\ncursor override: {}\ncursor override calls: {}\nhover predictions: {} ({} reached, {:.1f}ms early on average)\n", g_pGlobalState->pills.size(),
+                       g_pGlobalState->cursorOverridden ? g_pGlobalState->appliedCursor : "none", g_pGlobalState->cursorOverrideCalls, g_pGlobalState->hoverPredictions, HITS,
+                       LEADMS);
+}
+
+static std::string onTelemetryCommand(eHyprCtlOutputFormat format, std::string request) {
+    if (request.ends_with(" clear")) {
+        g_pGlobalState->telemetry.clear();
+        return "ok";
+    }
+
+    if (format == eHyprCtlOutputFormat::FORMAT_JSON)
+        return g_pGlobalState->telemetry.toJSON();
+
+    return g_pGlobalState->telemetry.toCSV();
+}
+
+static std::string onTraceCommand(eHyprCtlOutputFormat format, std::string request) {
+    CVarList    vars(request, 0, ' ', true);
+    const auto& ACTION = vars[1];
+    const auto& PATH   = vars[2];
+
+    if (ACTION == "record") {
+        g_pGlobalState->trace.start();
+        recordTraceLayout();
+        return "ok";
+    }
+
+    if (ACTION == "stop") {
+        if (PATH.empty())
+            return "usage: hyprpilltrace stop <file>";
+
+        const auto RECORDED = g_pGlobalState->trace.size();
+        const auto DROPPED  = g_pGlobalState->trace.dropped();
+        if (const auto ERR = g_pGlobalState->trace.stop(PATH); !ERR.empty())
+            return ERR;
+
+        return std::format("wrote {} events to {}{}", RECORDED, PATH, DROPPED ? std::format(" ({} dropped)", DROPPED) : "");
+    }
+
+    return "usage: hyprpilltrace record | stop <file>";
+}
+
+static SP<Hyprutils::Animation::SAnimationPropertyConfig> makeAnimationConfig() {
+    auto config             = makeShared<Hyprutils::Animation::SAnimationPropertyConfig>();
+    config->overridden      = true;
+    config->internalEnabled = 1;
+    config->internalBezier  = "default";
+    config->internalSpeed   = 1.F;
+    config->pValues         = config;
+    return config;
+}
+
+static void registerBuiltinBeziers() {
+    // Curves matching the easing names hyprpill has always accepted. Hyprland
+    // drops all beziers on reload, so these are re-added every time.
+    for (const auto& BEZIER : PILL_BEZIERS) {
+        g_pAnimationManager->addBezierWithName(std::format("hyprpill_{}", BEZIER.name), Vector2D{BEZIER.points[0], BEZIER.points[1]},
+                                               Vector2D{BEZIER.points[2], BEZIER.points[3]});
+    }
+}
+
+static std::string resolveBezier(const std::string& name) {
+    // User-defined `bezier = ...` curves win over the builtin aliases.
+    if (g_pAnimationManager->bezierExists(name))
+        return name;
+
+    if (g_pAnimationManager->bezierExists("hyprpill_" + name))
+        return "hyprpill_" + name;
+
+    return "default";
+}
+
+static void refreshAnimationConfigs() {
+    static auto* const PDURHOVER   = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:anim_duration_hover")->getDataStaticPtr();
+    static auto* const PDURPRESS   = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:anim_duration_press")->getDataStaticPtr();
+    static auto* const PEASING     = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:anim_easing")->getDataStaticPtr();
+    static auto* const PGEOMSPEED  = (Hyprlang::FLOAT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:geometry_lerp_speed")->getDataStaticPtr();
+    static auto* const PGEOMEASING = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:geometry_lerp_easing")->getDataStaticPtr();
+
+    registerBuiltinBeziers();
+
+    // Animation speed is expressed in units of 100ms.
+    g_pGlobalState->hoverAnimConfig->internalSpeed  = std::max<Hyprlang::INT>(1, **PDURHOVER) / 100.F;
+    g_pGlobalState->hoverAnimConfig->internalBezier = resolveBezier(*PEASING);
+    g_pGlobalState->pressAnimConfig->internalSpeed  = std::max<Hyprlang::INT>(1, **PDURPRESS) / 100.F;
+    g_pGlobalState->pressAnimConfig->internalBezier = resolveBezier(*PEASING);
+
+    // The same curves, sampled for transitions the batch shader evaluates.
+    const std::array<SP<Hyprutils::Animation::SAnimationPropertyConfig>, PILL_CURVES> curveConfigs = {g_pGlobalState->hoverAnimConfig, g_pGlobalState->pressAnimConfig};
+    for (size_t row = 0; row < PILL_CURVES; ++row) {
+        const auto BEZIER = g_pAnimationManager->getBezier(curveConfigs[row]->internalBezier);
+        for (size_t i = 0; i < PILL_CURVE_SAMPLES; ++i) {
+            const float X = (float)i / (PILL_CURVE_SAMPLES - 1);
+            g_pGlobalState->animCurves[row * PILL_CURVE_SAMPLES + i] = BEZIER ? BEZIER->getYForPoint(X) : X;
+        }
+    }
+
+    const bool EXPONENTIAL = std::string{*PGEOMEASING} == "exponential";
+    g_pGlobalState->geometryAnimConfig->internalSpeed  = geometryTransitionMs(**PGEOMSPEED, EXPONENTIAL) / 100.F;
+    g_pGlobalState->geometryAnimConfig->internalBezier = resolveBezier(*PGEOMEASING);
 }
 
 APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
@@ -56,10 +424,40 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
     g_pGlobalState                = makeUnique<SGlobalState>();
     g_pGlobalState->noPillRuleIdx = Desktop::Rule::windowEffects()->registerEffect("hyprpill:no_pill");
     g_pGlobalState->pillColorRuleIdx = Desktop::Rule::windowEffects()->registerEffect("hyprpill:pill_color");
+    g_pGlobalState->hoverAnimConfig    = makeAnimationConfig();
+    g_pGlobalState->pressAnimConfig    = makeAnimationConfig();
+    g_pGlobalState->geometryAnimConfig = makeAnimationConfig();
 
     static auto P  = HyprlandAPI::registerCallbackDynamic(PHANDLE, "openWindow", [&](void* self, SCallbackInfo& info, std::any data) { onNewWindow(self, data); });
     static auto P2 =
         HyprlandAPI::registerCallbackDynamic(PHANDLE, "windowUpdateRules", [&](void* self, SCallbackInfo& info, std::any data) { onUpdateWindowRules(std::any_cast<PHLWINDOW>(data)); });
+    static auto P3 = HyprlandAPI::registerCallbackDynamic(PHANDLE, "configReloaded", [&](void* self, SCallbackInfo& info, std::any data) { refreshAnimationConfigs(); });
+    static auto P4 = HyprlandAPI::registerCallbackDynamic(PHANDLE, "preRender", [&](void* self, SCallbackInfo& info, std::any data) {
+        CHyprPill::flushTouchDrags();
+        CHyprPill::flushPendingMoves();
+        updateOccluderTracking();
+    });
+    static auto P5 = HyprlandAPI::registerCallbackDynamic(PHANDLE, "mouseMove", [&](void* self, SCallbackInfo& info, std::any data) { onMouseMove(info, std::any_cast<Vector2D>(data)); });
+    static auto P6 =
+        HyprlandAPI::registerCallbackDynamic(PHANDLE, "mouseButton", [&](void* self, SCallbackInfo& info, std::any data) {
+        onMouseButton(info, std::any_cast<IPointer::SButtonEvent>(data), g_pInputManager->getMouseCoordsInternal());
+    });
+    static auto P7 = HyprlandAPI::registerCallbackDynamic(PHANDLE, "touchDown", [&](void* self, SCallbackInfo& info, std::any data) { onTouchDown(info, std::any_cast<ITouch::SDownEvent>(data)); });
+    static auto P8 = HyprlandAPI::registerCallbackDynamic(PHANDLE, "touchUp", [&](void* self, SCallbackInfo& info, std::any data) { onTouchUp(info, std::any_cast<ITouch::SUpEvent>(data)); });
+    static auto P9 =
+        HyprlandAPI::registerCallbackDynamic(PHANDLE, "touchMove", [&](void* self, SCallbackInfo& info, std::any data) { onTouchMove(info, std::any_cast<ITouch::SMotionEvent>(data)); });
+    static auto P10 = HyprlandAPI::registerCallbackDynamic(PHANDLE, "render", [&](void* self, SCallbackInfo& info, std::any data) { onRenderStage(std::any_cast<eRenderStage>(data)); });
+
+    // Anything that can change window geometry or stacking invalidates the
+    // cached occluders.
+    static std::vector<SP<HOOK_CALLBACK_FN>> occluderCallbacks;
+    for (const auto& EVENT : {"openWindow", "closeWindow", "moveWindow", "changeFloatingMode", "activeWindow", "fullscreen", "pin", "workspace", "monitorLayoutChanged"}) {
+        occluderCallbacks.emplace_back(HyprlandAPI::registerCallbackDynamic(PHANDLE, EVENT, [&](void* self, SCallbackInfo& info, std::any data) { markOccludersDirty(); }));
+    }
+
+    HyprlandAPI::registerHyprCtlCommand(PHANDLE, SHyprCtlCommand{.name = "hyprpillstats", .exact = true, .fn = onStatsCommand});
+    HyprlandAPI::registerHyprCtlCommand(PHANDLE, SHyprCtlCommand{.name = "hyprpilltelemetry", .exact = false, .fn = onTelemetryCommand});
+    HyprlandAPI::registerHyprCtlCommand(PHANDLE, SHyprCtlCommand{.name = "hyprpilltrace", .exact = false, .fn = onTraceCommand});
 
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprpill:enabled", Hyprlang::INT{1});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprpill:pill_width", Hyprlang::INT{100});
@@ -73,6 +471,7 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprpill:hover_hitbox_width", Hyprlang::INT{40});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprpill:hover_hitbox_height", Hyprlang::INT{20});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprpill:hover_hitbox_offset_y", Hyprlang::INT{-9});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprpill:hover_prediction", Hyprlang::INT{0});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprpill:dodge_occluder_margin", Hyprlang::INT{4});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprpill:click_hitbox_width", Hyprlang::INT{35});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprpill:click_hitbox_height", Hyprlang::INT{15});
@@ -80,6 +479,7 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprpill:debug_hitbox_hover", Hyprlang::INT{0});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprpill:debug_hitbox_click", Hyprlang::INT{0});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprpill:debug_cursor_state", Hyprlang::INT{0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprpill:debug_telemetry", Hyprlang::INT{0});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprpill:hover_cursor", Hyprlang::STRING{"hand1"});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprpill:grab_cursor", Hyprlang::STRING{"hand2"});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprpill:drag_pixel_threshold", Hyprlang::INT{8});
@@ -98,6 +498,8 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprpill:geometry_lerp_speed", Hyprlang::FLOAT{150.F});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprpill:geometry_lerp_easing", Hyprlang::STRING{"easeInOut"});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprpill:pill_blur", Hyprlang::INT{0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprpill:batch_render", Hyprlang::INT{1});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprpill:gpu_paint_animation", Hyprlang::INT{0});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprpill:pill_part_of_window", Hyprlang::INT{0});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprpill:pill_precedence_over_border", Hyprlang::INT{1});
 
@@ -109,6 +511,7 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
     }
 
     HyprlandAPI::reloadConfig();
+    refreshAnimationConfigs();
 
     return {"hyprpill", "A plugin to add animated pill grabbers to windows.", "mylescox", "1.0"};
 }
@@ -118,6 +521,13 @@ APICALL EXPORT void PLUGIN_EXIT() {
         m->m_scheduledRecalc = true;
 
     g_pHyprRenderer->m_renderPass.removeAllOfType("CPillPassElement");
+    g_pHyprRenderer->m_renderPass.removeAllOfType("CPillBatchPassElement");
+
+    g_pHyprRenderer->makeEGLCurrent();
+    g_pGlobalState->batchRenderer.destroy();
+
+    if (g_pGlobalState->cursorOverridden && Cursor::overrideController)
+        Cursor::overrideController->unsetOverride(Cursor::CURSOR_OVERRIDE_UNKNOWN);
 
     Desktop::Rule::windowEffects()->unregisterEffect(g_pGlobalState->noPillRuleIdx);
     Desktop::Rule::windowEffects()->unregisterEffect(g_pGlobalState->pillColorRuleIdx);
@@ -1,12 +1,12 @@
 #include "pillDeco.hpp"
 
 #include <algorithm>
-#include <linux/input-event-codes.h>
+#include <array>
 #include <cmath>
 #include <chrono>
 #include <format>
 #include <string>
-#include <tuple>
+#include <utility>
 #include <vector>
 #include <hyprland/src/Compositor.hpp>
 #include <hyprland/src/config/ConfigManager.hpp>
@@ -15,7 +15,9 @@
 #include <hyprland/src/desktop/view/Window.hpp>
 #include <hyprland/src/helpers/MiscFunctions.hpp>
 #include <hyprland/src/managers/KeybindManager.hpp>
+#include <hyprland/src/managers/LayoutManager.hpp>
 #include <hyprland/src/managers/SeatManager.hpp>
+#include <hyprland/src/managers/animation/AnimationManager.hpp>
 #include <hyprland/src/managers/input/InputManager.hpp>
 #include <hyprland/src/managers/cursor/CursorShapeOverrideController.hpp>
 #include <hyprland/src/render/OpenGL.hpp>
@@ -25,102 +27,179 @@
 #include "globals.hpp"
 
 namespace {
-float lerpf(float a, float b, float t) {
-    return a + (b - a) * t;
+template <typename T>
+void animateTo(const PHLANIMVAR<T>& var, const T& goal) {
+    // Re-targeting restarts the curve, so only do it on a real change.
+    if (var->goal() != goal)
+        *var = goal;
 }
 
-CHyprColor lerpColor(const CHyprColor& a, const CHyprColor& b, float t) {
-    return CHyprColor{lerpf(a.r, b.r, t), lerpf(a.g, b.g, t), lerpf(a.b, b.b, t), lerpf(a.a, b.a, t)};
-}
+void applyWindowMove(PHLWINDOW pWindow, const Vector2D& target) {
+    // Same path movewindowpixel takes, minus the string round-trip and the
+    // address lookup.
+    const auto delta = target - pWindow->m_realPosition->goal();
+    if (std::abs(delta.x) < 0.001 && std::abs(delta.y) < 0.001)
+        return;
 
-float easeInOut(float t) {
-    return t < 0.5F ? 2.F * t * t : 1.F - std::pow(-2.F * t + 2.F, 2.F) * 0.5F;
+    g_pLayoutManager->getCurrentLayout()->moveActiveWindow(delta, pWindow);
 }
 
-float applyNamedEasing(float t, const std::string& easing) {
-    if (easing == "linear")
-        return t;
-    if (easing == "easeOut")
-        return 1.F - std::pow(1.F - t, 2.F);
-    if (easing == "easeIn")
-        return t * t;
+CHyprColor internRuleColor(const std::string& str) {
+    auto& colors = g_pGlobalState->ruleColors;
+    if (const auto it = colors.find(str); it != colors.end())
+        return it->second;
+
+    // Every window matching a pill_color rule hits the entry above. Only
+    // rules minting a new color string per window ever fill the map.
+    if (colors.size() >= 256)
+        colors.clear();
 
-    return easeInOut(t);
+    return colors.emplace(str, CHyprColor(configStringToInt(str).value_or(0))).first->second;
 }
 
-struct SHorizontalInterval {
-    float start = 0.F;
-    float end   = 0.F;
-};
+void applyCursorShape(const char* shape) {
+    // The controller is only touched on a real transition; the state is
+    // shared by all pills so N pills cost at most one call per change.
+    const bool wantOverride = shape && *shape;
+    auto&      state        = *g_pGlobalState;
+    if (wantOverride == state.cursorOverridden && (!wantOverride || state.appliedCursor == shape))
+        return;
 
-bool intervalsOverlap(const SHorizontalInterval& a, const SHorizontalInterval& b) {
-    return a.start < b.end && b.start < a.end;
+    state.cursorOverrideCalls++;
+    if (wantOverride) {
+        Cursor::overrideController->setOverride(shape, Cursor::CURSOR_OVERRIDE_UNKNOWN);
+        state.appliedCursor = shape;
+    } else {
+        Cursor::overrideController->unsetOverride(Cursor::CURSOR_OVERRIDE_UNKNOWN);
+        state.appliedCursor.clear();
+    }
+    state.cursorOverridden = wantOverride;
 }
 
-std::vector<SHorizontalInterval> subtractForbiddenIntervals(const SHorizontalInterval& domain, std::vector<SHorizontalInterval> forbidden) {
-    if (domain.end <= domain.start)
-        return {};
-
-    if (forbidden.empty())
-        return {domain};
+const SWindowStacking& currentStacking() {
+    auto& stacking = g_pGlobalState->stacking;
+    if (stacking.generation == g_pGlobalState->occluderGeneration)
+        return stacking;
 
-    std::sort(forbidden.begin(), forbidden.end(), [](const auto& a, const auto& b) { return a.start < b.start; });
+    stacking.generation = g_pGlobalState->occluderGeneration;
+    stacking.windows.clear();
+    stacking.z.clear();
 
-    std::vector<SHorizontalInterval> merged;
-    merged.reserve(forbidden.size());
-    for (const auto& interval : forbidden) {
-        SHorizontalInterval clipped = {std::max(domain.start, interval.start), std::min(domain.end, interval.end)};
-        if (clipped.end <= clipped.start)
+    for (size_t z = 0; z < g_pCompositor->m_windows.size(); ++z) {
+        const auto& w = g_pCompositor->m_windows[z];
+        if (!w)
             continue;
 
-        if (!merged.empty() && intervalsOverlap(merged.back(), clipped))
-            merged.back().end = std::max(merged.back().end, clipped.end);
-        else
-            merged.push_back(clipped);
+        stacking.z[(uintptr_t)w.get()] = z;
+        if (w->m_isMapped && !w->isHidden() && w->m_workspace && w->m_workspace->isVisible())
+            stacking.windows.insert(w, w->getFullWindowBoundingBox(), z);
     }
 
-    std::vector<SHorizontalInterval> allowed;
-    float                           cursor = domain.start;
-    for (const auto& blocked : merged) {
-        if (blocked.start > cursor)
-            allowed.push_back({cursor, blocked.start});
-        cursor = std::max(cursor, blocked.end);
-    }
+    return stacking;
+}
+}
+
+void CHyprPill::queueWindowMove(PHLWINDOW pWindow, const Vector2D& target, std::optional<Time::steady_tp> inputTime) {
+    if (!pWindow)
+        return;
+
+    g_pGlobalState->occludersDirty = true;
+
+    auto&      moves = g_pGlobalState->pendingMoves;
+    const auto it    = std::ranges::find_if(moves, [&](const auto& m) { return m.window.lock() == pWindow; });
+    if (it != moves.end()) {
+        it->target = target;
+        if (!it->inputTime)
+            it->inputTime = inputTime;
+    } else
+        moves.push_back({pWindow, target, inputTime});
+
+    if (const auto PMONITOR = pWindow->m_monitor.lock())
+        g_pCompositor->scheduleFrameForMonitor(PMONITOR);
+}
 
-    if (cursor < domain.end)
-        allowed.push_back({cursor, domain.end});
+void CHyprPill::queueWindowMoveBy(PHLWINDOW pWindow, const Vector2D& delta) {
+    if (!pWindow)
+        return;
 
-    return allowed;
+    // Relative moves stack on top of a move already queued this frame.
+    const auto& moves = g_pGlobalState->pendingMoves;
+    const auto  it    = std::ranges::find_if(moves, [&](const auto& m) { return m.window.lock() == pWindow; });
+    const auto  base  = it != moves.end() ? it->target : pWindow->m_realPosition->goal();
+    queueWindowMove(pWindow, base + delta);
 }
+
+void CHyprPill::flushPendingMoves(PHLWINDOW pWindow) {
+    if (!g_pGlobalState)
+        return;
+
+    // Take the moves out first: moving a window can re-enter the plugin.
+    auto&                           pending = g_pGlobalState->pendingMoves;
+    std::vector<SPendingWindowMove> moves;
+    if (pWindow) {
+        std::erase_if(pending, [&](const auto& m) {
+            if (m.window.lock() != pWindow)
+                return false;
+            moves.push_back(m);
+            return true;
+        });
+    } else
+        moves.swap(pending);
+
+    static auto* const PTELEMETRY = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:debug_telemetry")->getDataStaticPtr();
+
+    for (const auto& m : moves) {
+        const auto PWINDOW = m.window.lock();
+        if (!PWINDOW || !validMapped(PWINDOW))
+            continue;
+
+        applyWindowMove(PWINDOW, m.target);
+
+        if (!**PTELEMETRY || !m.inputTime)
+            continue;
+
+        // Keep the oldest input per window until a frame shows it.
+        auto& unrendered = g_pGlobalState->unrenderedInput;
+        if (std::ranges::none_of(unrendered, [&](const auto& u) { return u.window.lock() == PWINDOW; }))
+            unrendered.push_back({PWINDOW, *m.inputTime});
+    }
 }
 
 CHyprPill::CHyprPill(PHLWINDOW pWindow) : IHyprWindowDecoration(pWindow), m_pWindow(pWindow) {
-    m_pMouseButtonCallback = HyprlandAPI::registerCallbackDynamic(
-        PHANDLE, "mouseButton", [&](void* self, SCallbackInfo& info, std::any param) { onMouseButton(info, std::any_cast<IPointer::SButtonEvent>(param)); });
-    m_pTouchDownCallback = HyprlandAPI::registerCallbackDynamic(
-        PHANDLE, "touchDown", [&](void* self, SCallbackInfo& info, std::any param) { onTouchDown(info, std::any_cast<ITouch::SDownEvent>(param)); });
-    m_pTouchUpCallback = HyprlandAPI::registerCallbackDynamic(
-        PHANDLE, "touchUp", [&](void* self, SCallbackInfo& info, std::any param) { onTouchUp(info, std::any_cast<ITouch::SUpEvent>(param)); });
-    m_pTouchMoveCallback = HyprlandAPI::registerCallbackDynamic(
-        PHANDLE, "touchMove", [&](void* self, SCallbackInfo& info, std::any param) { onTouchMove(info, std::any_cast<ITouch::SMotionEvent>(param)); });
-    m_pMouseMoveCallback = HyprlandAPI::registerCallbackDynamic(
-        PHANDLE, "mouseMove", [&](void* self, SCallbackInfo& info, std::any param) { onMouseMove(info, std::any_cast<Vector2D>(param)); });
+    static auto* const PWIDTH  = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:pill_width")->getDataStaticPtr();
+    static auto* const PHEIGHT = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:pill_height")->getDataStaticPtr();
+    static auto* const PRADIUS = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:pill_radius")->getDataStaticPtr();
+
+    const auto         STATECONFIG = g_pGlobalState->hoverAnimConfig;
+    const auto         GEOMCONFIG  = g_pGlobalState->geometryAnimConfig;
+
+    g_pAnimationManager->createAnimation(static_cast<float>(**PWIDTH), m_width, STATECONFIG, pWindow, AVARDAMAGE_NONE);
+    g_pAnimationManager->createAnimation(static_cast<float>(**PHEIGHT), m_height, STATECONFIG, pWindow, AVARDAMAGE_NONE);
+    g_pAnimationManager->createAnimation(static_cast<float>(**PRADIUS), m_radius, STATECONFIG, pWindow, AVARDAMAGE_NONE);
+    g_pAnimationManager->createAnimation(1.F, m_opacity, STATECONFIG, pWindow, AVARDAMAGE_NONE);
+    g_pAnimationManager->createAnimation(0.F, m_offsetY, STATECONFIG, pWindow, AVARDAMAGE_NONE);
+    g_pAnimationManager->createAnimation(CHyprColor{}, m_color, STATECONFIG, pWindow, AVARDAMAGE_NONE);
+    g_pAnimationManager->createAnimation(0.F, m_scootOffset, GEOMCONFIG, pWindow, AVARDAMAGE_NONE);
+    g_pAnimationManager->createAnimation(0.F, m_geometryX, GEOMCONFIG, pWindow, AVARDAMAGE_NONE);
+    g_pAnimationManager->createAnimation(0.F, m_geometryW, GEOMCONFIG, pWindow, AVARDAMAGE_NONE);
+    g_pAnimationManager->createAnimation(0.F, m_geometryH, GEOMCONFIG, pWindow, AVARDAMAGE_NONE);
+
+    for (const auto& var : {m_width, m_height, m_radius, m_opacity, m_offsetY, m_scootOffset, m_geometryX, m_geometryW, m_geometryH})
+        var->setUpdateCallback([this](auto) { damageAnimationFrame(); });
+    m_color->setUpdateCallback([this](auto) { damageAnimationFrame(); });
 
     updateStateAndAnimate();
     updateCursorShape();
 }
 
 CHyprPill::~CHyprPill() {
-    removeScoot();
-
-    if (g_pGlobalState && g_pGlobalState->dragPill.get() == this)
-        g_pGlobalState->dragPill.reset();
+    // Decorations can outlive the global state at PLUGIN_EXIT; everything
+    // below goes through it.
+    if (!g_pGlobalState)
+        return;
 
-    HyprlandAPI::unregisterCallback(PHANDLE, m_pMouseButtonCallback);
-    HyprlandAPI::unregisterCallback(PHANDLE, m_pTouchDownCallback);
-    HyprlandAPI::unregisterCallback(PHANDLE, m_pTouchUpCallback);
-    HyprlandAPI::unregisterCallback(PHANDLE, m_pTouchMoveCallback);
-    HyprlandAPI::unregisterCallback(PHANDLE, m_pMouseMoveCallback);
+    removeScoot();
+    releaseDragOwnership();
     std::erase(g_pGlobalState->pills, m_self);
     updateCursorShape();
 }
@@ -169,12 +248,23 @@ void CHyprPill::draw(PHLMONITOR pMonitor, const float& a) {
 
     static auto* const PENABLED = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:enabled")->getDataStaticPtr();
     if (!**PENABLED || m_hidden) {
+        m_hasHitboxCache = false;
         removeScoot();
         return;
     }
 
     updateStateAndAnimate();
     updateScoot();
+    updateHitboxCache();
+    recordTelemetry();
+
+    // Pills nothing is stacked on top of can be drawn after all windows, so
+    // they join the monitor's batch. The rest keep their place in the stack.
+    static auto* const PBATCH = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:batch_render")->getDataStaticPtr();
+    if (**PBATCH && !occludedByWindowAbove(visibleBoxGlobal().expand(8))) {
+        collectInstances(pMonitor, a, g_pGlobalState->pillBatch);
+        return;
+    }
 
     CPillPassElement::SPillData data;
     data.deco = this;
@@ -182,7 +272,45 @@ void CHyprPill::draw(PHLMONITOR pMonitor, const float& a) {
     g_pHyprRenderer->m_renderPass.add(makeUnique<CPillPassElement>(data));
 }
 
+bool CHyprPill::occludedByWindowAbove(const CBox& box) const {
+    const auto owner = m_pWindow.lock();
+    if (!owner)
+        return true;
+
+    // Only the windows near the pill are looked at, so checking every pill
+    // stays linear in the number of pills.
+    const auto& STACKING = currentStacking();
+    const auto  OWNERIT  = STACKING.z.find((uintptr_t)owner.get());
+    if (OWNERIT == STACKING.z.end())
+        return true;
+
+    static std::vector<const CWindowSpatialHash::SEntry*> nearby;
+    nearby.clear();
+    STACKING.windows.query(box, nearby);
+
+    return std::ranges::any_of(nearby, [&](const auto* entry) {
+        const auto w = entry->window.lock();
+        if (!w || w == owner)
+            return false;
+
+        // Floating windows are rendered after tiled ones regardless of order.
+        return entry->z > OWNERIT->second || (w->m_isFloating && !owner->m_isFloating);
+    });
+}
+
 void CHyprPill::renderPass(PHLMONITOR pMonitor, const float& a) {
+    static std::vector<SPillInstance> instances;
+    instances.clear();
+    collectInstances(pMonitor, a, instances);
+
+    const float NOWMS = pillAnimClockMs();
+    for (const auto& i : instances) {
+        const auto INST = i.resolved(g_pGlobalState->animCurves, NOWMS);
+        g_pHyprOpenGL->renderRect(INST.box, INST.color, {.round = static_cast<int>(INST.round), .roundingPower = INST.roundingPower});
+    }
+}
+
+void CHyprPill::collectInstances(PHLMONITOR pMonitor, float a, std::vector<SPillInstance>& out) {
     if (!validMapped(m_pWindow))
         return;
 
@@ -198,30 +326,47 @@ void CHyprPill::renderPass(PHLMONITOR pMonitor, const float& a) {
     m_lastRenderBox    = globalBox;
     m_hasLastRenderBox = true;
 
-    CHyprColor color = m_forcedColor.value_or(m_color);
-    color.a *= std::clamp(m_opacity * a, 0.F, 1.F);
-
-    const auto scaledRadius = m_radius * pMonitor->m_scale;
-    const auto rounded      = std::max(0, static_cast<int>(std::lround(scaledRadius)));
-    g_pHyprOpenGL->renderRect(box, color, {.round = rounded, .roundingPower = m_pWindow->roundingPower()});
+    const auto paintColor = [&](const SPillPaint& paint) {
+        CHyprColor color = m_forcedColor.value_or(paint.color);
+        color.a *= std::clamp(paint.opacity * a, 0.F, 1.F);
+        return color;
+    };
+    const auto paintRound = [&](const SPillPaint& paint) { return static_cast<float>(std::max(0, static_cast<int>(std::lround(paint.radius * pMonitor->m_scale)))); };
+
+    const auto NOW = Time::steadyNow();
+    if (m_paintTransition && m_paintTransition->running(NOW)) {
+        const auto& T = *m_paintTransition;
+        out.push_back({.box           = box,
+                       .color         = paintColor(T.from),
+                       .round         = paintRound(T.from),
+                       .roundingPower = m_pWindow->roundingPower(),
+                       .colorTo       = paintColor(T.to),
+                       .roundTo       = paintRound(T.to),
+                       .startMs       = pillAnimClockMs(T.start),
+                       .durationMs    = T.durationMs,
+                       .curve         = T.curve});
+    } else {
+        const SPillPaint CURRENT = {m_color->value(), m_opacity->value(), m_radius->value()};
+        out.push_back({box, paintColor(CURRENT), paintRound(CURRENT), m_pWindow->roundingPower()});
+    }
 
     static auto* const PDEBUGHOVER = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:debug_hitbox_hover")->getDataStaticPtr();
     static auto* const PDEBUGCLICK = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:debug_hitbox_click")->getDataStaticPtr();
 
     if (**PDEBUGHOVER) {
-        auto hoverBox = hoverHitboxGlobal().translate(-pMonitor->m_position);
-        g_pHyprOpenGL->renderRect(hoverBox, CHyprColor{0.35F, 0.8F, 1.F, 0.22F}, {.round = 0});
+        auto hoverBox = hoverHitboxFromVisible(globalBox).translate(-pMonitor->m_position);
+        out.push_back({hoverBox, CHyprColor{0.35F, 0.8F, 1.F, 0.22F}});
     }
 
     if (**PDEBUGCLICK) {
-        auto clickBox = clickHitboxGlobal().translate(-pMonitor->m_position);
-        g_pHyprOpenGL->renderRect(clickBox, CHyprColor{1.F, 0.5F, 0.3F, 0.22F}, {.round = 0});
+        auto clickBox = clickHitboxFromVisible(globalBox).translate(-pMonitor->m_position);
+        out.push_back({clickBox, CHyprColor{1.F, 0.5F, 0.3F, 0.22F}});
     }
 
     static auto* const PDEBUGCURSOR = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:debug_cursor_state")->getDataStaticPtr();
     if (**PDEBUGCURSOR) {
         const auto cursorPos = g_pInputManager->getMouseCoordsInternal();
-        const bool overPill  = inputIsValid(true) && VECINRECT(cursorPos, hoverHitboxGlobal().x, hoverHitboxGlobal().y, hoverHitboxGlobal().x + hoverHitboxGlobal().w, hoverHitboxGlobal().y + hoverHitboxGlobal().h);
+        const bool overPill  = inputIsValid(true) && hoverHitboxContains(cursorPos);
 
         CBox indicator = box;
         const int indicatorSize    = std::max(6, static_cast<int>(std::lround(10.F * pMonitor->m_scale)));
@@ -232,12 +377,12 @@ void CHyprPill::renderPass(PHLMONITOR pMonitor, const float& a) {
         indicator.y                = box.y - indicator.h - indicatorPadding;
 
         CHyprColor indicatorColor = CHyprColor{0.6F, 0.6F, 0.6F, 0.8F};
-        if (m_dragPending || m_draggingThis)
+        if (m_input.dragPending || m_input.dragging)
             indicatorColor = CHyprColor{1.F, 0.65F, 0.2F, 0.95F};
         else if (overPill)
             indicatorColor = CHyprColor{0.2F, 0.9F, 0.35F, 0.95F};
 
-        g_pHyprOpenGL->renderRect(indicator, indicatorColor, {.round = 0});
+        out.push_back({indicator, indicatorColor});
     }
 
     if (m_targetState != m_currentState || **PDEBUGHOVER || **PDEBUGCLICK || **PDEBUGCURSOR)
@@ -258,6 +403,17 @@ void CHyprPill::damageEntire() {
     m_bLastRelativeBox = box;
 }
 
+void CHyprPill::damageAnimationFrame() {
+    // Called from the animation manager tick, so this must not re-solve the
+    // geometry (which may retarget other variables mid-tick). renderPass()
+    // damages the new box once it differs from the last rendered one.
+    if (m_bLastRelativeBox.w > 0 && m_bLastRelativeBox.h > 0)
+        g_pHyprRenderer->damageBox(m_bLastRelativeBox);
+
+    if (m_hasLastRenderBox)
+        g_pHyprRenderer->damageBox(m_lastRenderBox.copy().expand(8));
+}
+
 CBox CHyprPill::visibleBoxGlobal() const {
     static auto* const PWIDTH  = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:pill_width")->getDataStaticPtr();
     static auto* const PWIDTHINACTIVE = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:pill_width_inactive")->getDataStaticPtr();
@@ -266,8 +422,6 @@ CBox CHyprPill::visibleBoxGlobal() const {
     static auto* const PHITH   = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:hover_hitbox_height")->getDataStaticPtr();
     static auto* const POFFY   = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:hover_hitbox_offset_y")->getDataStaticPtr();
     static auto* const POCCMARGIN = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:dodge_occluder_margin")->getDataStaticPtr();
-    static auto* const PGEOMLERPSPEED = (Hyprlang::FLOAT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:geometry_lerp_speed")->getDataStaticPtr();
-    static auto* const PGEOMLERPEASING = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:geometry_lerp_easing")->getDataStaticPtr();
 
     const auto owner = m_pWindow.lock();
     if (!owner)
@@ -291,168 +445,81 @@ CBox CHyprPill::visibleBoxGlobal() const {
     const float baseWindowLeft  = windowLeft - m_scootApplied;
     const float baseWindowRight = baseWindowLeft + windowWidth;
     const float baseCenterX     = baseWindowLeft + windowWidth * 0.5F;
-    const auto desiredWidth = std::max<int>(1, std::lround(m_width > 1.F ? m_width : **PWIDTH));
+    const auto desiredWidth = std::max<int>(1, std::lround(m_width->value() > 1.F ? m_width->value() : **PWIDTH));
     box.w = std::min<int>(desiredWidth, std::max<int>(1, static_cast<int>(std::lround(windowRight - windowLeft))));
-    box.h              = std::max<int>(1, std::lround(m_height));
+    box.h              = std::max<int>(1, std::lround(m_height->value()));
+    const float offsetY = m_offsetY->value();
 
-    if (m_dragGeometryLocked && (m_dragPending || m_draggingThis)) {
+    if (m_dragGeometryLocked && (m_input.dragPending || m_input.dragging)) {
         box.w = std::clamp(m_dragLockedResolvedW, 1, std::max<int>(1, std::lround(windowRight - windowLeft)));
         const int minX = static_cast<int>(std::lround(windowLeft));
         const int maxX = static_cast<int>(std::lround(windowRight - box.w));
         box.x = std::clamp(minX + m_dragLockedOffsetX, minX, maxX);
-        box.y = std::lround(box.y - box.h - m_offsetY);
+        box.y = std::lround(box.y - box.h - offsetY);
         return box;
     }
 
     std::vector<SHorizontalInterval> occluders;
-    occluders.reserve(g_pCompositor->m_windows.size());
 
     const bool canDetectOccluders = owner->m_workspace && owner->m_workspace->isVisible();
     if (canDetectOccluders) {
-        const auto ownerIt = std::find(g_pCompositor->m_windows.begin(), g_pCompositor->m_windows.end(), owner);
-        const auto ownerZ  = ownerIt == g_pCompositor->m_windows.end() ? 0ULL : static_cast<size_t>(std::distance(g_pCompositor->m_windows.begin(), ownerIt));
-
         const float hoverHeightPad = std::max<Hyprlang::INT>(0, **PHITH);
         const float hoverOffsetY   = **POFFY;
         const float occluderMargin = std::max<Hyprlang::INT>(0, **POCCMARGIN);
 
-        const float ownerTop         = static_cast<float>(box.y);
-        const float basePillY        = std::lround(ownerTop - box.h - m_offsetY);
-        const float occlusionLeft    = baseWindowLeft;
-        const float occlusionRight   = baseWindowRight;
-        const float occlusionTop     = std::lround(basePillY - hoverHeightPad + hoverOffsetY);
-        const float occlusionBottom  = occlusionTop + box.h + hoverHeightPad * 2.F;
-
-        for (const auto& candidate : g_pCompositor->m_windows) {
-            if (!candidate || candidate == owner || candidate->isHidden() || !candidate->m_isMapped)
-                continue;
-
-            if (!candidate->m_workspace || !candidate->m_workspace->isVisible())
-                continue;
-
-            if (candidate->m_monitor != owner->m_monitor)
-                continue;
-
-            const auto candidatePos  = candidate->m_realPosition->value() + candidate->m_floatingOffset;
-            const auto candidateSize = candidate->m_realSize->value();
-
-            const float candidateLeft   = candidatePos.x;
-            const float candidateTop    = candidatePos.y;
-            const float candidateRight  = candidateLeft + candidateSize.x;
-            const float candidateBottom = candidateTop + candidateSize.y;
-
-            const bool overlapsOcclusionX = candidateRight > occlusionLeft && candidateLeft < occlusionRight;
-            const bool overlapsOcclusionY = candidateBottom > occlusionTop && candidateTop < occlusionBottom;
-            if (!overlapsOcclusionX || !overlapsOcclusionY)
-                continue;
-
-            // Only windows crossing the owner's top edge are considered occluders.
-            const bool overlapsOwnerTopEdge = candidateTop < ownerTop && candidateBottom > ownerTop;
-            if (!overlapsOwnerTopEdge)
-                continue;
-
-            const float clippedLeft  = std::max(baseWindowLeft, candidateLeft - occluderMargin);
-            const float clippedRight = std::min(baseWindowRight, candidateRight + occluderMargin);
-            if (clippedRight <= clippedLeft)
-                continue;
-
-            const auto candidateIt = std::find(g_pCompositor->m_windows.begin(), g_pCompositor->m_windows.end(), candidate);
-            const auto candidateZ  = candidateIt == g_pCompositor->m_windows.end() ? 0ULL : static_cast<size_t>(std::distance(g_pCompositor->m_windows.begin(), candidateIt));
+        const float ownerTop = static_cast<float>(box.y);
+        const auto  BAND     = pillOcclusionBand({baseWindowLeft, baseWindowRight}, ownerTop, box.h, offsetY, hoverHeightPad, hoverOffsetY);
 
+        auto considerCandidate = [&](const CBox& candidateBox, size_t candidateZ, size_t ownerZ) {
             // Only dodge windows that are stacked above the owner.
             if (candidateZ <= ownerZ)
-                continue;
+                return;
+
+            if (const auto HIDDEN = pillOccluderInterval(BAND, candidateBox.x, candidateBox.y, candidateBox.w, candidateBox.h, occluderMargin))
+                occluders.push_back(*HIDDEN);
+        };
+
+        const std::array<float, 6> occlusionKey = {BAND.window.start, BAND.window.end, BAND.top, BAND.bottom, ownerTop, occluderMargin};
+        if (m_occluderCacheGeneration == g_pGlobalState->occluderGeneration && m_occluderCacheKey == occlusionKey) {
+            occluders = m_occluderCache;
+        } else if (m_dragSession && m_dragSession->snapshotCurrent()) {
+            // While dragging, neighbours come from the session's snapshot and
+            // only the ones near the occlusion band are looked at.
+            static std::vector<const CWindowSpatialHash::SEntry*> nearby;
+            nearby.clear();
+
+            const float queryTop    = std::min(BAND.top, ownerTop);
+            const float queryBottom = std::max(BAND.bottom, ownerTop);
+            m_dragSession->neighbours.query(CBox{BAND.window.start, queryTop, BAND.window.end - BAND.window.start, queryBottom - queryTop}.expand(1), nearby);
+            for (const auto* entry : nearby) {
+                if (const auto candidate = entry->window.lock(); candidate && !candidate->isHidden() && candidate->m_isMapped)
+                    considerCandidate(entry->box, entry->z, m_dragSession->ownerZ);
+            }
+        } else {
+            const auto ownerIt = std::find(g_pCompositor->m_windows.begin(), g_pCompositor->m_windows.end(), owner);
+            const auto ownerZ  = ownerIt == g_pCompositor->m_windows.end() ? 0ULL : static_cast<size_t>(std::distance(g_pCompositor->m_windows.begin(), ownerIt));
 
-            occluders.push_back({clippedLeft, clippedRight});
-        }
-    }
+            for (size_t candidateZ = 0; candidateZ < g_pCompositor->m_windows.size(); ++candidateZ) {
+                const auto& candidate = g_pCompositor->m_windows[candidateZ];
+                if (!candidate || candidate == owner || candidate->isHidden() || !candidate->m_isMapped)
+                    continue;
 
-    auto solveConstrained = [&](float width, bool& dodging) {
-        const float halfW = std::max(0.5F, width / 2.F);
-        SHorizontalInterval domain{baseWindowLeft + halfW, baseWindowRight - halfW};
-        domain.end = std::max(domain.end, domain.start);
-
-        std::vector<SHorizontalInterval> forbidden;
-        forbidden.reserve(occluders.size());
-        const float hitPad = std::max<Hyprlang::INT>(0, **PHITW);
-        const float avoidDistance = hitPad + halfW;
-        for (const auto& occ : occluders)
-            forbidden.push_back({occ.start - avoidDistance, occ.end + avoidDistance});
-
-        const auto allowed = subtractForbiddenIntervals(domain, forbidden);
-        const bool centerAllowed = std::ranges::any_of(allowed, [&](const auto& interval) { return baseCenterX >= interval.start && baseCenterX <= interval.end; });
-
-        float resolvedCenter = std::clamp(baseCenterX, domain.start, domain.end);
-        if (!allowed.empty()) {
-            if (centerAllowed) {
-                resolvedCenter = std::clamp(baseCenterX, domain.start, domain.end);
-                dodging = false;
-            } else {
-                dodging = true;
-                bool foundLeftOfCenter  = false;
-                bool foundRightOfCenter = false;
-
-                SHorizontalInterval bestLeft;
-                SHorizontalInterval bestRight;
-
-                for (const auto& interval : allowed) {
-                    if (interval.end <= baseCenterX) {
-                        if (!foundLeftOfCenter || interval.end > bestLeft.end) {
-                            bestLeft = interval;
-                            foundLeftOfCenter = true;
-                        }
-                    } else if (interval.start >= baseCenterX) {
-                        if (!foundRightOfCenter || interval.start < bestRight.start) {
-                            bestRight = interval;
-                            foundRightOfCenter = true;
-                        }
-                    }
-                }
+                if (!candidate->m_workspace || !candidate->m_workspace->isVisible())
+                    continue;
 
-                if (foundLeftOfCenter && foundRightOfCenter) {
-                    const float leftGap  = bestLeft.end - bestLeft.start;
-                    const float rightGap = bestRight.end - bestRight.start;
-
-                    if (std::abs(leftGap - rightGap) < 0.001F) {
-                        // Perfectly centered ambiguity prefers left side.
-                        resolvedCenter = bestLeft.end;
-                    } else {
-                        resolvedCenter = leftGap > rightGap ? bestLeft.end : bestRight.start;
-                    }
-                } else if (foundLeftOfCenter) {
-                    resolvedCenter = bestLeft.end;
-                } else if (foundRightOfCenter) {
-                    resolvedCenter = bestRight.start;
-                } else {
-                    const auto& nearest = *std::min_element(allowed.begin(), allowed.end(), [&](const auto& a, const auto& b) {
-                        const float da = std::min(std::abs(baseCenterX - a.start), std::abs(baseCenterX - a.end));
-                        const float db = std::min(std::abs(baseCenterX - b.start), std::abs(baseCenterX - b.end));
-                        return da < db;
-                    });
-                    resolvedCenter = std::clamp(baseCenterX, nearest.start, nearest.end);
-                }
+                if (candidate->m_monitor != owner->m_monitor)
+                    continue;
+
+                considerCandidate(CBox{candidate->m_realPosition->value() + candidate->m_floatingOffset, candidate->m_realSize->value()}, candidateZ, ownerZ);
             }
-        } else {
-            // All positions are blocked; the pill is fully occluded and needs
-            // a scoot to make room.  Keep dodging = true so that the scoot
-            // logic fires.
-            dodging = true;
-            resolvedCenter = std::clamp(baseCenterX, domain.start, domain.end);
         }
 
-        float leftLimit  = baseWindowLeft;
-        float rightLimit = baseWindowRight;
-        for (const auto& occ : occluders) {
-            if (resolvedCenter <= occ.start)
-                rightLimit = std::min(rightLimit, occ.start - std::max<Hyprlang::INT>(0, **PHITW));
-            else if (resolvedCenter >= occ.end)
-                leftLimit = std::max(leftLimit, occ.end + std::max<Hyprlang::INT>(0, **PHITW));
-        }
+        m_occluderCache           = occluders;
+        m_occluderCacheGeneration = g_pGlobalState->occluderGeneration;
+        m_occluderCacheKey        = occlusionKey;
+    }
 
-        const float maxHalfWidth = std::max(0.5F, std::min(resolvedCenter - leftLimit, rightLimit - resolvedCenter));
-        const float maxWidth = std::max(1.F, maxHalfWidth * 2.F);
-        return std::pair{resolvedCenter, std::min(width, maxWidth)};
-    };
+    const float hitPad = std::max<Hyprlang::INT>(0, **PHITW);
 
     float configuredStateWidth = static_cast<float>(**PWIDTH);
     if (m_targetState == ePillVisualState::INACTIVE)
@@ -460,8 +527,8 @@ CBox CHyprPill::visibleBoxGlobal() const {
     else if (m_targetState == ePillVisualState::HOVERED || m_targetState == ePillVisualState::PRESSED)
         configuredStateWidth = static_cast<float>(**PWIDTHHOVER);
 
-    bool dodging = false;
-    auto [resolvedCenter, resolvedWidth] = solveConstrained(std::max(1.F, configuredStateWidth), dodging);
+    const SHorizontalInterval baseWindow{baseWindowLeft, baseWindowRight};
+    auto [resolvedCenter, resolvedWidth, dodging] = solvePillPlacement(baseWindow, baseCenterX, std::max(1.F, configuredStateWidth), hitPad, occluders);
 
     const float freeWidthAtCenter = resolvedWidth;
 
@@ -504,15 +571,19 @@ CBox CHyprPill::visibleBoxGlobal() const {
     const float animatedWidth = std::max(1.F, static_cast<float>(box.w));
     resolvedWidth = std::min({animatedWidth, std::max(1.F, configuredStateWidth), freeWidthAtCenter});
 
-    if (dodging)
-        std::tie(resolvedCenter, resolvedWidth) = solveConstrained(resolvedWidth, dodging);
+    if (dodging) {
+        const auto PLACEMENT = solvePillPlacement(baseWindow, baseCenterX, resolvedWidth, hitPad, occluders);
+        resolvedCenter       = PLACEMENT.center;
+        resolvedWidth        = PLACEMENT.width;
+        dodging              = PLACEMENT.dodging;
+    }
 
     // solveConstrained works in base (un-scooted) coordinates; translate the
     // resolved center to actual (scooted) coordinates for pill placement.
     resolvedCenter += m_scootApplied;
 
     int targetW = std::max<int>(1, std::lround(resolvedWidth));
-    const int targetH = std::max<int>(1, std::lround(m_height));
+    const int targetH = std::max<int>(1, std::lround(m_height->value()));
     const int naturalCenterX = std::clamp(static_cast<int>(std::lround(centerX - targetW / 2.F)),
                                           static_cast<int>(std::lround(windowLeft)),
                                           static_cast<int>(std::lround(windowRight - targetW)));
@@ -536,7 +607,7 @@ CBox CHyprPill::visibleBoxGlobal() const {
     //   dodgeDir < 0  →  dodging left  →  pin right edge
     //   dodgeDir > 0  →  dodging right →  pin left edge
     //   dodgeDir == 0 →  centered      →  grow symmetrically
-    if (m_hovered && m_geometryAnimInitialized) {
+    if (m_input.hovered && m_geometryAnimInitialized) {
         if (m_lastFrameDodgeDir < 0) {
             // Dodging left: keep the right edge fixed.
             targetX = std::clamp(m_lastFramePinnedEdge - targetW,
@@ -570,65 +641,52 @@ CBox CHyprPill::visibleBoxGlobal() const {
     // dodge direction), preserve m_lastFrameDodging so that a subsequent
     // beginDrag() correctly locks the geometry instead of letting the pill
     // teleport to center when clicked again.
-    m_lastFrameDodging   = (m_hovered && m_geometryAnimInitialized && m_lastFrameDodgeDir != 0) ? true : dodging;
+    m_lastFrameDodging   = (m_input.hovered && m_geometryAnimInitialized && m_lastFrameDodgeDir != 0) ? true : dodging;
     m_lastFrameResolvedX = targetX;
     m_lastFrameResolvedW = targetW;
 
-    const bool activeDrag = m_dragPending || m_draggingThis;
+    const bool activeDrag = m_input.dragPending || m_input.dragging;
     if (activeDrag) {
         m_geometryAnimInitialized = false;
         box.w = targetW;
         box.h = targetH;
         box.x = targetX;
-        box.y = std::lround(box.y - box.h - m_offsetY);
+        box.y = std::lround(box.y - box.h - offsetY);
         return box;
     }
 
-    const auto  now = Time::steadyNow();
-    const float dtMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_geometryAnimLastTick).count();
-    m_geometryAnimLastTick = now;
+    const int   windowLeftPx = static_cast<int>(std::lround(windowLeft));
+    const float relativeX    = static_cast<float>(targetX - windowLeftPx);
 
     if (!m_geometryAnimInitialized) {
         m_geometryAnimInitialized = true;
-        m_geometryAnimX           = static_cast<float>(targetX);
-        m_geometryAnimW           = static_cast<float>(targetW);
-        m_geometryAnimH           = static_cast<float>(targetH);
+        m_geometryX->setValueAndWarp(relativeX);
+        m_geometryW->setValueAndWarp(static_cast<float>(targetW));
+        m_geometryH->setValueAndWarp(static_cast<float>(targetH));
     } else {
-        const float lerpSpeed = std::max(0.01F, **PGEOMLERPSPEED);
-        const float dtSeconds = std::max(0.F, dtMs) / 1000.F;
-        const float t         = std::clamp(dtSeconds * lerpSpeed, 0.F, 1.F);
-        const float easedT    = applyNamedEasing(t, std::string{*PGEOMLERPEASING});
-
-        m_geometryAnimX = lerpf(m_geometryAnimX, static_cast<float>(targetX), easedT);
-        m_geometryAnimW = lerpf(m_geometryAnimW, static_cast<float>(targetW), easedT);
-        m_geometryAnimH = lerpf(m_geometryAnimH, static_cast<float>(targetH), easedT);
-
-        if (std::abs(m_geometryAnimX - targetX) < 0.5F)
-            m_geometryAnimX = static_cast<float>(targetX);
-        if (std::abs(m_geometryAnimW - targetW) < 0.5F)
-            m_geometryAnimW = static_cast<float>(targetW);
-        if (std::abs(m_geometryAnimH - targetH) < 0.5F)
-            m_geometryAnimH = static_cast<float>(targetH);
+        animateTo(m_geometryX, relativeX);
+        animateTo(m_geometryW, static_cast<float>(targetW));
+        animateTo(m_geometryH, static_cast<float>(targetH));
     }
 
-    box.w = std::max<int>(1, std::lround(m_geometryAnimW));
-    box.h = std::max<int>(1, std::lround(m_geometryAnimH));
-    box.x = std::clamp(static_cast<int>(std::lround(m_geometryAnimX)), static_cast<int>(std::lround(windowLeft)),
-                       static_cast<int>(std::lround(windowRight - box.w)));
-    box.y = std::lround(box.y - box.h - m_offsetY);
+    box.w = std::max<int>(1, std::lround(m_geometryW->value()));
+    box.h = std::max<int>(1, std::lround(m_geometryH->value()));
+    box.x = std::clamp(windowLeftPx + static_cast<int>(std::lround(m_geometryX->value())), windowLeftPx, static_cast<int>(std::lround(windowRight - box.w)));
+    box.y = std::lround(box.y - box.h - offsetY);
     return box;
 }
 
 CBox CHyprPill::hoverHitboxGlobal() const {
+    return hoverHitboxFromVisible(visibleBoxGlobal());
+}
+
+CBox CHyprPill::hoverHitboxFromVisible(const CBox& visibleBox) const {
     static auto* const PHITW = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:hover_hitbox_width")->getDataStaticPtr();
     static auto* const PHITH = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:hover_hitbox_height")->getDataStaticPtr();
     static auto* const POFFY = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:hover_hitbox_offset_y")->getDataStaticPtr();
 
-    auto               box = visibleBoxGlobal();
-    box.x -= **PHITW;
-    box.w += **PHITW * 2;
-    box.h += **PHITH * 2;
-    box.y = std::lround(box.y - **PHITH + **POFFY);
+    const auto         HITBOX = pillHitbox({visibleBox.x, visibleBox.y, visibleBox.w, visibleBox.h}, **PHITW, **PHITH, **POFFY);
+    CBox               box    = {HITBOX.x, HITBOX.y, HITBOX.w, HITBOX.h};
 
     // When the window is scooted, extend the hover hitbox to also cover the
     // un-scooted pill position.  Without this the scoot moves the hitbox out
@@ -649,16 +707,67 @@ CBox CHyprPill::hoverHitboxGlobal() const {
 }
 
 CBox CHyprPill::clickHitboxGlobal() const {
+    return clickHitboxFromVisible(visibleBoxGlobal());
+}
+
+CBox CHyprPill::clickHitboxFromVisible(const CBox& visibleBox) const {
     static auto* const PHITW = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:click_hitbox_width")->getDataStaticPtr();
     static auto* const PHITH = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:click_hitbox_height")->getDataStaticPtr();
     static auto* const POFFY = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:click_hitbox_offset_y")->getDataStaticPtr();
 
-    auto               box = visibleBoxGlobal();
-    box.x -= **PHITW;
-    box.w += **PHITW * 2;
-    box.h += **PHITH * 2;
-    box.y = std::lround(box.y - **PHITH + **POFFY);
-    return box;
+    const auto         HITBOX = pillHitbox({visibleBox.x, visibleBox.y, visibleBox.w, visibleBox.h}, **PHITW, **PHITH, **POFFY);
+    return {HITBOX.x, HITBOX.y, HITBOX.w, HITBOX.h};
+}
+
+void CHyprPill::recordTelemetry() {
+    static auto* const PTELEMETRY = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:debug_telemetry")->getDataStaticPtr();
+    if (!**PTELEMETRY) {
+        m_telemetryLastFrame.reset();
+        return;
+    }
+
+    const auto NOW      = Time::steadyNow();
+    const auto GEOMETRY = Vector2D{m_geometryX->value(), m_geometryW->value()};
+
+    SPillFrameSample sample;
+    sample.window    = (uintptr_t)m_pWindow.lock().get();
+    sample.timeMs    = std::chrono::duration<double, std::milli>(NOW.time_since_epoch()).count();
+    sample.geometryX = GEOMETRY.x;
+    sample.geometryW = GEOMETRY.y;
+    sample.geometryH = m_geometryH->value();
+    sample.scoot     = m_scootOffset->value();
+    sample.scootDir  = m_scootDir;
+
+    if (m_telemetryLastFrame) {
+        sample.dtMs      = std::chrono::duration<float, std::milli>(NOW - *m_telemetryLastFrame).count();
+        sample.stepX     = GEOMETRY.x - m_telemetryLastGeometry.x;
+        sample.stepW     = GEOMETRY.y - m_telemetryLastGeometry.y;
+        sample.scootFlip = m_scootDir != 0 && m_telemetryLastScootDir != 0 && m_scootDir != m_telemetryLastScootDir;
+    }
+
+    g_pGlobalState->telemetry.push(sample);
+
+    m_telemetryLastFrame    = NOW;
+    m_telemetryLastGeometry = GEOMETRY;
+    m_telemetryLastScootDir = m_scootDir;
+}
+
+void CHyprPill::updateHitboxCache() {
+    // Solved once per frame in draw() so pointer events only do rect tests.
+    const auto VISIBLE = visibleBoxGlobal();
+    m_hoverHitboxCache = hoverHitboxFromVisible(VISIBLE);
+    m_clickHitboxCache = clickHitboxFromVisible(VISIBLE);
+    m_hasHitboxCache   = true;
+}
+
+bool CHyprPill::hoverHitboxContains(const Vector2D& coords) const {
+    const auto hb = m_hasHitboxCache ? m_hoverHitboxCache : hoverHitboxGlobal();
+    return VECINRECT(coords, hb.x, hb.y, hb.x + hb.w, hb.y + hb.h);
+}
+
+bool CHyprPill::clickHitboxContains(const Vector2D& coords) const {
+    const auto hb = m_hasHitboxCache ? m_clickHitboxCache : clickHitboxGlobal();
+    return VECINRECT(coords, hb.x, hb.y, hb.x + hb.w, hb.y + hb.h);
 }
 
 Vector2D CHyprPill::cursorRelativeToPill() const {
@@ -666,9 +775,43 @@ Vector2D CHyprPill::cursorRelativeToPill() const {
 }
 
 bool CHyprPill::isHovering() const {
-    const auto coords = g_pInputManager->getMouseCoordsInternal();
-    const auto hb     = hoverHitboxGlobal();
-    return VECINRECT(coords, hb.x, hb.y, hb.x + hb.w, hb.y + hb.h);
+    return hoverHitboxContains(g_pInputManager->getMouseCoordsInternal());
+}
+
+void CHyprPill::clearHover() {
+    if (pillClearHover(m_input).damage)
+        damageEntire();
+}
+
+void CHyprPill::predictHover(double horizonMs) {
+    if (!pillPredictHover(m_input, pillInputClockMs(), horizonMs))
+        return;
+
+    g_pGlobalState->hoverPredictions++;
+    damageEntire();
+}
+
+void CHyprPill::settleHoverPrediction() {
+    const auto SETTLED = pillSettlePrediction(m_input, pillInputClockMs());
+    if (SETTLED.result == ePillPrediction::CONFIRMED) {
+        g_pGlobalState->hoverPredictionHits++;
+        g_pGlobalState->hoverPredictionLeadMs += SETTLED.leadMs;
+    } else if (SETTLED.result == ePillPrediction::LAPSED && !m_input.hovered)
+        damageEntire();
+}
+
+bool CHyprPill::dragInputIsValid() {
+    static auto* const PENABLED = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:enabled")->getDataStaticPtr();
+
+    // A drag ignores seat grabs like inputIsValid(true) does; the rest was
+    // captured when the session started.
+    return **PENABLED && !m_hidden && m_dragSession && m_dragSession->stillValid();
+}
+
+void CHyprPill::ensureFocused() {
+    const auto PWINDOW = m_pWindow.lock();
+    if (PWINDOW && Desktop::focusState()->window() != PWINDOW)
+        Desktop::focusState()->fullWindowFocus(PWINDOW);
 }
 
 bool CHyprPill::inputIsValid(bool ignoreSeatGrab) {
@@ -680,33 +823,112 @@ bool CHyprPill::inputIsValid(bool ignoreSeatGrab) {
     if (!m_pWindow->m_workspace || !m_pWindow->m_workspace->isVisible() || !g_pInputManager->m_exclusiveLSes.empty())
         return false;
 
-    if (!ignoreSeatGrab && g_pSeatManager->m_seatGrab && !g_pSeatManager->m_seatGrab->accepts(m_pWindow->wlSurface()->resource()))
-        return false;
+    return ignoreSeatGrab || seatGrabAccepts();
+}
 
-    return true;
+bool CHyprPill::seatGrabAccepts() const {
+    return !g_pSeatManager->m_seatGrab || g_pSeatManager->m_seatGrab->accepts(m_pWindow->wlSurface()->resource());
 }
 
-void CHyprPill::beginDrag(SCallbackInfo& info, const Vector2D& coordsGlobal) {
-    if (!g_pGlobalState->dragPill.expired() && g_pGlobalState->dragPill.get() != this)
-        return;
+SPillTarget CHyprPill::dragTarget() {
+    const auto PWINDOW = m_pWindow.lock();
 
-    const auto clickHitbox = clickHitboxGlobal();
-    if (!VECINRECT(coordsGlobal, clickHitbox.x, clickHitbox.y, clickHitbox.x + clickHitbox.w, clickHitbox.y + clickHitbox.h))
-        return;
+    SPillTarget target;
+    target.input     = m_input;
+    target.dragValid = (m_input.dragPending || m_input.dragging) && dragInputIsValid();
+
+    auto PMONITOR = PWINDOW ? PWINDOW->m_monitor.lock() : nullptr;
+    PMONITOR      = PMONITOR ? PMONITOR : Desktop::focusState()->monitor();
+    if (PMONITOR)
+        target.monitor = {PMONITOR->m_position.x, PMONITOR->m_position.y, PMONITOR->m_size.x, PMONITOR->m_size.y};
 
+    return target;
+}
+
+SPillTarget CHyprPill::inputTarget() {
+    const auto HOVER   = m_hasHitboxCache ? m_hoverHitboxCache : hoverHitboxGlobal();
+    const auto CLICK   = m_hasHitboxCache ? m_clickHitboxCache : clickHitboxGlobal();
     const auto PWINDOW = m_pWindow.lock();
-    if (!PWINDOW)
-        return;
 
-    if (Desktop::focusState()->window() != PWINDOW)
-        Desktop::focusState()->fullWindowFocus(PWINDOW);
+    auto       target     = dragTarget();
+    target.hover          = {HOVER.x, HOVER.y, HOVER.w, HOVER.h};
+    target.click          = {CLICK.x, CLICK.y, CLICK.w, CLICK.h};
+    target.acceptsCursor  = PWINDOW && inputIsValid(true);
+    target.acceptsInput   = target.acceptsCursor && seatGrabAccepts();
+    target.floating       = PWINDOW && PWINDOW->m_isFloating;
+    return target;
+}
 
-    if (PWINDOW->m_isFloating)
-        g_pCompositor->changeWindowZOrder(PWINDOW, true);
+const SPillRouting& CHyprPill::snapshotInputRouting() {
+    static auto* const PDRAGTHRESH         = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:drag_pixel_threshold")->getDataStaticPtr();
+    static auto* const PDOUBLECLICKTIMEOUT = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:double_click_timeout")->getDataStaticPtr();
 
-    m_forceFloatForDrag = !PWINDOW->m_isFloating;
-    m_dragCursorOffset = coordsGlobal - (PWINDOW->m_realPosition->value() + PWINDOW->m_floatingOffset);
-    m_dragStartCoords  = coordsGlobal;
+    auto&       routing = g_pGlobalState->inputRouting;
+    const auto& PILLS   = g_pGlobalState->pills;
+
+    routing.pills.resize(PILLS.size());
+    routing.hovered.reset();
+    routing.pointerDrag.reset();
+    routing.dragThresholdPx = **PDRAGTHRESH;
+    routing.doubleClickMs   = **PDOUBLECLICKTIMEOUT;
+
+    for (size_t i = 0; i < PILLS.size(); ++i) {
+        const auto PPILL = PILLS[i].lock();
+        routing.pills[i] = PPILL ? PPILL->inputTarget() : SPillTarget{};
+        if (!PPILL)
+            continue;
+
+        if (g_pGlobalState->hoveredPill.get() == PPILL.get())
+            routing.hovered = i;
+        if (g_pGlobalState->dragPill.get() == PPILL.get())
+            routing.pointerDrag = i;
+    }
+
+    return routing;
+}
+
+const SPillRouting& CHyprPill::refreshInputTarget(std::optional<size_t> index) {
+    auto&       routing = g_pGlobalState->inputRouting;
+    const auto& PILLS   = g_pGlobalState->pills;
+
+    // The handler added or removed a pill, so the indices moved.
+    if (routing.pills.size() != PILLS.size())
+        return snapshotInputRouting();
+
+    if (!index || *index >= PILLS.size())
+        return routing;
+
+    const auto PPILL      = PILLS[*index].lock();
+    routing.pills[*index] = PPILL ? PPILL->inputTarget() : SPillTarget{};
+
+    const auto REFRESH = [&](std::optional<size_t>& slot, const WP<CHyprPill>& owner) {
+        if (PPILL && owner.get() == PPILL.get())
+            slot = index;
+        else if (slot == index)
+            slot.reset();
+    };
+    REFRESH(routing.hovered, g_pGlobalState->hoveredPill);
+    REFRESH(routing.pointerDrag, g_pGlobalState->dragPill);
+    return routing;
+}
+
+bool CHyprPill::canBeginDrag(const Vector2D& coordsGlobal, std::optional<int32_t> touchId) const {
+    // The pointer and each touch point own at most one drag.
+    if (touchId ? g_pGlobalState->touchDrags.contains(*touchId) : !g_pGlobalState->dragPill.expired())
+        return false;
+
+    return !m_pWindow.expired() && clickHitboxContains(coordsGlobal);
+}
+
+void CHyprPill::beginDrag(const Vector2D& coordsGlobal) {
+    const auto PWINDOW = m_pWindow.lock();
+    if (!PWINDOW)
+        return;
+
+    m_dragSession               = makeUnique<SPillDragSession>();
+    m_dragSession->window       = PWINDOW;
+    m_dragSession->workspace    = PWINDOW->m_workspace;
+    m_dragSession->cursorOffset = coordsGlobal - (PWINDOW->m_realPosition->value() + PWINDOW->m_floatingOffset);
 
     m_dragGeometryLocked  = m_lastFrameDodging;
     m_dragLockedResolvedX = m_lastFrameResolvedX;
@@ -716,331 +938,216 @@ void CHyprPill::beginDrag(SCallbackInfo& info, const Vector2D& coordsGlobal) {
     m_dragLockedDodgeDir    = m_lastFrameDodgeDir;
     m_dragLockedPinnedEdge  = m_lastFramePinnedEdge;
 
-    info.cancelled   = true;
-    m_cancelledDown  = true;
-    m_dragPending    = true;
-    g_pGlobalState->dragPill = m_self;
-    m_targetState    = ePillVisualState::PRESSED;
-    m_stateStart     = Time::steadyNow();
+    if (m_input.touchId)
+        g_pGlobalState->touchDrags[*m_input.touchId] = m_self;
+    else
+        g_pGlobalState->dragPill = m_self;
+    m_targetState = ePillVisualState::PRESSED;
     damageEntire();
-    updateCursorShape();
 }
 
-void CHyprPill::endDrag(SCallbackInfo& info) {
-    if (m_cancelledDown)
-        info.cancelled = true;
-
-    m_cancelledDown = false;
-
-    if (m_draggingThis && m_forceFloatForDrag) {
-        const auto PWINDOW = m_pWindow.lock();
-        if (PWINDOW) {
-            if (Desktop::focusState()->window() != PWINDOW)
-                Desktop::focusState()->fullWindowFocus(PWINDOW);
-            g_pKeybindManager->m_dispatchers["settiled"](std::format("address:0x{:x}", (uintptr_t)PWINDOW.get()));
-        }
+void CHyprPill::endDrag(bool retile) {
+    const auto PWINDOW = m_pWindow.lock();
+    if (retile && PWINDOW) {
+        ensureFocused();
+        flushPendingMoves(PWINDOW);
+        g_pKeybindManager->m_dispatchers["settiled"](std::format("address:0x{:x}", (uintptr_t)PWINDOW.get()));
     }
 
     // If still hovered after a drag that had locked geometry, seed the
     // geometry animation from the drag's locked position and restore the
     // dodge offset so the hover-freeze keeps the pill in place instead of
     // jumping to center on the next frame.
-    if (m_hovered && m_dragGeometryLocked) {
+    if (m_input.hovered && m_dragGeometryLocked) {
         m_geometryAnimInitialized = true;
-        // Use the relative offset from the window's current position rather
-        // than the stale absolute position captured at drag start, so that
-        // window movement during the drag does not cause the pill to teleport
-        // in the opposite direction upon release.
-        const auto PWINDOW = m_pWindow.lock();
+        // Seed from the offset relative to the window rather than the stale
+        // absolute position captured at drag start, so that window movement
+        // during the drag does not cause the pill to teleport in the opposite
+        // direction upon release.
+        m_geometryX->setValueAndWarp(static_cast<float>(m_dragLockedOffsetX));
+
+        int pillLeft = m_dragLockedResolvedX;
         if (PWINDOW) {
             const auto PWORKSPACE      = PWINDOW->m_workspace;
             const auto WORKSPACEOFFSET = PWORKSPACE && !PWINDOW->m_pinned ? PWORKSPACE->m_renderOffset->value() : Vector2D();
             const float windowLeft = static_cast<float>(PWINDOW->m_realPosition->value().x + PWINDOW->m_floatingOffset.x + WORKSPACEOFFSET.x);
-            m_geometryAnimX = windowLeft + static_cast<float>(m_dragLockedOffsetX);
-        } else {
-            m_geometryAnimX = static_cast<float>(m_dragLockedResolvedX);
+            pillLeft = static_cast<int>(std::lround(windowLeft)) + m_dragLockedOffsetX;
         }
-        m_geometryAnimLastTick    = Time::steadyNow();
         m_lastFrameDodgeOffset    = m_dragLockedDodgeOffset;
         m_lastFrameDodgeDir       = m_dragLockedDodgeDir;
         // Recompute the pinned edge from the updated animation position so it
         // is consistent with the window's current location after a move.
         if (m_dragLockedDodgeDir < 0)
-            m_lastFramePinnedEdge = static_cast<int>(std::lround(m_geometryAnimX)) + m_dragLockedResolvedW;
+            m_lastFramePinnedEdge = pillLeft + m_dragLockedResolvedW;
         else if (m_dragLockedDodgeDir > 0)
-            m_lastFramePinnedEdge = static_cast<int>(std::lround(m_geometryAnimX));
+            m_lastFramePinnedEdge = pillLeft;
         else
             m_lastFramePinnedEdge = m_dragLockedPinnedEdge;
     }
 
-    m_dragPending        = false;
-    m_draggingThis       = false;
-    m_forceFloatForDrag  = false;
     m_dragGeometryLocked = false;
     m_dragLockedOffsetX  = 0;
-    m_touchEv            = false;
-    m_touchId      = 0;
+    releaseDragOwnership();
+    m_dragSession.reset();
+}
 
+void CHyprPill::releaseDragOwnership() {
     if (g_pGlobalState->dragPill.get() == this)
         g_pGlobalState->dragPill.reset();
 
-    updateCursorShape();
+    // The transition already dropped the touch id, so look for this pill.
+    std::erase_if(g_pGlobalState->touchDrags, [this](const auto& entry) { return entry.second.expired() || entry.second.get() == this; });
 }
 
-bool CHyprPill::focusAndDispatchToWindow(const std::string& dispatcher, const std::string& arg) {
+void CHyprPill::applyEffects(SCallbackInfo& info, const SPillEffects& effects, const Vector2D& coordsGlobal) {
     const auto PWINDOW = m_pWindow.lock();
-    if (!PWINDOW)
-        return false;
-
-    if (Desktop::focusState()->window() != PWINDOW)
-        Desktop::focusState()->fullWindowFocus(PWINDOW);
-
-    g_pKeybindManager->m_dispatchers[dispatcher](arg);
-    return true;
-}
 
-bool CHyprPill::handlePillClickAction(SCallbackInfo& info, uint32_t button) {
-    const auto PWINDOW = m_pWindow.lock();
-    if (!PWINDOW)
-        return false;
-
-    if (button == BTN_MIDDLE) {
+    if (effects.consume)
         info.cancelled = true;
-        return focusAndDispatchToWindow("killactive");
-    }
-
-    if (button == BTN_RIGHT) {
-        if (PWINDOW->m_isFloating)
-            return false;
 
-        info.cancelled = true;
-        return focusAndDispatchToWindow("pseudo");
-    }
+    if (effects.damage)
+        damageEntire();
 
-    if (button != BTN_LEFT)
-        return false;
+    if (effects.focus)
+        ensureFocused();
 
-    static auto* const PDOUBLECLICKTIMEOUT = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:double_click_timeout")->getDataStaticPtr();
-    const auto         now                  = Time::steadyNow();
-    const auto timeoutMs = std::max<Hyprlang::INT>(0, **PDOUBLECLICKTIMEOUT);
-
-    if (std::chrono::duration_cast<std::chrono::milliseconds>(now - m_lastLeftDown).count() <= timeoutMs) {
-        m_lastLeftDown  = now - std::chrono::milliseconds(timeoutMs + 1);
-        m_dragPending   = false;
-        m_draggingThis  = false;
-        m_cancelledDown = false;
-        m_forceFloatForDrag = false;
-        if (g_pGlobalState->dragPill.get() == this)
-            g_pGlobalState->dragPill.reset();
+    if (effects.beginDrag)
+        beginDrag(coordsGlobal);
 
-        info.cancelled = true;
-        updateCursorShape();
-        return focusAndDispatchToWindow("togglefloating");
+    if (effects.raise && PWINDOW) {
+        g_pCompositor->changeWindowZOrder(PWINDOW, true);
+        g_pGlobalState->occludersDirty = true;
     }
 
-    m_lastLeftDown = now;
-    return false;
-}
-
-void CHyprPill::onMouseButton(SCallbackInfo& info, IPointer::SButtonEvent e) {
-    if (e.state != WL_POINTER_BUTTON_STATE_PRESSED) {
-        endDrag(info);
-        return;
-    }
+    if (effects.floatWindow && PWINDOW)
+        g_pKeybindManager->m_dispatchers["setfloating"](std::format("address:0x{:x}", (uintptr_t)PWINDOW.get()));
 
-    if (!inputIsValid()) {
-        updateCursorShape();
-        return;
-    }
+    if (effects.moveWindow)
+        updateDragPosition(coordsGlobal);
 
-    const auto coordsGlobal = g_pInputManager->getMouseCoordsInternal();
-    const auto clickHitbox  = clickHitboxGlobal();
-    if (!VECINRECT(coordsGlobal, clickHitbox.x, clickHitbox.y, clickHitbox.x + clickHitbox.w, clickHitbox.y + clickHitbox.h)) {
-        updateCursorShape(coordsGlobal);
-        return;
-    }
+    if (effects.endDrag)
+        endDrag(effects.retile);
 
-    if (handlePillClickAction(info, e.button))
-        return;
-
-    if (e.button != BTN_LEFT)
+    if (!PWINDOW)
         return;
 
-    beginDrag(info, coordsGlobal);
+    switch (effects.dispatch) {
+        case ePillButton::CLOSE: g_pKeybindManager->m_dispatchers["killactive"](""); break;
+        case ePillButton::PSEUDO: g_pKeybindManager->m_dispatchers["pseudo"](""); break;
+        case ePillButton::TOGGLE_FLOATING: g_pKeybindManager->m_dispatchers["togglefloating"](""); break;
+        default: break;
+    }
 }
 
-void CHyprPill::onTouchDown(SCallbackInfo& info, ITouch::SDownEvent e) {
-    if (!inputIsValid() || e.touchID != 0)
-        return;
+void CHyprPill::onMouseButton(SCallbackInfo& info, ePillButton action, const Vector2D& coords) {
+    const auto PWINDOW = m_pWindow.lock();
 
-    m_touchEv = true;
-    m_touchId = e.touchID;
+    // A press that can't start a drag still counts towards a double click.
+    if (action == ePillButton::PRESS && !canBeginDrag(coords, std::nullopt))
+        action = ePillButton::CLICK;
 
-    auto PMONITOR     = m_pWindow->m_monitor.lock();
-    PMONITOR          = PMONITOR ? PMONITOR : Desktop::focusState()->monitor();
-    const auto COORDS = Vector2D(PMONITOR->m_position.x + e.pos.x * PMONITOR->m_size.x, PMONITOR->m_position.y + e.pos.y * PMONITOR->m_size.y);
-    beginDrag(info, COORDS);
+    applyEffects(info, pillPointerButton(m_input, action, coords.x, coords.y, pillInputClockMs(), PWINDOW && PWINDOW->m_isFloating), coords);
 }
 
-void CHyprPill::onTouchUp(SCallbackInfo& info, ITouch::SUpEvent e) {
-    if (!m_touchEv || e.touchID != m_touchId)
+void CHyprPill::onTouchDown(SCallbackInfo& info, const Vector2D& coordsGlobal, int32_t touchId) {
+    const auto PWINDOW = m_pWindow.lock();
+    if (!canBeginDrag(coordsGlobal, touchId))
         return;
 
-    endDrag(info);
+    applyEffects(info, pillTouchDown(m_input, touchId, coordsGlobal.x, coordsGlobal.y, PWINDOW && PWINDOW->m_isFloating), coordsGlobal);
 }
 
-void CHyprPill::onMouseMove(SCallbackInfo& info, Vector2D coords) {
-    const bool dragOwnedByOtherPill = !g_pGlobalState->dragPill.expired() && g_pGlobalState->dragPill.get() != this;
-    if (dragOwnedByOtherPill) {
-        m_hovered = false;
-        updateCursorShape(coords);
-        return;
-    }
+void CHyprPill::onTouchUp(SCallbackInfo& info) {
+    // Don't lose motion that arrived since the last frame.
+    if (m_dragSession && m_dragSession->pendingTouchCoords)
+        updateDragPosition(*m_dragSession->pendingTouchCoords, m_dragSession->pendingTouchTime.value_or(Time::steadyNow()));
 
-    const bool activeDrag = m_dragPending || m_draggingThis;
-    if (!inputIsValid(activeDrag)) {
-        m_hovered = false;
-        if (activeDrag)
-            info.cancelled = true;
-        updateCursorShape(coords);
-        return;
-    }
-
-    if (m_dragPending) {
-        info.cancelled = true;
-
-        if (Desktop::focusState()->window() != m_pWindow.lock())
-            Desktop::focusState()->fullWindowFocus(m_pWindow.lock());
-    }
+    applyEffects(info, pillTouchUp(m_input), {});
+}
 
-    if (m_draggingThis) {
-        info.cancelled = true;
+void CHyprPill::onMouseMove(SCallbackInfo& info, const Vector2D& coords, const SPillMotionRoute& route) {
+    applyEffects(info, pillPointerMotion(m_input, route), coords);
+    settleHoverPrediction();
+}
 
-        if (Desktop::focusState()->window() != m_pWindow.lock())
-            Desktop::focusState()->fullWindowFocus(m_pWindow.lock());
+void CHyprPill::onTouchMove(SCallbackInfo& info, const Vector2D& coordsGlobal, ePillMotion action) {
+    auto effects = pillTouchMotion(m_input, action);
 
-        updateDragPosition(coords);
-        updateCursorShape(coords);
+    // Coalesced: touch points can report far more often than frames, so only
+    // the last position per touch is applied, from flushTouchDrags().
+    const bool MOVE = std::exchange(effects.moveWindow, false);
+    applyEffects(info, effects, coordsGlobal);
+    if (!MOVE || !m_dragSession)
         return;
-    }
-
-    const auto hb    = hoverHitboxGlobal();
-    const bool wasHovered = m_hovered;
-    m_hovered        = VECINRECT(coords, hb.x, hb.y, hb.x + hb.w, hb.y + hb.h);
-
-    if (m_hovered != wasHovered)
-        damageEntire();
 
-    if (m_hovered) {
-        if (!m_dragPending && Desktop::focusState()->window() != m_pWindow.lock())
-            Desktop::focusState()->fullWindowFocus(m_pWindow.lock());
+    m_dragSession->pendingTouchCoords = coordsGlobal;
+    if (!m_dragSession->pendingTouchTime)
+        m_dragSession->pendingTouchTime = Time::steadyNow();
 
-        if (!m_dragPending)
-            info.cancelled = true;
-    }
+    if (const auto PMONITOR = m_pWindow->m_monitor.lock())
+        g_pCompositor->scheduleFrameForMonitor(PMONITOR);
+}
 
-    if (!m_dragPending || m_touchEv || !validMapped(m_pWindow)) {
-        updateCursorShape(coords);
+void CHyprPill::flushTouchDrags() {
+    if (!g_pGlobalState)
         return;
-    }
 
-    static auto* const PDRAGTHRESH = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:drag_pixel_threshold")->getDataStaticPtr();
-    const auto dragDelta           = coords - m_dragStartCoords;
-    const float dragDistance       = std::sqrt(dragDelta.x * dragDelta.x + dragDelta.y * dragDelta.y);
-    if (dragDistance < std::max<Hyprlang::INT>(0, **PDRAGTHRESH)) {
-        updateCursorShape(coords);
-        return;
+    // Copied out: a drag can end (and erase itself) while it is applied.
+    std::vector<SP<CHyprPill>> pills;
+    pills.reserve(g_pGlobalState->touchDrags.size());
+    for (const auto& [id, pill] : g_pGlobalState->touchDrags) {
+        if (const auto PPILL = pill.lock())
+            pills.push_back(PPILL);
     }
 
-    if (Desktop::focusState()->window() != m_pWindow.lock())
-        Desktop::focusState()->fullWindowFocus(m_pWindow.lock());
+    for (const auto& PPILL : pills) {
+        if (!PPILL->m_dragSession || !PPILL->m_dragSession->pendingTouchCoords)
+            continue;
 
-    m_dragPending  = false;
-    info.cancelled = true;
-    updateDragPosition(coords);
-    updateCursorShape(coords);
+        const auto COORDS = *PPILL->m_dragSession->pendingTouchCoords;
+        const auto TIME   = PPILL->m_dragSession->pendingTouchTime.value_or(Time::steadyNow());
+        PPILL->m_dragSession->pendingTouchCoords.reset();
+        PPILL->m_dragSession->pendingTouchTime.reset();
+        PPILL->updateDragPosition(COORDS, TIME);
+    }
 }
 
-void CHyprPill::onTouchMove(SCallbackInfo& info, ITouch::SMotionEvent e) {
-    if ((!m_dragPending && !m_draggingThis) || !m_touchEv || e.touchID != m_touchId || !validMapped(m_pWindow))
+void CHyprPill::updateDragPosition(const Vector2D& coordsGlobal, const Time::steady_tp& inputTime) {
+    const auto PWINDOW = m_pWindow.lock();
+    if (!PWINDOW)
         return;
 
-    auto PMONITOR     = m_pWindow->m_monitor.lock();
-    PMONITOR          = PMONITOR ? PMONITOR : Desktop::focusState()->monitor();
-    const auto COORDS = Vector2D(PMONITOR->m_position.x + e.pos.x * PMONITOR->m_size.x, PMONITOR->m_position.y + e.pos.y * PMONITOR->m_size.y);
-
-    static auto* const PDRAGTHRESH = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:drag_pixel_threshold")->getDataStaticPtr();
-    if (!m_draggingThis) {
-        const auto dragDelta     = COORDS - m_dragStartCoords;
-        const float dragDistance = std::sqrt(dragDelta.x * dragDelta.x + dragDelta.y * dragDelta.y);
-        if (dragDistance < std::max<Hyprlang::INT>(0, **PDRAGTHRESH))
-            return;
+    if (!m_dragSession)
+        return;
 
-        m_dragPending = false;
-    }
+    // Neighbours only change when the layout does (the window just went
+    // floating, or something mapped), so one snapshot serves the whole drag.
+    if (!m_dragSession->snapshotCurrent())
+        m_dragSession->snapshot();
 
-    info.cancelled = true;
-    updateDragPosition(COORDS);
-    updateCursorShape(COORDS);
+    // Coalesced: only the last position of this frame's motion events is applied.
+    queueWindowMove(PWINDOW, coordsGlobal - m_dragSession->cursorOffset, inputTime);
 }
 
-void CHyprPill::updateDragPosition(const Vector2D& coordsGlobal) {
-    const auto PWINDOW = m_pWindow.lock();
-    if (!PWINDOW)
+void CHyprPill::updateCursorShape() {
+    if (!g_pGlobalState || !Cursor::overrideController)
         return;
 
-    if (!m_draggingThis && m_forceFloatForDrag) {
-        if (Desktop::focusState()->window() != PWINDOW)
-            Desktop::focusState()->fullWindowFocus(PWINDOW);
-        g_pKeybindManager->m_dispatchers["setfloating"](std::format("address:0x{:x}", (uintptr_t)PWINDOW.get()));
-    }
-
-    const auto targetPos = coordsGlobal - m_dragCursorOffset;
-    g_pKeybindManager->m_dispatchers["movewindowpixel"](std::format("exact {} {},address:0x{:x}", (int)targetPos.x, (int)targetPos.y, (uintptr_t)PWINDOW.get()));
-    m_draggingThis = true;
+    updateCursorShape(snapshotInputRouting(), g_pInputManager->getMouseCoordsInternal());
 }
 
-void CHyprPill::updateCursorShape(const std::optional<Vector2D>& coords) {
+void CHyprPill::updateCursorShape(const SPillRouting& routing, const Vector2D& coords) {
     if (!g_pGlobalState || !Cursor::overrideController)
         return;
 
     static auto* const PHOVERCURSOR = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:hover_cursor")->getDataStaticPtr();
     static auto* const PGRABCURSOR  = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:grab_cursor")->getDataStaticPtr();
 
-    const auto         HOVERCURSOR = std::string{*PHOVERCURSOR};
-    const auto         GRABCURSOR  = std::string{*PGRABCURSOR};
-
-    for (auto& p : g_pGlobalState->pills) {
-        const auto PPILL = p.lock();
-        if (!PPILL)
-            continue;
-
-        if (PPILL->m_dragPending || PPILL->m_draggingThis) {
-            if (!GRABCURSOR.empty())
-                Cursor::overrideController->setOverride(GRABCURSOR, Cursor::CURSOR_OVERRIDE_UNKNOWN);
-            else
-                Cursor::overrideController->unsetOverride(Cursor::CURSOR_OVERRIDE_UNKNOWN);
-            return;
-        }
-    }
-
-    const auto COORDS = coords.value_or(g_pInputManager->getMouseCoordsInternal());
-    for (auto& p : g_pGlobalState->pills) {
-        const auto PPILL = p.lock();
-        if (!PPILL || !PPILL->inputIsValid(true))
-            continue;
-
-        const auto HB = PPILL->hoverHitboxGlobal();
-        if (VECINRECT(COORDS, HB.x, HB.y, HB.x + HB.w, HB.y + HB.h)) {
-            if (!HOVERCURSOR.empty())
-                Cursor::overrideController->setOverride(HOVERCURSOR, Cursor::CURSOR_OVERRIDE_UNKNOWN);
-            else
-                Cursor::overrideController->unsetOverride(Cursor::CURSOR_OVERRIDE_UNKNOWN);
-            return;
-        }
+    switch (pillCursorAt(routing, coords.x, coords.y)) {
+        case ePillCursor::GRAB: applyCursorShape(*PGRABCURSOR); break;
+        case ePillCursor::HOVER: applyCursorShape(*PHOVERCURSOR); break;
+        case ePillCursor::DEFAULT: applyCursorShape(nullptr); break;
     }
-
-    Cursor::overrideController->unsetOverride(Cursor::CURSOR_OVERRIDE_UNKNOWN);
 }
 
 void CHyprPill::updateStateAndAnimate() {
@@ -1062,144 +1169,169 @@ void CHyprPill::updateStateAndAnimate() {
     static auto* const POFFINACTIVE    = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:pill_offset_y_inactive")->getDataStaticPtr();
     static auto* const PDURHOVER       = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:anim_duration_hover")->getDataStaticPtr();
     static auto* const PDURPRESS       = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:anim_duration_press")->getDataStaticPtr();
+    static auto* const PGPUPAINT       = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:gpu_paint_animation")->getDataStaticPtr();
+    static auto* const PBATCH          = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:batch_render")->getDataStaticPtr();
 
     const bool focused = Desktop::focusState()->window() == m_pWindow.lock();
 
-    m_hovered = isHovering();
+    m_input.hovered = isHovering();
+    settleHoverPrediction();
 
-    if (m_dragPending || m_draggingThis)
-        m_targetState = ePillVisualState::PRESSED;
-    else if (m_hovered)
-        m_targetState = ePillVisualState::HOVERED;
-    else if (focused)
-        m_targetState = ePillVisualState::ACTIVE;
-    else
-        m_targetState = ePillVisualState::INACTIVE;
+    // A pending prediction needs frames until it is confirmed or lapses.
+    const bool predicted = pillHoverPredicted(m_input, pillInputClockMs());
+    if (predicted)
+        damageEntire();
 
-    const auto now = Time::steadyNow();
+    m_targetState = pillVisualState(focused, m_input.hovered || predicted, m_input.dragPending || m_input.dragging);
 
     if (m_targetState != m_currentState) {
-        m_currentState = m_targetState;
-        m_stateStart   = now;
-        m_fromWidth    = m_width > 0.F ? m_width : **PWIDTH;
-        m_fromHeight   = m_height > 0.F ? m_height : **PHEIGHT;
-        m_fromRadius   = m_radius > 0.F ? m_radius : **PRADIUS;
-        m_fromOpacity  = m_opacity;
-        m_fromOffsetY  = m_offsetY;
-        m_fromColor    = m_color;
+        m_currentState     = m_targetState;
+        const auto& CONFIG = m_targetState == ePillVisualState::PRESSED ? g_pGlobalState->pressAnimConfig : g_pGlobalState->hoverAnimConfig;
+        for (const auto& var : {m_width, m_height, m_radius, m_opacity, m_offsetY})
+            var->setConfig(CONFIG);
+        m_color->setConfig(CONFIG);
     }
 
-    float toWidth   = focused ? **PWIDTH : **PWIDTHINACTIVE;
-    float toHeight  = focused ? **PHEIGHT : **PHEIGHTINACTIVE;
-    float toRadius  = focused ? **PRADIUS : **PRADIUSINACTIVE;
-    float toOpacity = focused ? **POPACTIVE : **POPINACTIVE;
-    float toOffsetY = focused ? **POFFACTIVE : **POFFINACTIVE;
-    CHyprColor toColor = focused ? CHyprColor{(uint64_t)**PCOLACTIVE} : CHyprColor{(uint64_t)**PCOLINACTIVE};
-
-    if (m_targetState == ePillVisualState::HOVERED) {
-        toWidth  = **PWIDTHHOVER;
-        toHeight = **PHEIGHTHOVER;
-        toColor  = CHyprColor{(uint64_t)**PCOLHOVER};
-        toOpacity = **POPACTIVE;
-    } else if (m_targetState == ePillVisualState::PRESSED) {
-        toWidth  = **PWIDTHHOVER;
-        toHeight = **PHEIGHTHOVER;
-        toColor  = CHyprColor{(uint64_t)**PCOLPRESSED};
-        toOpacity = 1.F;
+    const SPillStyle STYLE = {.width           = (float)**PWIDTH,
+                              .height          = (float)**PHEIGHT,
+                              .radius          = (float)**PRADIUS,
+                              .widthInactive   = (float)**PWIDTHINACTIVE,
+                              .heightInactive  = (float)**PHEIGHTINACTIVE,
+                              .radiusInactive  = (float)**PRADIUSINACTIVE,
+                              .widthHover      = (float)**PWIDTHHOVER,
+                              .heightHover     = (float)**PHEIGHTHOVER,
+                              .opacityActive   = **POPACTIVE,
+                              .opacityInactive = **POPINACTIVE,
+                              .offsetYActive   = (float)**POFFACTIVE,
+                              .offsetYInactive = (float)**POFFINACTIVE,
+                              .colorActive     = (uint64_t)**PCOLACTIVE,
+                              .colorInactive   = (uint64_t)**PCOLINACTIVE,
+                              .colorHover      = (uint64_t)**PCOLHOVER,
+                              .colorPressed    = (uint64_t)**PCOLPRESSED};
+    const auto       TARGETS = pillStateTargets(STYLE, m_targetState, focused);
+    const CHyprColor TOCOLOR{TARGETS.color};
+
+    animateTo(m_width, TARGETS.width);
+    animateTo(m_height, TARGETS.height);
+    animateTo(m_offsetY, TARGETS.offsetY);
+
+    // gpu_paint_animation hands color, opacity and radius to the batch shader.
+    // Geometry always stays on the CPU: hitboxes, occlusion and damage follow it.
+    if (**PGPUPAINT && **PBATCH) {
+        const bool PRESS = m_targetState == ePillVisualState::PRESSED;
+        retargetPaint({TOCOLOR, TARGETS.opacity, TARGETS.radius}, std::max<Hyprlang::INT>(1, PRESS ? **PDURPRESS : **PDURHOVER), PRESS ? 1 : 0);
+
+        // Nothing ticks on the CPU, but Hyprland only repaints damaged
+        // regions, so the last drawn box is damaged until the curve ends.
+        // That box is already known; unlike damageEntire() this doesn't
+        // solve the geometry again.
+        if (m_paintTransition->running(Time::steadyNow()))
+            damageAnimationFrame();
+        return;
     }
 
-    const float durationMs = m_targetState == ePillVisualState::PRESSED ? std::max<Hyprlang::INT>(1, **PDURPRESS) : std::max<Hyprlang::INT>(1, **PDURHOVER);
-    const float elapsedMs  = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_stateStart).count();
-    const float t          = std::clamp(elapsedMs / durationMs, 0.F, 1.F);
-    const float easedT     = easeInOut(t);
+    m_paintTransition.reset();
+    animateTo(m_radius, TARGETS.radius);
+    animateTo(m_opacity, TARGETS.opacity);
+    animateTo(m_color, TOCOLOR);
+}
+
+void CHyprPill::retargetPaint(const SPillPaint& to, float durationMs, uint8_t curve) {
+    if (m_paintTransition && m_paintTransition->to == to)
+        return;
 
-    m_width   = lerpf(m_fromWidth, toWidth, easedT);
-    m_height  = lerpf(m_fromHeight, toHeight, easedT);
-    m_radius  = lerpf(m_fromRadius, toRadius, easedT);
-    m_opacity = lerpf(m_fromOpacity, toOpacity, easedT);
-    m_offsetY = lerpf(m_fromOffsetY, toOffsetY, easedT);
-    m_color   = lerpColor(m_fromColor, toColor, easedT);
+    const auto NOW  = Time::steadyNow();
+    const auto FROM = m_paintTransition ? m_paintTransition->at(NOW) : SPillPaint{m_color->value(), m_opacity->value(), m_radius->value()};
+    m_paintTransition = SPillPaintTransition{.from = FROM, .to = to, .start = NOW, .durationMs = durationMs, .curve = curve};
 
-    if (t < 1.F || std::chrono::duration_cast<std::chrono::milliseconds>(now - m_lastFrame).count() > 16)
-        damageEntire();
+    // Park the CPU animations on the target; they are what is drawn once the
+    // transition ends, and what gpu_paint_animation = 0 resumes from.
+    m_color->setValueAndWarp(to.color);
+    m_opacity->setValueAndWarp(to.opacity);
+    m_radius->setValueAndWarp(to.radius);
+    damageEntire();
+}
 
-    m_lastFrame = now;
+SPillPaint SPillPaintTransition::at(const Time::steady_tp& now) const {
+    if (!running(now))
+        return to;
+
+    const float T = evaluatePillCurve(g_pGlobalState->animCurves, curve, std::chrono::duration<float, std::milli>(now - start).count() / durationMs);
+    const auto  LERP = [T](float a, float b) { return a + (b - a) * T; };
+    return {.color   = CHyprColor{LERP(from.color.r, to.color.r), LERP(from.color.g, to.color.g), LERP(from.color.b, to.color.b), LERP(from.color.a, to.color.a)},
+            .opacity = LERP(from.opacity, to.opacity),
+            .radius  = LERP(from.radius, to.radius)};
+}
+
+bool SPillPaintTransition::running(const Time::steady_tp& now) const {
+    return durationMs > 0.F && now < start + std::chrono::microseconds((int64_t)(durationMs * 1000.F));
 }
 
 void CHyprPill::removeScoot() {
     if (std::abs(m_scootApplied) < 0.001F)
         return;
 
+    // Applied immediately: this also runs when the pill is being destroyed,
+    // after which nothing would flush the queue.
     const auto PWINDOW = m_pWindow.lock();
     if (PWINDOW) {
-        const auto curPos  = PWINDOW->m_realPosition->value() + PWINDOW->m_floatingOffset;
-        const auto targetX = static_cast<int>(std::lround(curPos.x - m_scootApplied));
-        const auto targetY = static_cast<int>(std::lround(curPos.y));
-        g_pKeybindManager->m_dispatchers["movewindowpixel"](
-            std::format("exact {} {},address:0x{:x}", targetX, targetY, (uintptr_t)PWINDOW.get()));
+        queueWindowMoveBy(PWINDOW, {-m_scootApplied, 0.F});
+        flushPendingMoves(PWINDOW);
     }
 
     m_scootApplied = 0.F;
-    m_scootOffset  = 0.F;
     m_scootTarget  = 0.F;
     m_scootDir     = 0;
+    m_scootOffset->setValueAndWarp(0.F);
 }
 
 void CHyprPill::updateScoot() {
-    static auto* const PGEOMLERPSPEED  = (Hyprlang::FLOAT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:geometry_lerp_speed")->getDataStaticPtr();
-    static auto* const PGEOMLERPEASING = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprpill:geometry_lerp_easing")->getDataStaticPtr();
-
     const auto PWINDOW = m_pWindow.lock();
     if (!PWINDOW) {
         m_scootTarget  = 0.F;
         m_scootDir     = 0;
-        m_scootOffset  = 0.F;
         m_scootApplied = 0.F;
+        m_scootOffset->setValueAndWarp(0.F);
         return;
     }
 
     // Animate m_scootOffset toward m_scootTarget (set by visibleBoxGlobal).
-    const float lerpSpeed = std::max(0.01F, **PGEOMLERPSPEED);
-    const auto  now       = Time::steadyNow();
-    const float dtMs      = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_scootAnimLastTick).count();
-    m_scootAnimLastTick   = now;
-    const float dtSeconds = std::max(0.F, dtMs) / 1000.F;
-    const float t         = std::clamp(dtSeconds * lerpSpeed, 0.F, 1.F);
-    const float easedT    = applyNamedEasing(t, std::string{*PGEOMLERPEASING});
-    m_scootOffset = lerpf(m_scootOffset, m_scootTarget, easedT);
-    if (std::abs(m_scootOffset - m_scootTarget) < 0.5F)
-        m_scootOffset = m_scootTarget;
+    animateTo(m_scootOffset, m_scootTarget);
 
     // Apply the delta between the desired scoot and what is already applied.
-    const float delta = m_scootOffset - m_scootApplied;
+    // The pill geometry is relative to the window, so it follows the move.
+    const float scootOffset = m_scootOffset->value();
+    const float delta       = scootOffset - m_scootApplied;
     if (std::abs(delta) > 0.001F) {
-        const auto curPos  = PWINDOW->m_realPosition->value() + PWINDOW->m_floatingOffset;
-        const auto targetX = static_cast<int>(std::lround(curPos.x + delta));
-        const auto targetY = static_cast<int>(std::lround(curPos.y));
-        g_pKeybindManager->m_dispatchers["movewindowpixel"](
-            std::format("exact {} {},address:0x{:x}", targetX, targetY, (uintptr_t)PWINDOW.get()));
-        // Shift the geometry animation position by the same delta so the
-        // pill stays locked to the window rather than lagging behind.
-        if (m_geometryAnimInitialized)
-            m_geometryAnimX += delta;
-        m_scootApplied = m_scootOffset;
+        queueWindowMoveBy(PWINDOW, {delta, 0.F});
+        m_scootApplied = scootOffset;
         damageEntire();
     }
 }
 
-void CHyprPill::updateRules() {
+bool CHyprPill::updateRules() {
     const auto PWINDOW = m_pWindow.lock();
+    const auto& props  = PWINDOW->m_ruleApplicator->m_otherProps.props;
 
-    if (!PWINDOW->m_ruleApplicator->m_otherProps.props.contains(g_pGlobalState->noPillRuleIdx) &&
-        !PWINDOW->m_ruleApplicator->m_otherProps.props.contains(g_pGlobalState->pillColorRuleIdx))
-        return;
+    SRuleSnapshot snapshot;
+    if (const auto it = props.find(g_pGlobalState->noPillRuleIdx); it != props.end())
+        snapshot.noPill = it->second->effect;
+    if (const auto it = props.find(g_pGlobalState->pillColorRuleIdx); it != props.end())
+        snapshot.pillColor = it->second->effect;
+
+    // windowUpdateRules fires for any rule change on the window; most of them
+    // do not touch ours.
+    if (snapshot == m_ruleSnapshot)
+        return false;
 
-    if (PWINDOW->m_ruleApplicator->m_otherProps.props.contains(g_pGlobalState->noPillRuleIdx))
-        m_hidden = truthy(PWINDOW->m_ruleApplicator->m_otherProps.props.at(g_pGlobalState->noPillRuleIdx)->effect);
+    m_ruleSnapshot = std::move(snapshot);
 
-    if (PWINDOW->m_ruleApplicator->m_otherProps.props.contains(g_pGlobalState->pillColorRuleIdx))
-        m_forcedColor = CHyprColor(configStringToInt(PWINDOW->m_ruleApplicator->m_otherProps.props.at(g_pGlobalState->pillColorRuleIdx)->effect).value_or(0));
+    const bool prevHidden = m_hidden;
+    m_hidden              = m_ruleSnapshot.noPill && truthy(*m_ruleSnapshot.noPill);
+    m_forcedColor         = m_ruleSnapshot.pillColor ? std::optional{internRuleColor(*m_ruleSnapshot.pillColor)} : std::nullopt;
 
-    g_pDecorationPositioner->repositionDeco(this);
+    if (prevHidden != m_hidden)
+        g_pDecorationPositioner->repositionDeco(this);
     damageEntire();
+    return true;
 }
@@ -5,20 +5,43 @@
 #include <hyprland/src/render/decorations/IHyprWindowDecoration.hpp>
 #include <hyprland/src/devices/IPointer.hpp>
 #include <hyprland/src/devices/ITouch.hpp>
+#include <hyprland/src/helpers/AnimatedVariable.hpp>
 #include <hyprland/src/helpers/time/Time.hpp>
+#include <array>
 #include <optional>
 #include <chrono>
 #include <string>
+#include <vector>
 
 #define private public
 #include <hyprland/src/managers/input/InputManager.hpp>
 #undef private
 
-enum class ePillVisualState {
-    INACTIVE = 0,
-    ACTIVE,
-    HOVERED,
-    PRESSED,
+#include "DragSession.hpp"
+#include "PillBatch.hpp"
+#include "PillInput.hpp"
+#include "PillLayout.hpp"
+#include "PillMotion.hpp"
+
+// The properties of a pill that only affect how it is painted.
+struct SPillPaint {
+    CHyprColor color;
+    float      opacity = 1.F;
+    float      radius  = 0.F;
+
+    bool       operator==(const SPillPaint&) const = default;
+};
+
+// A paint transition handed to the batch shader under gpu_paint_animation.
+struct SPillPaintTransition {
+    SPillPaint      from;
+    SPillPaint      to;
+    Time::steady_tp start;
+    float           durationMs = 0.F;
+    uint8_t         curve      = 0;
+
+    SPillPaint      at(const Time::steady_tp& now) const;
+    bool            running(const Time::steady_tp& now) const;
 };
 
 class CHyprPill : public IHyprWindowDecoration {
@@ -36,71 +59,94 @@ class CHyprPill : public IHyprWindowDecoration {
     virtual uint64_t                   getDecorationFlags();
     virtual std::string                getDisplayName();
 
-    void                               updateRules();
+    // Returns whether any pill rule changed since the last call.
+    bool                               updateRules();
     PHLWINDOW                          getOwner();
 
     void                               renderPass(PHLMONITOR pMonitor, float const& a);
+    void                               collectInstances(PHLMONITOR pMonitor, float a, std::vector<SPillInstance>& out);
     CBox                               visibleBoxGlobal() const;
     CBox                               hoverHitboxGlobal() const;
     CBox                               clickHitboxGlobal() const;
+    bool                               hoverHitboxContains(const Vector2D& coords) const;
+    bool                               clickHitboxContains(const Vector2D& coords) const;
+    bool                               inputIsValid(bool ignoreSeatGrab = false);
+    void                               clearHover();
+    // Shows the hover state ahead of the pointer; lapses after 2x horizonMs.
+    void                               predictHover(double horizonMs);
+
+    // This pill's part of the routing snapshot.
+    SPillTarget                        inputTarget();
+    // Only the drag state, which is all touch motion routing reads.
+    SPillTarget                        dragTarget();
+    // Snapshots every pill into g_pGlobalState->inputRouting, once per event.
+    static const SPillRouting&         snapshotInputRouting();
+    // Re-reads the one pill that handled the event into the snapshot, so the
+    // cursor shape sees its new drag state without another full snapshot.
+    static const SPillRouting&         refreshInputTarget(std::optional<size_t> index);
+
+    // Run the PillInput transition for what routing decided and carry out
+    // its effects; called by the plugin-wide handlers in main.cpp.
+    void                               onMouseButton(SCallbackInfo& info, ePillButton action, const Vector2D& coords);
+    void                               onTouchDown(SCallbackInfo& info, const Vector2D& coordsGlobal, int32_t touchId);
+    void                               onTouchUp(SCallbackInfo& info);
+    void                               onMouseMove(SCallbackInfo& info, const Vector2D& coords, const SPillMotionRoute& route);
+    void                               onTouchMove(SCallbackInfo& info, const Vector2D& coordsGlobal, ePillMotion action);
+
+    // Without a snapshot, takes one; for the rare calls outside event routing.
+    static void                        updateCursorShape();
+    static void                        updateCursorShape(const SPillRouting& routing, const Vector2D& coords);
+
+    static void                        queueWindowMove(PHLWINDOW pWindow, const Vector2D& target, std::optional<Time::steady_tp> inputTime = std::nullopt);
+    static void                        queueWindowMoveBy(PHLWINDOW pWindow, const Vector2D& delta);
+    static void                        flushPendingMoves(PHLWINDOW pWindow = nullptr);
+    // Applies the latest position of every touch drag, once per frame.
+    static void                        flushTouchDrags();
 
     WP<CHyprPill>                      m_self;
 
   private:
-    void                      onMouseButton(SCallbackInfo& info, IPointer::SButtonEvent e);
-    void                      onTouchDown(SCallbackInfo& info, ITouch::SDownEvent e);
-    void                      onTouchUp(SCallbackInfo& info, ITouch::SUpEvent e);
-    void                      onMouseMove(SCallbackInfo& info, Vector2D coords);
-    void                      onTouchMove(SCallbackInfo& info, ITouch::SMotionEvent e);
-
-    void                      beginDrag(SCallbackInfo& info, const Vector2D& coordsGlobal);
-    void                      endDrag(SCallbackInfo& info);
-    bool                      handlePillClickAction(SCallbackInfo& info, uint32_t button);
-    bool                      focusAndDispatchToWindow(const std::string& dispatcher, const std::string& arg = "");
+    bool                      canBeginDrag(const Vector2D& coordsGlobal, std::optional<int32_t> touchId) const;
+    void                      beginDrag(const Vector2D& coordsGlobal);
+    void                      endDrag(bool retile);
+    void                      releaseDragOwnership();
+    void                      applyEffects(SCallbackInfo& info, const SPillEffects& effects, const Vector2D& coordsGlobal);
     void                      updateStateAndAnimate();
+    void                      retargetPaint(const SPillPaint& to, float durationMs, uint8_t curve);
+    void                      damageAnimationFrame();
     void                      updateScoot();
     void                      removeScoot();
-    void                      updateDragPosition(const Vector2D& coordsGlobal);
-    void                      updateCursorShape(const std::optional<Vector2D>& coords = std::nullopt);
-    bool                      inputIsValid(bool ignoreSeatGrab = false);
+    void                      updateDragPosition(const Vector2D& coordsGlobal, const Time::steady_tp& inputTime = Time::steadyNow());
+    CBox                      hoverHitboxFromVisible(const CBox& visibleBox) const;
+    CBox                      clickHitboxFromVisible(const CBox& visibleBox) const;
+    void                      updateHitboxCache();
+    void                      recordTelemetry();
+    bool                      occludedByWindowAbove(const CBox& box) const;
+    bool                      dragInputIsValid();
+    bool                      seatGrabAccepts() const;
+    void                      ensureFocused();
     Vector2D                  cursorRelativeToPill() const;
     bool                      isHovering() const;
+    void                      settleHoverPrediction();
 
     PHLWINDOWREF              m_pWindow;
     CBox                      m_bAssignedBox;
     CBox                      m_bLastRelativeBox;
 
     bool                      m_hidden          = false;
-    bool                      m_dragPending     = false;
-    bool                      m_draggingThis    = false;
-    bool                      m_touchEv         = false;
-    bool                      m_cancelledDown   = false;
-    bool                      m_hovered         = false;
-    bool                      m_forceFloatForDrag = false;
-    int                       m_touchId         = 0;
-    Vector2D                  m_dragCursorOffset;
-    Vector2D                  m_dragStartCoords;
-    Time::steady_tp           m_lastLeftDown      = Time::steadyNow() - std::chrono::seconds(5);
+    // Changed only by the PillInput transitions; clocks are pillInputClockMs.
+    SPillInputState           m_input;
+    UP<SPillDragSession>      m_dragSession;
 
     ePillVisualState          m_currentState    = ePillVisualState::INACTIVE;
     ePillVisualState          m_targetState     = ePillVisualState::INACTIVE;
 
-    Time::steady_tp           m_stateStart      = Time::steadyNow();
-    Time::steady_tp           m_lastFrame       = Time::steadyNow();
-
-    float                     m_width           = 0.F;
-    float                     m_height          = 0.F;
-    float                     m_radius          = 0.F;
-    float                     m_opacity         = 1.F;
-    float                     m_offsetY         = 0.F;
-    CHyprColor                m_color;
-
-    float                     m_fromWidth       = 0.F;
-    float                     m_fromHeight      = 0.F;
-    float                     m_fromRadius      = 0.F;
-    float                     m_fromOpacity     = 1.F;
-    float                     m_fromOffsetY     = 0.F;
-    CHyprColor                m_fromColor;
+    PHLANIMVAR<float>         m_width;
+    PHLANIMVAR<float>         m_height;
+    PHLANIMVAR<float>         m_radius;
+    PHLANIMVAR<float>         m_opacity;
+    PHLANIMVAR<float>         m_offsetY;
+    PHLANIMVAR<CHyprColor>    m_color;
 
     mutable bool              m_lastFrameDodging     = false;
     mutable int               m_lastFrameResolvedX   = 0;
@@ -109,17 +155,23 @@ class CHyprPill : public IHyprWindowDecoration {
     mutable int               m_lastFrameDodgeDir    = 0;
     mutable int               m_lastFramePinnedEdge  = 0;
 
+    // Occluders from the last solve, valid while the occluder generation and
+    // this pill's occlusion band are unchanged.
+    mutable std::vector<SHorizontalInterval> m_occluderCache;
+    mutable uint64_t          m_occluderCacheGeneration = 0;
+    mutable std::array<float, 6> m_occluderCacheKey     = {};
+
     mutable float             m_scootTarget          = 0.F;
     mutable int               m_scootDir             = 0;
-    float                     m_scootOffset          = 0.F;
+    PHLANIMVAR<float>         m_scootOffset;
     float                     m_scootApplied         = 0.F;
-    Time::steady_tp           m_scootAnimLastTick    = Time::steadyNow();
 
+    // Geometry X is kept relative to the window's left edge so the pill
+    // follows window moves (including scoots) without re-animating.
     mutable bool              m_geometryAnimInitialized = false;
-    mutable float             m_geometryAnimX           = 0.F;
-    mutable float             m_geometryAnimW           = 0.F;
-    mutable float             m_geometryAnimH           = 0.F;
-    mutable Time::steady_tp   m_geometryAnimLastTick    = Time::steadyNow();
+    PHLANIMVAR<float>         m_geometryX;
+    PHLANIMVAR<float>         m_geometryW;
+    PHLANIMVAR<float>         m_geometryH;
     bool                      m_dragGeometryLocked   = false;
     int                       m_dragLockedResolvedX  = 0;
     int                       m_dragLockedResolvedW  = 0;
@@ -131,13 +183,25 @@ class CHyprPill : public IHyprWindowDecoration {
     bool                      m_hasLastRenderBox     = false;
     CBox                      m_lastRenderBox;
 
-    SP<HOOK_CALLBACK_FN>      m_pMouseButtonCallback;
-    SP<HOOK_CALLBACK_FN>      m_pTouchDownCallback;
-    SP<HOOK_CALLBACK_FN>      m_pTouchUpCallback;
-    SP<HOOK_CALLBACK_FN>      m_pTouchMoveCallback;
-    SP<HOOK_CALLBACK_FN>      m_pMouseMoveCallback;
+    // Hitboxes solved in draw(), so routing a pointer event is a rect test.
+    bool                      m_hasHitboxCache       = false;
+    CBox                      m_hoverHitboxCache;
+    CBox                      m_clickHitboxCache;
+
+    std::optional<Time::steady_tp> m_telemetryLastFrame;
+    Vector2D                  m_telemetryLastGeometry;
+    int                       m_telemetryLastScootDir = 0;
 
     std::optional<CHyprColor> m_forcedColor;
+    std::optional<SPillPaintTransition> m_paintTransition;
+
+    // Raw rule effects from the last updateRules, for change detection.
+    struct SRuleSnapshot {
+        std::optional<std::string> noPill;
+        std::optional<std::string> pillColor;
+
+        bool                       operator==(const SRuleSnapshot&) const = default;
+    } m_ruleSnapshot;
 
     friend class CPillPassElement;
 };
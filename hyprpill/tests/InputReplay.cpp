@@ -0,0 +1,765 @@
+// Replays a hyprpill input trace against the layout it recorded, without a
+// compositor. Pills and hyprbars bars are mocked from the recorded window
+// boxes and driven through the same routing and transition functions the
+// plugins use; only the effects are carried out on the mock, so nothing is
+// ever dispatched to real windows. Reports the CPU time routing took per
+// event type and every hover, focus, drag, cursor, pill and bar action.
+// With --predict <ms> pointer motion also runs hover_prediction at that
+// horizon, and the report says how early it showed hovers and how often it
+// was wrong.
+//
+//   hyprpill-replay <trace> [-j] [--predict <ms>]
+//   hyprpill-replay --self-test
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <format>
+#include <linux/input-event-codes.h>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../../hyprbars/BarInput.hpp"
+#include "../InputTrace.hpp"
+#include "../PillInput.hpp"
+#include "../PillLayout.hpp"
+#include "../PillMotion.hpp"
+
+namespace {
+// The plugins' default config.
+struct SMockConfig {
+    SPillStyle         pillStyle = {.width           = 100.F,
+                                    .height          = 12.F,
+                                    .widthInactive   = 26.F,
+                                    .heightInactive  = 4.F,
+                                    .widthHover      = 150.F,
+                                    .heightHover     = 12.F,
+                                    .offsetYActive   = 20.F,
+                                    .offsetYInactive = 8.F};
+    float              hoverPadW = 40.F, hoverPadH = 20.F, hoverOffsetY = -9.F;
+    float              clickPadW = 35.F, clickPadH = 15.F, clickOffsetY = -4.F;
+    float              occluderMargin  = 4.F;
+    double             dragThresholdPx = 8.0;
+    double             doubleClickMs   = 250.0;
+
+    float              barHeight = 15.F, barPadding = 7.F, barButtonPadding = 5.F;
+    std::vector<float> barButtons = {10.F, 10.F};
+    // on_double_click is unset by default; bind it so double clicks show.
+    bool               barDoubleClickBound = true;
+} const CONFIG;
+
+struct SMockWindow {
+    uint32_t  id       = 0;
+    uint16_t  monitor  = 0;
+    bool      floating = false;
+    SPillRect box;
+};
+
+struct SMockPill {
+    SPillInputState input;
+    // Where the drag grabbed the window, as SPillDragSession keeps it.
+    double          cursorOffsetX = 0.0, cursorOffsetY = 0.0;
+};
+
+struct SPredictionStats {
+    uint64_t predictions = 0;
+    uint64_t hits        = 0;
+    uint64_t lapses      = 0;
+    double   leadMs      = 0.0; // summed over the hits
+};
+
+class CMockSession {
+  public:
+    explicit CMockSession(double predictMs) : m_predictMs(predictMs) {}
+
+    void                     replay(const STraceRecord& rec);
+
+    std::vector<std::string> transitions;
+    SPredictionStats         predictionStats;
+
+  private:
+    void                     layoutRecord(const STraceRecord& rec);
+    // Windows that are gone take their input state with them.
+    void                     dropClosedWindows();
+    void                     snapshot();
+    SPillTarget              pillTarget(uint32_t id) const;
+    SPillRect                visiblePill(size_t stackIndex) const;
+    SPillRect                barBox(const SMockWindow& window) const;
+    SMockWindow*             windowById(uint32_t id);
+    std::optional<uint32_t>  windowAt(double x, double y) const;
+    uint32_t                 routedId(size_t index) const;
+    void                     focus(uint32_t id);
+    // Carries out a transition's effects the way CHyprPill::applyEffects does.
+    void                     applyPillEffects(uint32_t id, const SPillEffects& effects, double x, double y);
+    void                     log(std::string text);
+
+    void                     pointerMotion(double x, double y);
+    void                     pointerButton(uint32_t button, bool pressed, double x, double y);
+    void                     touchDown(int32_t touchId, double nx, double ny);
+    void                     touchUp(int32_t touchId);
+    void                     touchMotion(int32_t touchId, double nx, double ny);
+    void                     barsDown(double x, double y, std::optional<int32_t> touchId);
+    void                     updateCursor(double x, double y);
+    // What main.cpp and CHyprPill do for hover_prediction.
+    void                     predictHover();
+    void                     settlePredictions();
+
+    std::vector<SPillRect>               m_monitors;
+    std::vector<SMockWindow>             m_windows; // bottom of the stack first
+    std::optional<uint32_t>              m_focused;
+    std::map<uint32_t, SMockPill>        m_pills;
+    std::map<uint32_t, SBarInputState>   m_bars;
+    std::optional<uint32_t>              m_hovered;
+    std::optional<uint32_t>              m_pointerDrag;
+    std::map<int32_t, uint32_t>          m_touchDrags; // touch id to the pill it holds
+    ePillCursor                          m_cursor = ePillCursor::DEFAULT;
+    double                               m_nowMs  = 0.0;
+    uint64_t                             m_timeUs = 0;
+    double                               m_predictMs = 0.0;
+    SPointerHistory                      m_pointerHistory;
+
+    // Routing snapshot; pills are in window id order, like creation order.
+    SPillRouting                         m_routing;
+    std::vector<uint32_t>                m_routedIds;
+};
+
+std::string describe(std::optional<uint32_t> id) {
+    return id ? std::to_string(*id) : "none";
+}
+
+const char* cursorName(ePillCursor cursor) {
+    switch (cursor) {
+        case ePillCursor::HOVER: return "hover";
+        case ePillCursor::GRAB: return "grab";
+        default: return "default";
+    }
+}
+
+void CMockSession::log(std::string text) {
+    transitions.emplace_back(std::format("{} {}", m_timeUs, text));
+}
+
+SMockWindow* CMockSession::windowById(uint32_t id) {
+    const auto IT = std::ranges::find(m_windows, id, &SMockWindow::id);
+    return IT != m_windows.end() ? &*IT : nullptr;
+}
+
+std::optional<uint32_t> CMockSession::windowAt(double x, double y) const {
+    for (auto it = m_windows.rbegin(); it != m_windows.rend(); ++it) {
+        if (it->box.contains(x, y) || barBox(*it).contains(x, y))
+            return it->id;
+    }
+
+    return std::nullopt;
+}
+
+uint32_t CMockSession::routedId(size_t index) const {
+    return m_routedIds[index];
+}
+
+SPillRect CMockSession::barBox(const SMockWindow& window) const {
+    return {window.box.x, window.box.y - CONFIG.barHeight, window.box.w, CONFIG.barHeight};
+}
+
+// The settled pill box: CHyprPill::visibleBoxGlobal once its animations are
+// done, without scoots.
+SPillRect CMockSession::visiblePill(size_t stackIndex) const {
+    const auto& WINDOW  = m_windows[stackIndex];
+    const auto  PILLIT  = m_pills.find(WINDOW.id);
+    const auto  INPUT   = PILLIT != m_pills.end() ? PILLIT->second.input : SPillInputState{};
+    const bool  FOCUSED = m_focused == WINDOW.id;
+    const bool  HOVERED = INPUT.hovered || pillHoverPredicted(INPUT, m_nowMs);
+    const auto  TARGETS = pillStateTargets(CONFIG.pillStyle, pillVisualState(FOCUSED, HOVERED, INPUT.dragPending || INPUT.dragging), FOCUSED);
+
+    const SHorizontalInterval SPAN = {(float)WINDOW.box.x, (float)(WINDOW.box.x + WINDOW.box.w)};
+    const auto                BAND = pillOcclusionBand(SPAN, WINDOW.box.y, TARGETS.height, TARGETS.offsetY, CONFIG.hoverPadH, CONFIG.hoverOffsetY);
+
+    std::vector<SHorizontalInterval> occluders;
+    for (size_t i = stackIndex + 1; i < m_windows.size(); ++i) {
+        const auto& OTHER = m_windows[i];
+        if (OTHER.monitor != WINDOW.monitor)
+            continue;
+
+        if (const auto HIDDEN = pillOccluderInterval(BAND, OTHER.box.x, OTHER.box.y, OTHER.box.w, OTHER.box.h, CONFIG.occluderMargin))
+            occluders.push_back(*HIDDEN);
+    }
+
+    const float CENTER    = (SPAN.start + SPAN.end) / 2.F;
+    const auto  PLACEMENT = solvePillPlacement(SPAN, CENTER, TARGETS.width, CONFIG.hoverPadW, occluders);
+    const float W         = std::max(1.F, std::round(std::min(PLACEMENT.width, (float)WINDOW.box.w)));
+    const float X         = std::clamp(std::round(PLACEMENT.center - W / 2.F), SPAN.start, std::max(SPAN.start, SPAN.end - W));
+    return {X, std::round(WINDOW.box.y - TARGETS.height - TARGETS.offsetY), W, TARGETS.height};
+}
+
+SPillTarget CMockSession::pillTarget(uint32_t id) const {
+    const auto  STACKINDEX = std::ranges::find(m_windows, id, &SMockWindow::id) - m_windows.begin();
+    const auto& WINDOW     = m_windows[STACKINDEX];
+    const auto  PILLIT     = m_pills.find(id);
+    const auto  VISIBLE    = visiblePill(STACKINDEX);
+
+    SPillTarget target;
+    target.hover = pillHitbox(VISIBLE, CONFIG.hoverPadW, CONFIG.hoverPadH, CONFIG.hoverOffsetY);
+    target.click = pillHitbox(VISIBLE, CONFIG.clickPadW, CONFIG.clickPadH, CONFIG.clickOffsetY);
+    if (WINDOW.monitor < m_monitors.size())
+        target.monitor = m_monitors[WINDOW.monitor];
+    target.acceptsInput  = true;
+    target.acceptsCursor = true;
+    target.floating      = WINDOW.floating;
+    target.dragValid     = true;
+    if (PILLIT != m_pills.end())
+        target.input = PILLIT->second.input;
+    return target;
+}
+
+void CMockSession::snapshot() {
+    m_routedIds.clear();
+    for (const auto& w : m_windows)
+        m_routedIds.push_back(w.id);
+    std::ranges::sort(m_routedIds);
+
+    m_routing.pills.clear();
+    m_routing.hovered.reset();
+    m_routing.pointerDrag.reset();
+    m_routing.dragThresholdPx = CONFIG.dragThresholdPx;
+    m_routing.doubleClickMs   = CONFIG.doubleClickMs;
+
+    for (size_t i = 0; i < m_routedIds.size(); ++i) {
+        const auto ID = m_routedIds[i];
+        m_routing.pills.push_back(pillTarget(ID));
+
+        if (m_hovered == ID)
+            m_routing.hovered = i;
+        if (m_pointerDrag == ID)
+            m_routing.pointerDrag = i;
+    }
+}
+
+void CMockSession::focus(uint32_t id) {
+    if (m_focused == id)
+        return;
+
+    log(std::format("focus {} -> {}", describe(m_focused), id));
+    m_focused = id;
+}
+
+void CMockSession::applyPillEffects(uint32_t id, const SPillEffects& effects, double x, double y) {
+    auto&      pill   = m_pills[id];
+    const auto WINDOW = windowById(id);
+    if (!WINDOW)
+        return;
+
+    if (effects.damage)
+        log(std::format("pill {} {}", id, pill.input.hovered ? "hover" : "unhover"));
+
+    if (effects.focus)
+        focus(id);
+
+    if (effects.beginDrag) {
+        pill.cursorOffsetX = x - WINDOW->box.x;
+        pill.cursorOffsetY = y - WINDOW->box.y;
+        if (pill.input.touchId) {
+            m_touchDrags[*pill.input.touchId] = id;
+            log(std::format("pill {} touch_press {}", id, *pill.input.touchId));
+        } else {
+            m_pointerDrag = id;
+            log(std::format("pill {} press", id));
+        }
+    }
+
+    if (effects.raise) {
+        std::ranges::rotate(std::ranges::find(m_windows, id, &SMockWindow::id), std::ranges::find(m_windows, id, &SMockWindow::id) + 1, m_windows.end());
+        log(std::format("pill {} raise", id));
+    }
+
+    // The rotate above moved the window.
+    auto* const PWINDOW = windowById(id);
+
+    if (effects.floatWindow) {
+        PWINDOW->floating = true;
+        log(std::format("pill {} float", id));
+    }
+
+    if (effects.moveWindow) {
+        PWINDOW->box.x = x - pill.cursorOffsetX;
+        PWINDOW->box.y = y - pill.cursorOffsetY;
+        log(std::format("pill {} move {} {}", id, PWINDOW->box.x, PWINDOW->box.y));
+    }
+
+    if (effects.endDrag) {
+        if (m_pointerDrag == id)
+            m_pointerDrag.reset();
+        std::erase_if(m_touchDrags, [id](const auto& entry) { return entry.second == id; });
+        log(std::format("pill {} release", id));
+    }
+
+    if (effects.retile) {
+        PWINDOW->floating = false;
+        log(std::format("pill {} retile", id));
+    }
+
+    switch (effects.dispatch) {
+        case ePillButton::CLOSE: log(std::format("pill {} close", id)); break;
+        case ePillButton::PSEUDO: log(std::format("pill {} pseudo", id)); break;
+        case ePillButton::TOGGLE_FLOATING:
+            PWINDOW->floating = !PWINDOW->floating;
+            log(std::format("pill {} toggle_floating", id));
+            break;
+        default: break;
+    }
+}
+
+void CMockSession::layoutRecord(const STraceRecord& rec) {
+    switch ((eTraceEvent)rec.type) {
+        case eTraceEvent::LAYOUT:
+            m_monitors.clear();
+            m_windows.clear();
+            break;
+        case eTraceEvent::MONITOR: m_monitors.push_back({rec.x, rec.y, rec.w, rec.h}); break;
+        case eTraceEvent::WINDOW:
+            m_windows.push_back({.id = rec.id, .monitor = rec.reserved, .floating = (rec.state & TRACE_WINDOW_FLOATING) != 0, .box = {rec.x, rec.y, rec.w, rec.h}});
+            if (rec.state & TRACE_WINDOW_FOCUSED)
+                m_focused = rec.id;
+            break;
+        default: break;
+    }
+}
+
+void CMockSession::dropClosedWindows() {
+    const auto GONE = [&](const auto& entry) { return !windowById(entry.first); };
+    std::erase_if(m_pills, GONE);
+    std::erase_if(m_bars, GONE);
+    std::erase_if(m_touchDrags, [&](const auto& entry) { return !windowById(entry.second); });
+
+    for (auto* id : {&m_hovered, &m_pointerDrag, &m_focused}) {
+        if (*id && !windowById(**id))
+            id->reset();
+    }
+}
+
+void CMockSession::updateCursor(double x, double y) {
+    snapshot();
+    const auto CURSOR = pillCursorAt(m_routing, x, y);
+    if (CURSOR != m_cursor)
+        log(std::format("cursor {} -> {}", cursorName(m_cursor), cursorName(CURSOR)));
+    m_cursor = CURSOR;
+}
+
+void CMockSession::predictHover() {
+    const auto PREDICTED = predictPointer(m_pointerHistory, m_predictMs);
+    if (!PREDICTED)
+        return;
+
+    if (const auto INDEX = pillAt(m_routing, PREDICTED->x, PREDICTED->y, false)) {
+        const auto ID = routedId(*INDEX);
+        if (pillPredictHover(m_pills[ID].input, m_nowMs, m_predictMs)) {
+            predictionStats.predictions++;
+            log(std::format("pill {} predict", ID));
+        }
+    }
+}
+
+// The plugin settles every frame; here each pointer event stands in for
+// one. That only delays noticing lapses, the lead of a hit is exact.
+void CMockSession::settlePredictions() {
+    for (auto& [id, pill] : m_pills) {
+        const auto SETTLED = pillSettlePrediction(pill.input, m_nowMs);
+        if (SETTLED.result == ePillPrediction::CONFIRMED) {
+            predictionStats.hits++;
+            predictionStats.leadMs += SETTLED.leadMs;
+            log(std::format("pill {} predict_hit {:.1f}ms", id, SETTLED.leadMs));
+        } else if (SETTLED.result == ePillPrediction::LAPSED) {
+            predictionStats.lapses++;
+            log(std::format("pill {} predict_lapse", id));
+        }
+    }
+}
+
+void CMockSession::pointerMotion(double x, double y) {
+    recordPointerSample(m_pointerHistory, x, y, m_nowMs);
+
+    snapshot();
+    const auto ROUTE = routePointerMotion(m_routing, x, y);
+    if (ROUTE.unhover) {
+        const auto ID = routedId(*ROUTE.unhover);
+        applyPillEffects(ID, pillClearHover(m_pills[ID].input), x, y);
+    }
+
+    const auto TARGET = ROUTE.target ? std::optional<uint32_t>{routedId(*ROUTE.target)} : std::nullopt;
+    if (TARGET != m_hovered)
+        log(std::format("hover {} -> {}", describe(m_hovered), describe(TARGET)));
+    m_hovered = TARGET;
+
+    if (TARGET)
+        applyPillEffects(*TARGET, pillPointerMotion(m_pills[*TARGET].input, ROUTE), x, y);
+    else if (m_predictMs > 0.0)
+        predictHover();
+
+    settlePredictions();
+
+    for (auto& w : m_windows) {
+        if (barPointerMotion(m_bars[w.id]))
+            log(std::format("bar {} drag_start", w.id));
+    }
+
+    updateCursor(x, y);
+}
+
+void CMockSession::barsDown(double x, double y, std::optional<int32_t> touchId) {
+    const auto UNDER = windowAt(x, y);
+
+    for (const auto& w : m_windows) {
+        // CHyprBar::inputIsValid: the bar's window is under the pointer or focused.
+        if (UNDER != w.id && m_focused != w.id)
+            continue;
+
+        const auto BAR  = barBox(w);
+        const auto DOWN = barPointerDown(m_bars[w.id], {.barWidth = (float)BAR.w, .barHeight = CONFIG.barHeight, .padding = CONFIG.barPadding,
+                                                        .buttonPadding = CONFIG.barButtonPadding},
+                                         CONFIG.barButtons, {(float)(x - BAR.x), (float)(y - BAR.y)}, touchId, m_nowMs, CONFIG.barDoubleClickBound);
+
+        switch (DOWN.result) {
+            case eBarDownResult::OUTSIDE:
+                if (DOWN.endedDrag)
+                    log(std::format("bar {} drag_end", w.id));
+                break;
+            case eBarDownResult::BUTTON: log(std::format("bar {} button {}", w.id, DOWN.button)); break;
+            case eBarDownResult::DOUBLE_CLICK: log(std::format("bar {} double_click", w.id)); break;
+            case eBarDownResult::DRAG_PENDING: log(std::format("bar {} drag_pending", w.id)); break;
+        }
+
+        if (DOWN.result != eBarDownResult::OUTSIDE)
+            focus(w.id);
+    }
+}
+
+void CMockSession::pointerButton(uint32_t button, bool pressed, double x, double y) {
+    snapshot();
+    const auto ROUTE = routePointerButton(m_routing, button, pressed, x, y, m_nowMs);
+
+    // Routing already checked what CHyprPill::canBeginDrag does: the click
+    // hitbox and that the pointer holds no other pill.
+    if (ROUTE.target) {
+        const auto ID = routedId(*ROUTE.target);
+        applyPillEffects(ID, pillPointerButton(m_pills[ID].input, ROUTE.action, x, y, m_nowMs, windowById(ID)->floating), x, y);
+    }
+
+    if (pressed)
+        barsDown(x, y, std::nullopt);
+    else {
+        for (auto& [id, bar] : m_bars) {
+            if (barPointerUp(bar, m_focused == id).endedDrag)
+                log(std::format("bar {} drag_end", id));
+        }
+    }
+
+    updateCursor(x, y);
+}
+
+void CMockSession::touchDown(int32_t touchId, double nx, double ny) {
+    snapshot();
+    if (const auto TARGET = routeTouchDown(m_routing, touchId, nx, ny)) {
+        const auto ID = routedId(*TARGET);
+        double     x = 0.0, y = 0.0;
+        touchToGlobal(m_routing.pills[*TARGET].monitor, nx, ny, x, y);
+        applyPillEffects(ID, pillTouchDown(m_pills[ID].input, touchId, x, y, windowById(ID)->floating), x, y);
+    }
+
+    if (!barAcceptsTouch(touchId))
+        return;
+
+    // Without a bound output hyprbars maps touches to the focused monitor.
+    const auto   FOCUSED = m_focused ? windowById(*m_focused) : nullptr;
+    const size_t MONITOR = FOCUSED ? FOCUSED->monitor : 0;
+    if (MONITOR >= m_monitors.size())
+        return;
+
+    double x = 0.0, y = 0.0;
+    touchToGlobal(m_monitors[MONITOR], nx, ny, x, y);
+    barsDown(x, y, touchId);
+}
+
+void CMockSession::touchUp(int32_t touchId) {
+    // Like main.cpp, touch up and motion go to the pill holding the point.
+    if (const auto IT = m_touchDrags.find(touchId); IT != m_touchDrags.end()) {
+        const auto ID = IT->second;
+        applyPillEffects(ID, pillTouchUp(m_pills[ID].input), 0.0, 0.0);
+    }
+
+    for (auto& [id, bar] : m_bars) {
+        if (barTouchUp(bar, touchId, m_focused == id).endedDrag)
+            log(std::format("bar {} drag_end", id));
+    }
+}
+
+void CMockSession::touchMotion(int32_t touchId, double nx, double ny) {
+    if (const auto IT = m_touchDrags.find(touchId); IT != m_touchDrags.end()) {
+        const auto ID    = IT->second;
+        const auto ROUTE = routeTouchMotion(pillTarget(ID), CONFIG.dragThresholdPx, nx, ny);
+        applyPillEffects(ID, pillTouchMotion(m_pills[ID].input, ROUTE.action), ROUTE.x, ROUTE.y);
+    }
+
+    for (auto& [id, bar] : m_bars) {
+        if (barTouchMotion(bar, touchId) == eBarTouchMotion::DRAG_START)
+            log(std::format("bar {} drag_start", id));
+    }
+}
+
+void CMockSession::replay(const STraceRecord& rec) {
+    m_timeUs = rec.timeUs;
+    m_nowMs  = rec.timeUs / 1000.0;
+
+    if (rec.type < (uint8_t)eTraceEvent::WINDOW)
+        dropClosedWindows();
+
+    switch ((eTraceEvent)rec.type) {
+        case eTraceEvent::MOTION: pointerMotion(rec.x, rec.y); break;
+        case eTraceEvent::BUTTON: pointerButton(rec.id, rec.state != 0, rec.x, rec.y); break;
+        case eTraceEvent::TOUCH_DOWN: touchDown((int32_t)rec.id, rec.x, rec.y); break;
+        case eTraceEvent::TOUCH_UP: touchUp((int32_t)rec.id); break;
+        case eTraceEvent::TOUCH_MOTION: touchMotion((int32_t)rec.id, rec.x, rec.y); break;
+        default: layoutRecord(rec); break;
+    }
+}
+
+uint64_t threadCpuNs() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+constexpr size_t                              EVENTTYPES = (size_t)eTraceEvent::MONITOR + 1;
+constexpr std::array<const char*, EVENTTYPES> EVENTNAMES = {"motion", "button", "touch_down", "touch_up", "touch_motion", "window", "layout", "monitor"};
+
+std::string report(const std::vector<STraceRecord>& records, bool json, double predictMs, CMockSession* sessionOut = nullptr) {
+    CMockSession                                  session(predictMs);
+    std::array<std::vector<uint64_t>, EVENTTYPES> eventNs;
+
+    for (const auto& rec : records) {
+        if (rec.type >= EVENTTYPES)
+            return std::format("unknown event type {}", rec.type);
+
+        const auto START = threadCpuNs();
+        session.replay(rec);
+        eventNs[rec.type].push_back(threadCpuNs() - START);
+    }
+
+    std::string result = json ? std::format(R"({{"events": {}, "stats": [)", records.size()) : std::format("events: {}\n", records.size());
+
+    bool        first = true;
+    for (size_t i = 0; i < EVENTTYPES; ++i) {
+        auto& ns = eventNs[i];
+        if (ns.empty())
+            continue;
+
+        std::ranges::sort(ns);
+        uint64_t total = 0;
+        for (const auto N : ns)
+            total += N;
+
+        const double MEANUS = total / 1000.0 / ns.size();
+        const double P99US  = ns[std::min(ns.size() - 1, ns.size() * 99 / 100)] / 1000.0;
+        const double MAXUS  = ns.back() / 1000.0;
+
+        if (json)
+            result += std::format(R"({}{{"event": "{}", "count": {}, "meanUs": {:.3f}, "p99Us": {:.3f}, "maxUs": {:.3f}}})", first ? "" : ",", EVENTNAMES[i], ns.size(), MEANUS,
+                                  P99US, MAXUS);
+        else
+            result += std::format("{}: {} events, mean {:.3f}us, p99 {:.3f}us, max {:.3f}us\n", EVENTNAMES[i], ns.size(), MEANUS, P99US, MAXUS);
+
+        first = false;
+    }
+
+    // Hover latency gained on hits, and the share of predictions the pointer
+    // never reached in time.
+    const auto&  PREDICTIONS = session.predictionStats;
+    const double LEADMS      = PREDICTIONS.hits ? PREDICTIONS.leadMs / PREDICTIONS.hits : 0.0;
+    const double FALSERATE   = PREDICTIONS.predictions ? (double)PREDICTIONS.lapses / PREDICTIONS.predictions : 0.0;
+    if (json && predictMs > 0.0)
+        result += std::format(R"(], "prediction": {{"horizonMs": {}, "predictions": {}, "hits": {}, "lapses": {}, "meanLeadMs": {:.2f}, "falsePositiveRate": {:.3f}}})", predictMs,
+                              PREDICTIONS.predictions, PREDICTIONS.hits, PREDICTIONS.lapses, LEADMS, FALSERATE);
+    else if (predictMs > 0.0)
+        result += std::format("hover prediction at {}ms: {} predicted, {} reached {:.1f}ms early on average, {} lapsed ({:.0f}% false positives)\n", predictMs,
+                              PREDICTIONS.predictions, PREDICTIONS.hits, LEADMS, PREDICTIONS.lapses, FALSERATE * 100.0);
+
+    const auto& TRANSITIONS = session.transitions;
+    if (json) {
+        result += predictMs > 0.0 ? R"(, "transitions": [)" : R"(], "transitions": [)";
+        for (size_t i = 0; i < TRANSITIONS.size(); ++i)
+            result += std::format(R"({}"{}")", i ? "," : "", TRANSITIONS[i]);
+        result += "]}";
+    } else {
+        result += std::format("transitions: {}\n", TRANSITIONS.size());
+        for (const auto& t : TRANSITIONS)
+            result += "  " + t + "\n";
+    }
+
+    if (sessionOut)
+        *sessionOut = std::move(session);
+
+    return result;
+}
+
+// Two tiled windows side by side on one 1920x1080 monitor, B focused. Times
+// are in ms.
+std::vector<STraceRecord> syntheticTrace() {
+    std::vector<STraceRecord> t;
+
+    const auto layout = [&](uint64_t ms, float ax) {
+        t.push_back({.timeUs = ms * 1000, .type = (uint8_t)eTraceEvent::LAYOUT});
+        t.push_back({.timeUs = ms * 1000, .type = (uint8_t)eTraceEvent::MONITOR, .w = 1920.F, .h = 1080.F});
+        t.push_back({.timeUs = ms * 1000, .id = 0, .type = (uint8_t)eTraceEvent::WINDOW, .x = ax, .y = 40.F, .w = 960.F, .h = 1040.F});
+        t.push_back({.timeUs = ms * 1000, .id = 1, .type = (uint8_t)eTraceEvent::WINDOW, .state = TRACE_WINDOW_FOCUSED, .x = 960.F, .y = 40.F, .w = 960.F, .h = 1040.F});
+    };
+    const auto motion = [&](uint64_t ms, float x, float y) { t.push_back({.timeUs = ms * 1000, .type = (uint8_t)eTraceEvent::MOTION, .x = x, .y = y}); };
+    const auto button = [&](uint64_t ms, uint32_t b, bool pressed, float x, float y) {
+        t.push_back({.timeUs = ms * 1000, .id = b, .type = (uint8_t)eTraceEvent::BUTTON, .state = pressed, .x = x, .y = y});
+    };
+    const auto touch = [&](uint64_t ms, eTraceEvent type, float x, float y) {
+        t.push_back({.timeUs = ms * 1000, .id = 3, .type = (uint8_t)type, .state = type == eTraceEvent::TOUCH_DOWN, .x = x / 1920.F, .y = y / 1080.F});
+    };
+
+    layout(0, 0.F);
+    motion(970, 480.F, 150.F); // heading up for A's pill, fast enough to predict
+    motion(980, 480.F, 120.F);
+    motion(990, 480.F, 90.F);
+    motion(1000, 480.F, 30.F);                 // onto A's pill
+    button(2000, BTN_LEFT, true, 480.F, 30.F); // press it
+    motion(3000, 520.F, 30.F);                 // and drag past the threshold
+    button(4000, BTN_LEFT, false, 520.F, 30.F);
+    layout(4500, 40.F); // where the compositor put A
+    motion(4700, 1440.F, 190.F); // heading for B's pill, then turning away
+    motion(4710, 1440.F, 145.F);
+    motion(4720, 1440.F, 100.F);
+    motion(4800, 1700.F, 300.F);
+    motion(5000, 1440.F, 30.F);                // onto B's pill
+    button(6000, BTN_MIDDLE, true, 1440.F, 30.F);
+    button(6100, BTN_MIDDLE, false, 1440.F, 30.F);
+    motion(6500, 520.F, 30.F); // back onto A's
+    button(7000, BTN_LEFT, true, 520.F, 30.F);
+    button(7050, BTN_LEFT, false, 520.F, 30.F);
+    button(7200, BTN_LEFT, true, 520.F, 30.F); // double click
+    button(7250, BTN_LEFT, false, 520.F, 30.F);
+    motion(7500, 1900.F, 30.F); // B's first bar button
+    button(8000, BTN_LEFT, true, 1900.F, 30.F);
+    button(8100, BTN_LEFT, false, 1900.F, 30.F);
+    touch(9000, eTraceEvent::TOUCH_DOWN, 520.F, 20.F); // a finger on A's pill
+    touch(9100, eTraceEvent::TOUCH_MOTION, 600.F, 20.F);
+    touch(9200, eTraceEvent::TOUCH_UP, 0.F, 0.F);
+
+    return t;
+}
+
+int selfTest() {
+    constexpr double SELFTESTPREDICTMS = 16.0;
+
+    CMockSession     session(SELFTESTPREDICTMS);
+    const auto       OUT         = report(syntheticTrace(), false, SELFTESTPREDICTMS, &session);
+    const auto&      transitions = session.transitions;
+
+    // Every action, in order: the transitions are the plugins' own, so this
+    // pins down what they do with the trace.
+    const std::vector<std::string_view> EXPECTED = {
+        "990000 pill 0 predict",
+        "1000000 hover none -> 0",
+        "1000000 pill 0 hover",
+        "1000000 focus 1 -> 0",
+        "1000000 pill 0 predict_hit 10.0ms",
+        "1000000 cursor default -> hover",
+        "2000000 pill 0 press",
+        "2000000 bar 0 drag_pending",
+        "2000000 cursor hover -> grab",
+        "3000000 pill 0 float",
+        "3000000 pill 0 move 40 40",
+        "3000000 bar 0 drag_start",
+        "4000000 pill 0 release",
+        "4000000 pill 0 retile",
+        "4000000 bar 0 drag_end",
+        "4000000 cursor grab -> hover",
+        "4700000 pill 0 unhover",
+        "4700000 hover 0 -> none",
+        "4700000 cursor hover -> default",
+        "4720000 pill 1 predict",
+        "4800000 pill 1 predict_lapse",
+        "5000000 hover none -> 1",
+        "5000000 pill 1 hover",
+        "5000000 cursor default -> hover",
+        "6000000 pill 1 close",
+        "6000000 bar 1 drag_pending",
+        "6500000 pill 1 unhover",
+        "6500000 hover 1 -> 0",
+        "6500000 pill 0 hover",
+        "6500000 focus 1 -> 0",
+        "7000000 pill 0 press",
+        "7000000 bar 0 drag_pending",
+        "7000000 cursor hover -> grab",
+        "7050000 pill 0 release",
+        "7050000 cursor grab -> hover",
+        "7200000 pill 0 toggle_floating",
+        "7200000 bar 0 double_click",
+        "7500000 pill 0 unhover",
+        "7500000 hover 0 -> none",
+        "7500000 cursor hover -> default",
+        "8000000 bar 1 button 0",
+        "8000000 focus 0 -> 1",
+        "9000000 focus 1 -> 0",
+        "9000000 pill 0 touch_press 3",
+        "9000000 pill 0 raise",
+        "9100000 pill 0 move 120 40",
+        "9200000 pill 0 release",
+    };
+
+    const auto& PREDICTIONS = session.predictionStats;
+    if (PREDICTIONS.predictions != 2 || PREDICTIONS.hits != 1 || PREDICTIONS.lapses != 1 || std::fabs(PREDICTIONS.leadMs - 10.0) > 0.001) {
+        std::printf("FAIL: prediction stats\n%s", OUT.c_str());
+        return 1;
+    }
+
+    const auto MISMATCH = std::ranges::mismatch(transitions, EXPECTED);
+    if (MISMATCH.in1 == transitions.end() && MISMATCH.in2 == EXPECTED.end()) {
+        std::printf("replayed the synthetic trace\n");
+        return 0;
+    }
+
+    const auto INDEX = MISMATCH.in1 - transitions.begin();
+    std::printf("FAIL: transition %td is \"%s\", expected \"%s\"\n%s", INDEX, MISMATCH.in1 != transitions.end() ? MISMATCH.in1->c_str() : "(end)",
+                MISMATCH.in2 != EXPECTED.end() ? std::string{*MISMATCH.in2}.c_str() : "(end)", OUT.c_str());
+    return 1;
+}
+}
+
+int main(int argc, char** argv) {
+    std::string_view ARG = argc > 1 ? argv[1] : "";
+    if (ARG == "--self-test")
+        return selfTest();
+
+    bool   json      = false;
+    double predictMs = 0.0;
+    for (int i = 2; i < argc; ++i) {
+        const std::string_view OPT = argv[i];
+        if (OPT == "-j")
+            json = true;
+        else if (OPT == "--predict" && i + 1 < argc)
+            predictMs = std::clamp(std::strtod(argv[++i], nullptr), 0.0, 50.0);
+        else
+            ARG = {};
+    }
+
+    if (ARG.empty()) {
+        std::fprintf(stderr, "usage: hyprpill-replay <trace> [-j] [--predict <ms>] | --self-test\n");
+        return 2;
+    }
+
+    std::vector<STraceRecord> records;
+    if (const auto ERR = CInputTrace::load(argv[1], records); !ERR.empty()) {
+        std::fprintf(stderr, "%s\n", ERR.c_str());
+        return 1;
+    }
+
+    std::printf("%s%s", report(records, json, predictMs).c_str(), json ? "\n" : "");
+    return 0;
+}
@@ -0,0 +1,173 @@
+// Times the CPU-side pill hot paths on synthetic layouts of 1, 10, 100 and
+// 1000 windows, calling the same functions the plugin does.
+//
+// usage: hyprpill-bench [-j]
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <format>
+#include <functional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../PillInput.hpp"
+#include "../PillLayout.hpp"
+#include "../PillMotion.hpp"
+
+namespace {
+constexpr std::array<size_t, 4> WINDOWCOUNTS = {1, 10, 100, 1000};
+constexpr float                 LAYOUTW      = 3840.F;
+constexpr float                 LAYOUTH      = 2160.F;
+constexpr auto                  MINDURATION  = std::chrono::milliseconds(50);
+
+// The config defaults.
+constexpr SPillStyle STYLE = {.width           = 100.F,
+                              .height          = 12.F,
+                              .radius          = 12.F,
+                              .widthInactive   = 26.F,
+                              .heightInactive  = 4.F,
+                              .radiusInactive  = 2.F,
+                              .widthHover      = 150.F,
+                              .heightHover     = 12.F,
+                              .opacityActive   = 1.F,
+                              .opacityInactive = 0.2F,
+                              .offsetYActive   = 20.F,
+                              .offsetYInactive = 8.F,
+                              .colorActive     = 0x77FFFFFF,
+                              .colorInactive   = 0xFF777777,
+                              .colorHover      = 0xAAFFFFFF,
+                              .colorPressed    = 0xFFFFFFFF};
+
+// Keeps the measured work from being optimized away.
+volatile float g_sink = 0.F;
+
+struct SBenchResult {
+    std::string name;
+    size_t      windows    = 0;
+    size_t      iterations = 0;
+    double      nsPerOp    = 0.0;
+};
+
+// Runs fn in doubling batches until MINDURATION has passed.
+SBenchResult measure(const std::string& name, size_t windows, const std::function<float()>& fn) {
+    size_t     iterations = 0;
+    size_t     batch      = 1;
+    const auto START      = std::chrono::steady_clock::now();
+    auto       elapsed    = std::chrono::steady_clock::duration{};
+
+    while (elapsed < MINDURATION) {
+        float acc = 0.F;
+        for (size_t i = 0; i < batch; ++i)
+            acc += fn();
+        g_sink = g_sink + acc;
+
+        iterations += batch;
+        batch *= 2;
+        elapsed = std::chrono::steady_clock::now() - START;
+    }
+
+    return {name, windows, iterations, std::chrono::duration<double, std::nano>(elapsed).count() / iterations};
+}
+
+struct SWindow {
+    float x = 0.F;
+    float y = 0.F;
+    float w = 0.F;
+    float h = 0.F;
+};
+
+std::vector<SWindow> syntheticWindows(size_t count, std::mt19937& rng) {
+    std::uniform_real_distribution<float> x(0.F, LAYOUTW - 200.F), y(0.F, LAYOUTH - 200.F), size(200.F, 1400.F);
+
+    std::vector<SWindow> windows;
+    windows.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+        windows.push_back({x(rng), y(rng), size(rng), size(rng)});
+    return windows;
+}
+
+// What main.cpp samples for the default anim_easing, easeOutExpo.
+CPillCurveTable sampledCurves() {
+    const auto EASING = std::ranges::find(PILL_BEZIERS, std::string_view{"easeOutExpo"}, &SPillBezier::name);
+
+    CPillCurveTable curves = {};
+    for (size_t row = 0; row < PILL_CURVES; ++row) {
+        for (size_t i = 0; i < PILL_CURVE_SAMPLES; ++i)
+            curves[row * PILL_CURVE_SAMPLES + i] = evaluatePillBezier(*EASING, (float)i / (PILL_CURVE_SAMPLES - 1));
+    }
+    return curves;
+}
+}
+
+int main(int argc, char** argv) {
+    const bool JSON = argc > 1 && std::string_view{argv[1]} == "-j";
+
+    std::vector<SBenchResult> results;
+    std::mt19937              rng(42);
+    const auto                CURVES = sampledCurves();
+
+    for (const auto COUNT : WINDOWCOUNTS) {
+        const auto                WINDOWS = syntheticWindows(COUNT, rng);
+        const SHorizontalInterval owner{0.F, LAYOUTW};
+
+        std::vector<SHorizontalInterval> occluders;
+        occluders.reserve(COUNT);
+        for (const auto& w : WINDOWS)
+            occluders.push_back({w.x, w.x + std::min(w.w, 300.F)});
+
+        results.push_back(measure("subtract_intervals", COUNT, [&] { return (float)subtractForbiddenIntervals(owner, occluders).size(); }));
+
+        results.push_back(measure("placement_solve", COUNT, [&] {
+            const auto PLACEMENT = solvePillPlacement(owner, LAYOUTW / 2.F, STYLE.widthHover, 40.F, occluders);
+            return PLACEMENT.center + PLACEMENT.width;
+        }));
+
+        // One frame of updateStateAndAnimate() for every pill: the target
+        // state, what it animates to, and where the curve is.
+        results.push_back(measure("state_update", COUNT, [&] {
+            float acc = 0.F;
+            for (size_t i = 0; i < COUNT; ++i) {
+                const bool FOCUSED = i == 0;
+                const auto STATE   = pillVisualState(FOCUSED, i % 7 == 0, i % 31 == 0);
+                const auto TARGETS = pillStateTargets(STYLE, STATE, FOCUSED);
+                const auto T       = evaluatePillCurve(CURVES, STATE == ePillVisualState::PRESSED ? 1 : 0, (float)(i % 100) / 100.F);
+                acc += STYLE.radiusInactive + (TARGETS.radius - STYLE.radiusInactive) * T;
+            }
+            return acc;
+        }));
+
+        // The hover and click hitboxes routing keeps for every pill.
+        SPillRouting routing;
+        routing.pills.reserve(COUNT);
+        for (const auto& w : WINDOWS) {
+            SPillTarget pill;
+            pill.hover         = {w.x + w.w / 2.0 - 95.0, w.y - 30.0, 190.0, 32.0};
+            pill.click         = {w.x + w.w / 2.0 - 105.0, w.y - 36.0, 210.0, 44.0};
+            pill.acceptsInput  = true;
+            pill.acceptsCursor = true;
+            routing.pills.push_back(pill);
+        }
+
+        std::uniform_real_distribution<float> px(0.F, LAYOUTW), py(0.F, LAYOUTH);
+        results.push_back(measure("pill_at", COUNT, [&] {
+            const auto HIT = pillAt(routing, px(rng), py(rng), false);
+            return HIT ? (float)*HIT : -1.F;
+        }));
+    }
+
+    std::string out = JSON ? "[" : "";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& R = results[i];
+        if (JSON)
+            out += std::format(R"({}{{"name": "{}", "windows": {}, "iterations": {}, "nsPerOp": {:.2f}}})", i ? "," : "", R.name, R.windows, R.iterations, R.nsPerOp);
+        else
+            out += std::format("{:<20} {:>5} windows {:>12.2f} ns/op ({} iterations)\n", R.name, R.windows, R.nsPerOp, R.iterations);
+    }
+
+    std::fputs((JSON ? out + "]\n" : out).c_str(), stdout);
+    return 0;
+}
@@ -0,0 +1,146 @@
+// Checks that pill geometry settles in the same wall-clock time at 60, 144
+// and 240 Hz. Each simulated frame reads its progress from its own timestamp,
+// like the animation manager does when it ticks, so the only allowed
+// difference is the wait for the first frame after the curve ends. Frames
+// are spaced evenly, then with jitter and dropped frames.
+
+#include <cmath>
+#include <cstdio>
+#include <initializer_list>
+#include <random>
+#include <vector>
+
+#include "../PillMotion.hpp"
+
+namespace {
+constexpr float  DISTANCEPX = 400.F; // a long dodge
+constexpr float  SETTLEDPX  = 0.5F;  // what rounds to the target pixel
+constexpr double STARTMS    = 3.7;   // transitions start between frames
+constexpr double EPSILONMS  = 0.01;
+
+// How far the `exponential` bezier may stray from true decay: 0.1%.
+constexpr float EXPONENTIAL_FIT_TOLERANCE = 0.001F;
+
+int             g_failures = 0;
+
+void expect(bool ok, const char* what, const char* curve, double hz, double got, double want) {
+    if (ok)
+        return;
+
+    std::printf("FAIL %s: %s at %.0f Hz: %.3f, want %.3f\n", what, curve, hz, got, want);
+    g_failures++;
+}
+
+float remainingPx(const SPillBezier& bezier, double elapsedMs, float durationMs) {
+    return DISTANCEPX * (1.F - evaluatePillBezier(bezier, (float)(elapsedMs / durationMs)));
+}
+
+// Frame timestamps covering untilMs. jitter moves each frame by up to that
+// fraction of the frame interval, and dropEvery skips every n-th frame.
+std::vector<double> frameTimes(double hz, double jitter, int dropEvery, double untilMs, std::mt19937& rng) {
+    const double                           FRAMEMS = 1000.0 / hz;
+    std::uniform_real_distribution<double> offset(-jitter * FRAMEMS, jitter * FRAMEMS);
+
+    std::vector<double> times;
+    for (int frame = 0; times.empty() || times.back() < untilMs; ++frame) {
+        if (dropEvery > 0 && frame % dropEvery == dropEvery - 1)
+            continue;
+        times.push_back(frame * FRAMEMS + (jitter > 0.0 ? offset(rng) : 0.0));
+    }
+    return times;
+}
+
+struct SSettle {
+    double elapsedMs = -1.0; // of the first settled frame
+    double gapMs     = 0.0;  // between it and the frame before
+    bool   monotonic = true; // the remaining distance never grew
+};
+
+// Feeds the curve each frame's timestamp until a frame shows it settled.
+SSettle settle(const SPillBezier& bezier, float durationMs, const std::vector<double>& times) {
+    SSettle result;
+    float   lastRemaining = DISTANCEPX;
+    double  lastTime      = STARTMS;
+
+    for (const double TIME : times) {
+        if (TIME < STARTMS)
+            continue;
+
+        const float REMAINING = remainingPx(bezier, TIME - STARTMS, durationMs);
+        result.monotonic      = result.monotonic && REMAINING <= lastRemaining;
+        if (REMAINING < SETTLEDPX) {
+            result.elapsedMs = TIME - STARTMS;
+            result.gapMs     = TIME - lastTime;
+            return result;
+        }
+
+        lastRemaining = REMAINING;
+        lastTime      = TIME;
+    }
+
+    return result;
+}
+
+// The same in continuous time. Every built-in curve is monotonic, so the
+// settle time can be bisected for.
+double exactSettleMs(const SPillBezier& bezier, float durationMs) {
+    double lo = 0.0, hi = durationMs;
+    while (hi - lo > 0.001) {
+        const double MID = (lo + hi) / 2.0;
+        if (remainingPx(bezier, MID, durationMs) < SETTLEDPX)
+            hi = MID;
+        else
+            lo = MID;
+    }
+    return hi;
+}
+
+struct SFrameClock {
+    const char* name;
+    double      jitter    = 0.0;
+    int         dropEvery = 0;
+};
+}
+
+int main() {
+    constexpr SFrameClock CLOCKS[] = {{"even"}, {"jittered", 0.4}, {"jittered with drops", 0.4, 7}};
+
+    std::mt19937 rng(31);
+    for (const auto& BEZIER : PILL_BEZIERS) {
+        const bool EXPONENTIAL = BEZIER.name == "exponential";
+        for (const float SPEED : {2.F, 10.F, 150.F}) {
+            const float  DURATION = geometryTransitionMs(SPEED, EXPONENTIAL);
+            const double EXACT    = exactSettleMs(BEZIER, DURATION);
+
+            for (const auto& CLOCK : CLOCKS) {
+                for (const double HZ : {60.0, 144.0, 240.0}) {
+                    // A few seeds per clock, so the jitter lands differently.
+                    for (int run = 0; run < (CLOCK.jitter > 0.0 ? 8 : 1); ++run) {
+                        const auto TIMES  = frameTimes(HZ, CLOCK.jitter, CLOCK.dropEvery, STARTMS + DURATION + 100.0, rng);
+                        const auto SETTLE = settle(BEZIER, DURATION, TIMES);
+
+                        // Settled on the first frame at or after the exact settle time.
+                        expect(SETTLE.elapsedMs >= EXACT - EPSILONMS && SETTLE.elapsedMs - SETTLE.gapMs < EXACT + EPSILONMS, CLOCK.name, BEZIER.name.data(), HZ,
+                               SETTLE.elapsedMs, EXACT);
+                        expect(SETTLE.monotonic, "motion reversed", BEZIER.name.data(), HZ, 0.0, 0.0);
+                    }
+                }
+            }
+        }
+    }
+
+    // The bezier stands in for real exponential decay; keep it honest.
+    const auto& EXPCURVE = PILL_BEZIERS.back();
+    float       maxError = 0.F;
+    for (int i = 0; i <= 1000; ++i) {
+        const float T = i / 1000.F;
+        maxError      = std::fmax(maxError, std::fabs(evaluatePillBezier(EXPCURVE, T) - exponentialEase(T)));
+    }
+    expect(maxError < EXPONENTIAL_FIT_TOLERANCE, "exponential fit error", "exponential", 0.0, maxError, EXPONENTIAL_FIT_TOLERANCE);
+
+    if (g_failures)
+        return 1;
+
+    std::printf("settle times match at 60, 144 and 240 Hz, with and without frame jitter\n");
+    return 0;
+}
@@ -27,7 +27,7 @@ bool CDockPassElement::needsPrecomputeBlur() {
 }
 
 bool CDockPassElement::undiscardable() {
-    return true;
+    return false;
 }
 
 std::optional<CBox> CDockPassElement::boundingBox() {
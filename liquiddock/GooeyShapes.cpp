@@ -0,0 +1,45 @@
+#include "GooeyShapes.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace {
+struct SSpan {
+    int first = INT_MAX;
+    int last  = -1;
+
+    int start() const {
+        return last < 0 ? 0 : first;
+    }
+    int count() const {
+        return last < 0 ? 0 : last - first + 1;
+    }
+};
+
+void markSpans(std::vector<SSpan>& spans, float tileWidth, int index, float centerX, float reach) {
+    const int lastTile = (int)spans.size() - 1;
+    const int from     = std::clamp((int)std::floor((centerX - reach) / tileWidth), 0, lastTile);
+    const int to       = std::clamp((int)std::floor((centerX + reach) / tileWidth), 0, lastTile);
+    for (int t = from; t <= to; ++t) {
+        spans[t].first = std::min(spans[t].first, index);
+        spans[t].last  = std::max(spans[t].last, index);
+    }
+}
+}
+
+void binShapesIntoTiles(SGooeyShapes& shapes, float renderWidth, float threshold, size_t maxTiles) {
+    const size_t numTiles = std::clamp<size_t>((size_t)std::ceil(renderWidth / GOOEY_TILE_WIDTH), 1, std::max<size_t>(1, maxTiles));
+    shapes.tileWidth      = renderWidth > 0.F ? renderWidth / numTiles : GOOEY_TILE_WIDTH;
+
+    std::vector<SSpan> iconSpans(numTiles), dotSpans(numTiles);
+
+    for (size_t i = 0; i < shapes.icons.size(); ++i)
+        markSpans(iconSpans, shapes.tileWidth, i, shapes.icons[i][0], shapes.icons[i][2] * 0.5F + threshold + 1.F);
+    for (size_t i = 0; i < shapes.dots.size(); ++i)
+        markSpans(dotSpans, shapes.tileWidth, i, shapes.dots[i][0], shapes.dots[i][2] + 1.F);
+
+    shapes.tiles.resize(numTiles);
+    for (size_t t = 0; t < numTiles; ++t)
+        shapes.tiles[t] = {iconSpans[t].start(), iconSpans[t].count(), dotSpans[t].start(), dotSpans[t].count()};
+}
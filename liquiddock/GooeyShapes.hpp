@@ -0,0 +1,35 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Width of one SDF culling tile in logical px
+inline constexpr float GOOEY_TILE_WIDTH = 32.F;
+
+// Array sizes of the uniform block the gooey shader falls back to when the
+// driver can't bind three storage buffers to a fragment shader
+inline constexpr size_t GOOEY_BOUNDED_SHAPES = 32;
+inline constexpr size_t GOOEY_BOUNDED_TILES  = 64;
+
+// CPU mirror of the gooey shader's storage buffers. Every array grows with
+// the dock; only the uniform block fallback caps the number of icons.
+struct SGooeyShapes {
+    std::vector<std::array<float, 4>>   icons; // center x/y, size, rounding
+    std::vector<std::array<float, 4>>   dots;  // center x/y, radius, unused
+    std::vector<std::array<int32_t, 4>> tiles; // first icon, icon count, first dot, dot count
+    float                               tileWidth = GOOEY_TILE_WIDTH;
+
+    bool                                operator==(const SGooeyShapes&) const = default;
+};
+
+// Splits [0, renderWidth) into GOOEY_TILE_WIDTH tiles and gives each the
+// icons and dots that can reach it. An icon reaches half its size plus the
+// smooth-min threshold (beyond that it can't pull the union in) plus a pixel
+// of antialiasing. Tiles store index ranges; icons are laid out left to
+// right, so a range rarely includes a shape that doesn't reach the tile and
+// the per-pixel cost stays flat however long the dock gets. Tiles widen to
+// keep their count within maxTiles.
+void binShapesIntoTiles(SGooeyShapes& shapes, float renderWidth, float threshold, size_t maxTiles = std::numeric_limits<size_t>::max());
@@ -0,0 +1,163 @@
+#include "IconAtlas.hpp"
+
+#include <algorithm>
+#include <bit>
+
+#include "globals.hpp"
+
+namespace {
+constexpr int ATLASCOLUMNS  = 8;
+constexpr int ATLASMAXLEVEL = 2; // icons are never drawn below a quarter of their decoded size
+constexpr int ATLASBORDER   = 1 << ATLASMAXLEVEL; // one transparent texel around each cell at the last level
+
+void countGlObjects(uint64_t created, uint64_t deleted) {
+    // The atlas may outlive the global state during plugin teardown
+    if (!g_pGlobalState)
+        return;
+    g_pGlobalState->glStats.objectsCreated += created;
+    g_pGlobalState->glStats.objectsDeleted += deleted;
+}
+}
+
+CIconAtlas::~CIconAtlas() {
+    release();
+}
+
+void CIconAtlas::setPixelSize(int pixelSize) {
+    if (pixelSize == m_pixelSize)
+        return;
+
+    release();
+    m_pixelSize = pixelSize;
+
+    // Cells start on multiples of the last level's texel, so no level mixes two cells
+    const int ALIGN = 1 << ATLASMAXLEVEL;
+    m_cellSize      = (pixelSize + 2 * ATLASBORDER + ALIGN - 1) / ALIGN * ALIGN;
+}
+
+int CIconAtlas::pixelSize() const {
+    return m_pixelSize;
+}
+
+bool CIconAtlas::grow(size_t cells) {
+    const int ROWS = std::bit_ceil((cells + ATLASCOLUMNS - 1) / ATLASCOLUMNS);
+    if (ROWS <= m_rows)
+        return true;
+
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+
+    const int WIDTH  = ATLASCOLUMNS * m_cellSize;
+    const int HEIGHT = ROWS * m_cellSize;
+    if (WIDTH > maxSize || HEIGHT > maxSize)
+        return false;
+
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexStorage2D(GL_TEXTURE_2D, ATLASMAXLEVEL + 1, GL_RGBA8, WIDTH, HEIGHT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, ATLASMAXLEVEL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // Borders are never written again, so they have to start out transparent
+    const std::vector<uint8_t> zeros((size_t)WIDTH * HEIGHT * 4, 0);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, zeros.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // Keep the icons already in place; only rows are added, so cells stay where they were
+    if (m_texture) {
+        glCopyImageSubData(m_texture, GL_TEXTURE_2D, 0, 0, 0, 0, texture, GL_TEXTURE_2D, 0, 0, 0, 0, WIDTH, m_rows * m_cellSize, 1);
+        glDeleteTextures(1, &m_texture);
+        countGlObjects(0, 1);
+    }
+
+    m_texture   = texture;
+    m_rows      = ROWS;
+    m_mipsDirty = true;
+    countGlObjects(1, 0);
+    return true;
+}
+
+bool CIconAtlas::store(const std::string& appId, const uint8_t* pixels, int stride) {
+    if (m_pixelSize <= 0)
+        return false;
+
+    size_t cell = 0;
+    if (const auto IT = m_cells.find(appId); IT != m_cells.end())
+        cell = IT->second;
+    else if (!m_freeCells.empty()) {
+        cell = m_freeCells.back();
+        m_freeCells.pop_back();
+        m_cells[appId] = cell;
+    } else {
+        if (!grow(m_usedCells + 1))
+            return false;
+        cell           = m_usedCells++;
+        m_cells[appId] = cell;
+    }
+
+    const int X = (cell % ATLASCOLUMNS) * m_cellSize + ATLASBORDER;
+    const int Y = (cell / ATLASCOLUMNS) * m_cellSize + ATLASBORDER;
+
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, stride / 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, X, Y, m_pixelSize, m_pixelSize, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    m_mipsDirty = true;
+    return true;
+}
+
+void CIconAtlas::retain(const std::vector<std::string>& appIds) {
+    std::erase_if(m_cells, [&](const auto& entry) {
+        if (std::ranges::find(appIds, entry.first) != appIds.end())
+            return false;
+        m_freeCells.push_back(entry.second);
+        return true;
+    });
+}
+
+void CIconAtlas::finishUploads() {
+    if (!m_mipsDirty || !m_texture)
+        return;
+
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    m_mipsDirty = false;
+}
+
+std::optional<std::array<float, 4>> CIconAtlas::uvRect(const std::string& appId) const {
+    const auto IT = m_cells.find(appId);
+    if (IT == m_cells.end() || !m_texture)
+        return std::nullopt;
+
+    const float WIDTH  = ATLASCOLUMNS * m_cellSize;
+    const float HEIGHT = m_rows * m_cellSize;
+    const float X      = (IT->second % ATLASCOLUMNS) * m_cellSize + ATLASBORDER;
+    const float Y      = (IT->second / ATLASCOLUMNS) * m_cellSize + ATLASBORDER;
+
+    return std::array<float, 4>{X / WIDTH, Y / HEIGHT, (X + m_pixelSize) / WIDTH, (Y + m_pixelSize) / HEIGHT};
+}
+
+GLuint CIconAtlas::texture() const {
+    return m_texture;
+}
+
+void CIconAtlas::release() {
+    if (m_texture) {
+        glDeleteTextures(1, &m_texture);
+        m_texture = 0;
+        countGlObjects(0, 1);
+    }
+
+    m_rows      = 0;
+    m_usedCells = 0;
+    m_mipsDirty = false;
+    m_cells.clear();
+    m_freeCells.clear();
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#define WLR_USE_UNSTABLE
+
+#include <hyprland/src/render/OpenGL.hpp>
+#include <array>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Every dock icon in one mipmapped texture, so the icon pass is a single
+// instanced draw. The atlas is a grid of equal cells, one per app id, each
+// holding a pixelSize icon inside a transparent border that keeps mip levels
+// from bleeding between neighbours. Cells are handed out as icons arrive and
+// recycled when their items leave the dock; the texture itself is only
+// reallocated when it runs out of cells or the icon pixel size changes.
+class CIconAtlas {
+  public:
+    CIconAtlas() = default;
+    ~CIconAtlas();
+
+    CIconAtlas(const CIconAtlas&)            = delete;
+    CIconAtlas& operator=(const CIconAtlas&) = delete;
+
+    // Drops every icon when pixelSize differs from the current one.
+    void                 setPixelSize(int pixelSize);
+    int                  pixelSize() const;
+
+    // Writes appId's icon (cairo ARGB32, pixelSize rows of stride bytes)
+    // into its cell, taking a free one first if needed. False if the atlas
+    // can't grow any further.
+    bool                 store(const std::string& appId, const uint8_t* pixels, int stride);
+
+    // Frees the cells of every app id not in appIds.
+    void                 retain(const std::vector<std::string>& appIds);
+
+    // Rebuilds the mip chain if anything was stored since the last call.
+    void                 finishUploads();
+
+    // Normalized u0, v0, u1, v1 of appId's icon, or nullopt without one.
+    std::optional<std::array<float, 4>> uvRect(const std::string& appId) const;
+
+    GLuint               texture() const;
+    void                 release();
+
+  private:
+    bool                 grow(size_t cells);
+
+    GLuint               m_texture   = 0;
+    int                  m_pixelSize = 0;
+    int                  m_cellSize  = 0;
+    int                  m_rows      = 0;
+    bool                 m_mipsDirty = false;
+
+    std::unordered_map<std::string, size_t> m_cells;
+    std::vector<size_t>                     m_freeCells;
+    size_t                                  m_usedCells = 0; // cells ever handed out, free or not
+};
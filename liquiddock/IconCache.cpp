@@ -0,0 +1,205 @@
+#include "IconCache.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+constexpr char     CACHEMAGIC[4] = {'L', 'D', 'I', 'C'};
+constexpr uint32_t CACHEVERSION  = 1;
+constexpr size_t   PIXELALIGN    = 64;
+
+// Header, then count entries, then the string table, then pixel rows.
+struct SCacheHeader {
+    char     magic[4];
+    uint32_t version       = CACHEVERSION;
+    uint32_t count         = 0;
+    uint32_t reserved      = 0;
+    uint64_t stringsOffset = 0;
+    uint64_t stringsSize   = 0;
+};
+static_assert(sizeof(SCacheHeader) == 32);
+
+struct SCacheEntry {
+    uint32_t appIdOffset = 0; // all string offsets are into the string table
+    uint32_t appIdLength = 0;
+    uint32_t themeOffset = 0;
+    uint32_t themeLength = 0;
+    uint32_t pathOffset  = 0;
+    uint32_t pathLength  = 0;
+    int32_t  pixelSize   = 0;
+    uint32_t stride      = 0;
+    uint64_t pixelOffset = 0; // from the start of the file
+    int64_t  themeStamp  = 0;
+    int64_t  iconMtime   = 0;
+};
+static_assert(sizeof(SCacheEntry) == 56);
+
+std::string cachePath() {
+    return iconCacheDir() + "/icons.bin";
+}
+
+std::string indexKey(const std::string& appId, const std::string& theme, int pixelSize) {
+    return std::format("{}\t{}\t{}", appId, theme, pixelSize);
+}
+}
+
+CIconCache::CIconCache() {
+    const int FD = open(cachePath().c_str(), O_RDONLY | O_CLOEXEC);
+    if (FD < 0)
+        return;
+
+    struct stat st{};
+    if (fstat(FD, &st) == 0 && (size_t)st.st_size >= sizeof(SCacheHeader)) {
+        m_mapSize = st.st_size;
+        m_map     = mmap(nullptr, m_mapSize, PROT_READ, MAP_PRIVATE, FD, 0);
+        if (m_map == MAP_FAILED)
+            m_map = nullptr;
+    }
+    close(FD);
+
+    if (!m_map)
+        return;
+
+    const auto*   BASE   = static_cast<const uint8_t*>(m_map);
+    const auto*   HEADER = reinterpret_cast<const SCacheHeader*>(BASE);
+    const uint64_t SIZE  = m_mapSize;
+
+    const bool HEADEROK = std::memcmp(HEADER->magic, CACHEMAGIC, sizeof(CACHEMAGIC)) == 0 && HEADER->version == CACHEVERSION &&
+        sizeof(SCacheHeader) + (uint64_t)HEADER->count * sizeof(SCacheEntry) <= HEADER->stringsOffset && HEADER->stringsOffset <= SIZE &&
+        HEADER->stringsSize <= SIZE - HEADER->stringsOffset;
+    if (!HEADEROK)
+        return;
+
+    const auto* ENTRIES = reinterpret_cast<const SCacheEntry*>(BASE + sizeof(SCacheHeader));
+    const auto* STRINGS = reinterpret_cast<const char*>(BASE + HEADER->stringsOffset);
+
+    const auto stringAt = [&](uint32_t offset, uint32_t length, std::string& out) {
+        if ((uint64_t)offset + length > HEADER->stringsSize)
+            return false;
+        out.assign(STRINGS + offset, length);
+        return true;
+    };
+
+    m_records.reserve(HEADER->count);
+    for (uint32_t i = 0; i < HEADER->count; ++i) {
+        const auto&      E = ENTRIES[i];
+        SIconCacheRecord rec;
+
+        const bool STRINGSOK = stringAt(E.appIdOffset, E.appIdLength, rec.appId) && stringAt(E.themeOffset, E.themeLength, rec.theme) && stringAt(E.pathOffset, E.pathLength, rec.path);
+        const bool PIXELSOK  = E.pixelSize > 0 && E.stride >= (uint64_t)E.pixelSize * 4 && E.pixelOffset <= SIZE && (uint64_t)E.stride * E.pixelSize <= SIZE - E.pixelOffset;
+        if (!STRINGSOK || !PIXELSOK) {
+            // A damaged entry means a damaged file; trust none of it
+            m_records.clear();
+            m_index.clear();
+            return;
+        }
+
+        rec.pixelSize  = E.pixelSize;
+        rec.stride     = E.stride;
+        rec.themeStamp = E.themeStamp;
+        rec.iconMtime  = E.iconMtime;
+        rec.pixels     = BASE + E.pixelOffset;
+
+        m_index[indexKey(rec.appId, rec.theme, rec.pixelSize)] = m_records.size();
+        m_records.push_back(std::move(rec));
+    }
+}
+
+CIconCache::~CIconCache() {
+    if (m_map)
+        munmap(m_map, m_mapSize);
+}
+
+const SIconCacheRecord* CIconCache::find(const std::string& appId, const std::string& theme, int pixelSize) const {
+    const auto IT = m_index.find(indexKey(appId, theme, pixelSize));
+    return IT == m_index.end() ? nullptr : &m_records[IT->second];
+}
+
+const std::vector<SIconCacheRecord>& CIconCache::records() const {
+    return m_records;
+}
+
+bool CIconCache::write(const std::vector<SIconCacheRecord>& records) {
+    SCacheHeader header;
+    std::memcpy(header.magic, CACHEMAGIC, sizeof(CACHEMAGIC));
+    header.count = records.size();
+
+    std::vector<SCacheEntry> entries(records.size());
+    std::string              strings;
+
+    const auto addString = [&](const std::string& str, uint32_t& offset, uint32_t& length) {
+        offset = strings.size();
+        length = str.size();
+        strings += str;
+    };
+
+    for (size_t i = 0; i < records.size(); ++i) {
+        addString(records[i].appId, entries[i].appIdOffset, entries[i].appIdLength);
+        addString(records[i].theme, entries[i].themeOffset, entries[i].themeLength);
+        addString(records[i].path, entries[i].pathOffset, entries[i].pathLength);
+    }
+
+    header.stringsOffset = sizeof(SCacheHeader) + entries.size() * sizeof(SCacheEntry);
+    header.stringsSize   = strings.size();
+
+    // Pixel rows start aligned, so uploads read them straight from the mapping
+    uint64_t offset = header.stringsOffset + header.stringsSize;
+    for (size_t i = 0; i < records.size(); ++i) {
+        offset                 = (offset + PIXELALIGN - 1) / PIXELALIGN * PIXELALIGN;
+        entries[i].pixelSize   = records[i].pixelSize;
+        entries[i].stride      = records[i].stride;
+        entries[i].pixelOffset = offset;
+        entries[i].themeStamp  = records[i].themeStamp;
+        entries[i].iconMtime   = records[i].iconMtime;
+        offset += (uint64_t)records[i].stride * records[i].pixelSize;
+    }
+
+    std::error_code ec;
+    fs::create_directories(iconCacheDir(), ec);
+
+    // Written aside and renamed: readers never see a torn file, and mappings
+    // of the old one keep their inode
+    const auto    PATH = cachePath();
+    std::ofstream file(PATH + ".tmp", std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(SCacheEntry));
+    file.write(strings.data(), strings.size());
+
+    for (size_t i = 0; i < records.size(); ++i) {
+        const auto PADDING = entries[i].pixelOffset - (uint64_t)file.tellp();
+        for (uint64_t p = 0; p < PADDING; ++p)
+            file.put('\0');
+        file.write(reinterpret_cast<const char*>(records[i].pixels), (size_t)records[i].stride * records[i].pixelSize);
+    }
+
+    file.close();
+    if (!file.good())
+        return false;
+
+    fs::rename(PATH + ".tmp", PATH, ec);
+    return !ec;
+}
+
+std::string iconCacheDir() {
+    if (const char* cache = getenv("XDG_CACHE_HOME"); cache && *cache)
+        return std::string(cache) + "/liquiddock";
+
+    const char* home = getenv("HOME");
+    return std::string(home && *home ? home : "/") + "/.cache/liquiddock";
+}
+
+int64_t fileMtime(const std::string& path) {
+    struct stat st{};
+    if (stat(path.c_str(), &st) != 0)
+        return 0;
+    return (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+}
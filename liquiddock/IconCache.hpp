@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// One icon as stored in the cache: cairo ARGB32, premultiplied, pixelSize
+// rows of stride bytes. pixels points into the mapped file, or into memory
+// owned by whoever builds records for write().
+struct SIconCacheRecord {
+    std::string    appId;
+    std::string    theme;
+    std::string    path;
+    int            pixelSize  = 0;
+    int            stride     = 0;
+    int64_t        themeStamp = 0; // iconThemeStamp() of theme when decoded
+    int64_t        iconMtime  = 0; // mtime of path when decoded
+    const uint8_t* pixels     = nullptr;
+};
+
+// A read-only, memory-mapped view of $XDG_CACHE_HOME/liquiddock/icons.bin:
+// pre-scaled icons keyed by app id, icon theme and pixel size (icon size
+// times monitor scale). A missing, foreign, outdated or damaged file just
+// means an empty cache. Deciding whether an entry is still current is up
+// to the caller, through the stamps each record carries.
+class CIconCache {
+  public:
+    CIconCache();
+    ~CIconCache();
+
+    CIconCache(const CIconCache&)            = delete;
+    CIconCache& operator=(const CIconCache&) = delete;
+
+    const SIconCacheRecord*              find(const std::string& appId, const std::string& theme, int pixelSize) const;
+    const std::vector<SIconCacheRecord>& records() const;
+
+    // Writes records as the new cache file, replacing the old one atomically.
+    // Existing mappings, including this process's, stay valid.
+    static bool                          write(const std::vector<SIconCacheRecord>& records);
+
+  private:
+    void*                                   m_map     = nullptr;
+    size_t                                  m_mapSize = 0;
+    std::vector<SIconCacheRecord>           m_records;
+    std::unordered_map<std::string, size_t> m_index;
+};
+
+// $XDG_CACHE_HOME/liquiddock
+std::string iconCacheDir();
+
+// Modification time of path in nanoseconds, or 0 if it can't be read.
+int64_t fileMtime(const std::string& path);
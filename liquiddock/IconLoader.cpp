@@ -0,0 +1,597 @@
+#include "IconLoader.hpp"
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cairo/cairo.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <librsvg/rsvg.h>
+#include <sstream>
+#include <tuple>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+constexpr std::array<int, 11> THEMESIZES = {16, 22, 24, 32, 48, 64, 96, 128, 192, 256, 512};
+
+// How long the request queue has to stay empty before the caches are
+// written, so a dock filling up writes them once rather than per icon
+constexpr auto SAVEDELAY = std::chrono::seconds(2);
+
+std::string envOr(const char* name, const std::string& fallback) {
+    const char* value = getenv(name);
+    return value && *value ? value : fallback;
+}
+
+std::string homeDir() {
+    return envOr("HOME", "/");
+}
+
+std::vector<std::string> splitList(const std::string& list, char sep) {
+    std::vector<std::string> out;
+    std::stringstream        stream(list);
+    std::string              part;
+    while (std::getline(stream, part, sep)) {
+        part.erase(0, part.find_first_not_of(' '));
+        part.erase(part.find_last_not_of(' ') + 1);
+        if (!part.empty())
+            out.push_back(part);
+    }
+    return out;
+}
+
+std::string lowercase(std::string str) {
+    std::ranges::transform(str, str.begin(), [](unsigned char c) { return std::tolower(c); });
+    return str;
+}
+
+// $XDG_DATA_HOME first, then $XDG_DATA_DIRS
+std::vector<std::string> dataDirs() {
+    std::vector<std::string> dirs = {envOr("XDG_DATA_HOME", homeDir() + "/.local/share")};
+    for (auto& dir : splitList(envOr("XDG_DATA_DIRS", "/usr/local/share:/usr/share"), ':'))
+        dirs.push_back(dir);
+    return dirs;
+}
+
+bool isFile(const fs::path& path) {
+    std::error_code ec;
+    return fs::is_regular_file(path, ec);
+}
+
+// Reads one key from a freedesktop key file group, e.g. Icon in [Desktop Entry].
+std::string readKey(const fs::path& path, const std::string& group, const std::string& key) {
+    std::ifstream file(path);
+    std::string   line;
+    bool          inGroup = false;
+    while (std::getline(file, line)) {
+        if (line.starts_with('[')) {
+            inGroup = line == "[" + group + "]";
+            continue;
+        }
+        if (inGroup && line.starts_with(key)) {
+            const auto EQ = line.find('=', key.size());
+            if (EQ != std::string::npos && line.find_first_not_of(' ', key.size()) == EQ) {
+                auto value = line.substr(EQ + 1);
+                value.erase(0, value.find_first_not_of(' '));
+                return value;
+            }
+        }
+    }
+    return "";
+}
+
+// The Icon= of appId's desktop entry: by file name first, then by
+// StartupWMClass. Falls back to the lowercased app id, which is the icon
+// name most apps ship under.
+std::string iconNameFor(const std::string& appId) {
+    const auto DIRS = dataDirs();
+
+    for (const auto& dir : DIRS) {
+        for (const auto& name : {appId, lowercase(appId)}) {
+            const auto ICON = readKey(fs::path(dir) / "applications" / (name + ".desktop"), "Desktop Entry", "Icon");
+            if (!ICON.empty())
+                return ICON;
+        }
+    }
+
+    const auto WANTED = lowercase(appId);
+    for (const auto& dir : DIRS) {
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(fs::path(dir) / "applications", ec)) {
+            if (entry.path().extension() != ".desktop")
+                continue;
+            if (lowercase(readKey(entry.path(), "Desktop Entry", "StartupWMClass")) != WANTED)
+                continue;
+            const auto ICON = readKey(entry.path(), "Desktop Entry", "Icon");
+            if (!ICON.empty())
+                return ICON;
+        }
+    }
+
+    return WANTED;
+}
+
+std::vector<fs::path> iconBaseDirs() {
+    std::vector<fs::path> dirs = {fs::path(homeDir()) / ".icons"};
+    for (const auto& dir : dataDirs())
+        dirs.push_back(fs::path(dir) / "icons");
+    return dirs;
+}
+
+// theme, the themes it inherits from (breadth first), then hicolor
+std::vector<std::string> themeChain(const std::string& theme) {
+    const auto               BASES = iconBaseDirs();
+    std::vector<std::string> chain = {theme.empty() ? "hicolor" : theme};
+
+    for (size_t i = 0; i < chain.size() && chain.size() < 16; ++i) {
+        for (const auto& base : BASES) {
+            const auto INDEX = base / chain[i] / "index.theme";
+            if (!isFile(INDEX))
+                continue;
+            for (const auto& parent : splitList(readKey(INDEX, "Icon Theme", "Inherits"), ','))
+                if (std::ranges::find(chain, parent) == chain.end())
+                    chain.push_back(parent);
+            break;
+        }
+    }
+
+    if (std::ranges::find(chain, "hicolor") == chain.end())
+        chain.push_back("hicolor");
+    return chain;
+}
+
+// Every group of a freedesktop key file, e.g. an icon theme's index.theme.
+using CKeyFile = std::unordered_map<std::string, std::unordered_map<std::string, std::string>>;
+
+CKeyFile readKeyFile(const fs::path& path) {
+    CKeyFile      groups;
+    std::ifstream file(path);
+    std::string   line;
+    std::string   group;
+    while (std::getline(file, line)) {
+        if (line.starts_with('[') && line.ends_with(']')) {
+            group = line.substr(1, line.size() - 2);
+            continue;
+        }
+
+        const auto EQ = line.find('=');
+        if (line.starts_with('#') || EQ == std::string::npos)
+            continue;
+
+        auto key   = line.substr(0, EQ);
+        auto value = line.substr(EQ + 1);
+        key.erase(key.find_last_not_of(' ') + 1);
+        value.erase(0, value.find_first_not_of(' '));
+        groups[group][key] = value;
+    }
+    return groups;
+}
+
+int intOr(const std::unordered_map<std::string, std::string>& group, const std::string& key, int fallback) {
+    const auto IT = group.find(key);
+    if (IT == group.end())
+        return fallback;
+
+    char*      end   = nullptr;
+    const long VALUE = std::strtol(IT->second.c_str(), &end, 10);
+    return end != IT->second.c_str() ? (int)VALUE : fallback;
+}
+
+// One icon directory of a theme, relative to the theme directory. Sizes are
+// in pixels, the directory's Scale included, so 48x48@2 holds 96px icons.
+struct SThemeDir {
+    std::string path;
+    int         size     = 0;
+    int         minSize  = 0;
+    int         maxSize  = 0;
+    bool        scalable = false;
+};
+
+// The order icons are tried in: the smallest bitmap at least pixelSize
+// large, then scalable icons (those made for pixelSize first), then the
+// largest smaller bitmap. Scaling down a bigger bitmap looks better than
+// the closest-size match the spec would pick.
+void sortThemeDirs(std::vector<SThemeDir>& dirs, int pixelSize) {
+    const auto RANK = [pixelSize](const SThemeDir& dir) {
+        if (dir.scalable)
+            return std::tuple{1, pixelSize >= dir.minSize && pixelSize <= dir.maxSize ? 0 : 1, 0};
+        if (dir.size >= pixelSize)
+            return std::tuple{0, 0, dir.size};
+        return std::tuple{2, 0, -dir.size};
+    };
+    std::ranges::stable_sort(dirs, {}, RANK);
+}
+
+// The directories theme's index.theme lists under Directories and
+// ScaledDirectories. The first base dir holding an index.theme defines the
+// theme; its directories are then searched in every base dir. Empty if no
+// index.theme was found.
+std::vector<SThemeDir> themeDirs(const std::string& theme, const std::vector<fs::path>& bases) {
+    CKeyFile index;
+    for (const auto& base : bases) {
+        if (isFile(base / theme / "index.theme")) {
+            index = readKeyFile(base / theme / "index.theme");
+            break;
+        }
+    }
+
+    const auto& HEADER = index["Icon Theme"];
+    auto        names  = splitList(HEADER.contains("Directories") ? HEADER.at("Directories") : "", ',');
+    for (auto& name : splitList(HEADER.contains("ScaledDirectories") ? HEADER.at("ScaledDirectories") : "", ','))
+        names.push_back(std::move(name));
+
+    std::vector<SThemeDir> dirs;
+    for (const auto& name : names) {
+        const auto IT = index.find(name);
+        if (IT == index.end())
+            continue;
+
+        const auto& GROUP = IT->second;
+        const int   SIZE  = intOr(GROUP, "Size", 0);
+        const int   SCALE = std::max(1, intOr(GROUP, "Scale", 1));
+        if (SIZE <= 0)
+            continue;
+
+        const auto TYPE      = GROUP.contains("Type") ? GROUP.at("Type") : "Threshold";
+        const int  THRESHOLD = intOr(GROUP, "Threshold", 2);
+        SThemeDir  dir       = {.path = name, .size = SIZE * SCALE, .scalable = TYPE == "Scalable"};
+        if (dir.scalable) {
+            dir.minSize = intOr(GROUP, "MinSize", SIZE) * SCALE;
+            dir.maxSize = intOr(GROUP, "MaxSize", SIZE) * SCALE;
+        } else if (TYPE == "Threshold") {
+            dir.minSize = (SIZE - THRESHOLD) * SCALE;
+            dir.maxSize = (SIZE + THRESHOLD) * SCALE;
+        } else
+            dir.minSize = dir.maxSize = dir.size;
+        dirs.push_back(std::move(dir));
+    }
+    return dirs;
+}
+
+// For a theme without an index.theme (say, icons an app installed into
+// ~/.local/share/icons/hicolor with no system hicolor around): the
+// <size>x<size>/apps and apps/<size> layouts most themes use.
+std::vector<SThemeDir> guessedThemeDirs() {
+    std::vector<SThemeDir> dirs;
+    for (const auto SIZE : THEMESIZES) {
+        for (const auto& path : {std::format("{}x{}/apps", SIZE, SIZE), std::format("apps/{}", SIZE)})
+            dirs.push_back({.path = path, .size = SIZE, .minSize = SIZE, .maxSize = SIZE});
+    }
+    dirs.push_back({.path = "scalable/apps", .size = 512, .minSize = 1, .maxSize = INT_MAX, .scalable = true});
+    return dirs;
+}
+
+// Icon= should be a bare name, but plenty of desktop entries carry the file
+// extension anyway.
+std::string stripIconExtension(const std::string& name) {
+    for (const auto* ext : {".png", ".svg", ".xpm"}) {
+        if (name.ends_with(ext) && name.size() > std::strlen(ext))
+            return name.substr(0, name.size() - std::strlen(ext));
+    }
+    return name;
+}
+
+// Finds name in the theme chain, in the directories each theme's
+// index.theme lists, tried in sortThemeDirs order; then in pixmaps. Icon
+// contexts are not looked at, and .xpm files are not used since they can't
+// be decoded.
+std::string findThemeIcon(const std::string& iconName, const std::string& theme, int pixelSize) {
+    if (iconName.starts_with('/'))
+        return isFile(iconName) ? iconName : "";
+
+    const auto NAME  = stripIconExtension(iconName);
+    const auto BASES = iconBaseDirs();
+    for (const auto& themeName : themeChain(theme)) {
+        auto dirs = themeDirs(themeName, BASES);
+        if (dirs.empty())
+            dirs = guessedThemeDirs();
+        sortThemeDirs(dirs, pixelSize);
+
+        for (const auto& dir : dirs) {
+            for (const auto& base : BASES) {
+                for (const auto* ext : {".png", ".svg"}) {
+                    const auto PATH = base / themeName / dir.path / (NAME + ext);
+                    if (isFile(PATH))
+                        return PATH;
+                }
+            }
+        }
+    }
+
+    for (const auto& dir : dataDirs()) {
+        for (const auto* ext : {".png", ".svg"}) {
+            const auto PATH = fs::path(dir) / "pixmaps" / (NAME + ext);
+            if (isFile(PATH))
+                return PATH;
+        }
+    }
+
+    return "";
+}
+
+// Draws the icon at path into out, fitted and centered in a pixelSize square.
+bool decodeIcon(const std::string& path, int pixelSize, SDecodedIcon& out) {
+    const auto SURFACE = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, pixelSize, pixelSize);
+    const auto CAIRO   = cairo_create(SURFACE);
+    bool       drawn   = false;
+
+    if (path.ends_with(".svg")) {
+        GError*    error  = nullptr;
+        const auto HANDLE = rsvg_handle_new_from_file(path.c_str(), &error);
+        if (HANDLE) {
+            const RsvgRectangle VIEWPORT = {0, 0, (double)pixelSize, (double)pixelSize};
+            drawn                        = rsvg_handle_render_document(HANDLE, CAIRO, &VIEWPORT, &error);
+            g_object_unref(HANDLE);
+        }
+        if (error)
+            g_error_free(error);
+    } else if (path.ends_with(".png")) {
+        const auto IMAGE = cairo_image_surface_create_from_png(path.c_str());
+        if (cairo_surface_status(IMAGE) == CAIRO_STATUS_SUCCESS) {
+            const double W     = cairo_image_surface_get_width(IMAGE);
+            const double H     = cairo_image_surface_get_height(IMAGE);
+            const double SCALE = std::min(pixelSize / W, pixelSize / H);
+
+            cairo_translate(CAIRO, (pixelSize - W * SCALE) / 2.0, (pixelSize - H * SCALE) / 2.0);
+            cairo_scale(CAIRO, SCALE, SCALE);
+            cairo_set_source_surface(CAIRO, IMAGE, 0, 0);
+            cairo_pattern_set_filter(cairo_get_source(CAIRO), CAIRO_FILTER_GOOD);
+            cairo_paint(CAIRO);
+            drawn = true;
+        }
+        cairo_surface_destroy(IMAGE);
+    }
+
+    if (drawn) {
+        cairo_surface_flush(SURFACE);
+        out.stride       = cairo_image_surface_get_stride(SURFACE);
+        const auto* DATA = cairo_image_surface_get_data(SURFACE);
+        out.pixels.assign(DATA, DATA + (size_t)out.stride * pixelSize);
+    }
+
+    cairo_destroy(CAIRO);
+    cairo_surface_destroy(SURFACE);
+    return drawn;
+}
+
+std::string pathCacheKey(const std::string& appId, const std::string& theme, int pixelSize) {
+    return std::format("{}\t{}\t{}", appId, theme, pixelSize);
+}
+}
+
+int64_t iconThemeStamp(const std::string& theme) {
+    int64_t stamp = 0;
+    for (const auto& themeName : themeChain(theme)) {
+        for (const auto& base : iconBaseDirs()) {
+            const auto DIR = base / themeName;
+            for (const auto& path : {DIR, DIR / "index.theme", DIR / "icon-theme.cache"})
+                stamp = std::max(stamp, fileMtime(path));
+        }
+    }
+    return stamp;
+}
+
+CIconLoader::CIconLoader() {
+    m_notifyFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    m_worker   = std::thread([this] { workerMain(); });
+}
+
+CIconLoader::~CIconLoader() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_one();
+    m_worker.join();
+
+    if (m_notifyFd >= 0)
+        close(m_notifyFd);
+}
+
+void CIconLoader::request(const std::string& appId, const std::string& theme, int pixelSize) {
+    {
+        std::lock_guard lock(m_mutex);
+        const auto      DUPLICATE = std::ranges::any_of(m_requests, [&](const SRequest& r) { return r.appId == appId && r.theme == theme && r.pixelSize == pixelSize; });
+        if (DUPLICATE)
+            return;
+        m_requests.push_back({appId, theme, pixelSize});
+    }
+    m_cv.notify_one();
+}
+
+const SIconCacheRecord* CIconLoader::cached(const std::string& appId, const std::string& theme, int pixelSize) const {
+    if (!m_cacheValidated.load(std::memory_order_acquire))
+        return nullptr;
+
+    return validCached(appId, theme, pixelSize);
+}
+
+const SIconCacheRecord* CIconLoader::validCached(const std::string& appId, const std::string& theme, int pixelSize) const {
+    const auto* REC = m_cache.find(appId, theme, pixelSize);
+    return REC && m_cacheValid[REC - m_cache.records().data()] ? REC : nullptr;
+}
+
+// Stats every entry's icon and theme once, so nothing on the main thread has
+// to. Changes to either during the session are picked up by the next load.
+void CIconLoader::validateCache() {
+    std::unordered_map<std::string, int64_t> stamps;
+
+    const auto& RECORDS = m_cache.records();
+    m_cacheValid.resize(RECORDS.size());
+    for (size_t i = 0; i < RECORDS.size(); ++i) {
+        const auto& REC = RECORDS[i];
+        if (!stamps.contains(REC.theme))
+            stamps[REC.theme] = iconThemeStamp(REC.theme);
+        m_cacheValid[i] = REC.themeStamp == stamps[REC.theme] && REC.iconMtime == fileMtime(REC.path);
+    }
+
+    m_cacheValidated.store(true, std::memory_order_release);
+}
+
+std::vector<SDecodedIcon> CIconLoader::takeDecoded(size_t max) {
+    std::lock_guard           lock(m_mutex);
+    std::vector<SDecodedIcon> out;
+    while (!m_decoded.empty() && out.size() < max) {
+        out.push_back(std::move(m_decoded.front()));
+        m_decoded.pop_front();
+    }
+    return out;
+}
+
+bool CIconLoader::hasDecoded() {
+    std::lock_guard lock(m_mutex);
+    return !m_decoded.empty();
+}
+
+int CIconLoader::notifyFd() const {
+    return m_notifyFd;
+}
+
+std::string CIconLoader::resolve(const SRequest& req) {
+    const auto KEY = pathCacheKey(req.appId, req.theme, req.pixelSize);
+    if (const auto IT = m_pathCache.find(KEY); IT != m_pathCache.end() && (IT->second.empty() || isFile(IT->second)))
+        return IT->second;
+
+    const auto PATH  = findThemeIcon(iconNameFor(req.appId), req.theme, req.pixelSize);
+    m_pathCache[KEY] = PATH;
+    m_pathCacheDirty |= !PATH.empty();
+    return PATH;
+}
+
+void CIconLoader::loadPathCache() {
+    std::ifstream file(iconCacheDir() + "/icon-paths");
+    std::string   line;
+    while (std::getline(file, line)) {
+        // appId \t theme \t size \t path
+        const auto LAST = line.rfind('\t');
+        if (LAST == std::string::npos || LAST + 1 == line.size())
+            continue;
+        m_pathCache[line.substr(0, LAST)] = line.substr(LAST + 1);
+    }
+}
+
+void CIconLoader::savePathCache() {
+    m_pathCacheDirty = false;
+
+    std::error_code ec;
+    fs::create_directories(iconCacheDir(), ec);
+
+    // Written aside and renamed, so a crash never leaves a torn cache
+    const auto    PATH = iconCacheDir() + "/icon-paths";
+    std::ofstream file(PATH + ".tmp", std::ios::trunc);
+    for (const auto& [key, path] : m_pathCache) {
+        if (!path.empty())
+            file << key << '\t' << path << '\n';
+    }
+    file.close();
+
+    if (file.good())
+        fs::rename(PATH + ".tmp", PATH, ec);
+}
+
+void CIconLoader::saveIconCache() {
+    m_freshUnsaved = false;
+
+    // The loaded file's entries were checked by validateCache; after the
+    // first write everything carried forward was current when written
+    std::vector<SIconCacheRecord> records;
+    if (m_written)
+        records = m_written->records();
+    else {
+        for (size_t i = 0; i < m_cache.records().size(); ++i) {
+            if (m_cacheValid[i])
+                records.push_back(m_cache.records()[i]);
+        }
+    }
+
+    std::erase_if(records, [&](const SIconCacheRecord& old) {
+        return std::ranges::any_of(m_fresh, [&](const SDecodedIcon& i) { return i.appId == old.appId && i.theme == old.theme && i.pixelSize == old.pixelSize; });
+    });
+
+    for (const auto& icon : m_fresh) {
+        records.push_back({.appId      = icon.appId,
+                           .theme      = icon.theme,
+                           .path       = icon.path,
+                           .pixelSize  = icon.pixelSize,
+                           .stride     = icon.stride,
+                           .themeStamp = icon.themeStamp,
+                           .iconMtime  = icon.iconMtime,
+                           .pixels     = icon.pixels.data()});
+    }
+
+    // On failure the fresh icons wait for the next write with whatever the
+    // next batch adds
+    if (!CIconCache::write(records))
+        return;
+
+    m_written = std::make_unique<CIconCache>();
+    m_fresh.clear();
+}
+
+void CIconLoader::workerMain() {
+    validateCache();
+    loadPathCache();
+
+    while (true) {
+        SRequest req;
+        {
+            std::unique_lock lock(m_mutex);
+            const auto       WAKE = [this] { return m_stop || !m_requests.empty(); };
+            if (m_requests.empty() && (m_pathCacheDirty || m_freshUnsaved) && !m_cv.wait_for(lock, SAVEDELAY, WAKE)) {
+                // Idle for a while: persist what this batch resolved and decoded
+                lock.unlock();
+                if (m_pathCacheDirty)
+                    savePathCache();
+                if (m_freshUnsaved)
+                    saveIconCache();
+                lock.lock();
+            }
+
+            m_cv.wait(lock, WAKE);
+            if (m_stop)
+                break;
+
+            req = std::move(m_requests.front());
+            m_requests.pop_front();
+        }
+
+        SDecodedIcon icon = {.appId = req.appId, .theme = req.theme, .pixelSize = req.pixelSize};
+        if (const auto* REC = validCached(req.appId, req.theme, req.pixelSize)) {
+            // Requested before validateCache finished, or asked for again:
+            // uploaded straight from the mapping, no decoding
+            icon.path   = REC->path;
+            icon.stride = REC->stride;
+            icon.cached = REC;
+        } else {
+            icon.path = resolve(req);
+            if (!icon.path.empty() && decodeIcon(icon.path, req.pixelSize, icon)) {
+                icon.themeStamp = iconThemeStamp(req.theme);
+                icon.iconMtime  = fileMtime(icon.path);
+
+                std::erase_if(m_fresh, [&](const SDecodedIcon& i) { return i.appId == icon.appId && i.theme == icon.theme && i.pixelSize == icon.pixelSize; });
+                m_fresh.push_back(icon);
+                m_freshUnsaved = true;
+            }
+        }
+
+        {
+            std::lock_guard lock(m_mutex);
+            m_decoded.push_back(std::move(icon));
+        }
+
+        const uint64_t                ONE     = 1;
+        [[maybe_unused]] const auto   WRITTEN = write(m_notifyFd, &ONE, sizeof(ONE));
+    }
+
+    if (m_pathCacheDirty)
+        savePathCache();
+    if (m_freshUnsaved)
+        saveIconCache();
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "IconCache.hpp"
+
+// Changes whenever theme, anything it inherits from, or hicolor is
+// installed, removed or updated.
+int64_t iconThemeStamp(const std::string& theme);
+
+// A decoded icon, ready for upload: cairo ARGB32, premultiplied, pixelSize
+// rows of stride bytes. pixels is empty when no usable icon was found.
+struct SDecodedIcon {
+    std::string          appId;
+    std::string          theme;
+    int                  pixelSize = 0;
+    std::string          path;
+    int                  stride     = 0;
+    int64_t              themeStamp = 0;
+    int64_t              iconMtime  = 0;
+    std::vector<uint8_t> pixels;
+    // Set instead of pixels when the request was served from icons.bin;
+    // points into the mapping, which lives as long as the loader
+    const SIconCacheRecord* cached = nullptr;
+};
+
+// Resolves app ids to icon files through desktop entries and the XDG icon
+// theme, and decodes them at the requested pixel size, all on a worker
+// thread. Resolved paths persist in $XDG_CACHE_HOME/liquiddock/icon-paths and
+// decoded icons in the mapped icons.bin next to it, so later sessions skip
+// both the search and the decoding.
+class CIconLoader {
+  public:
+    CIconLoader();
+    ~CIconLoader();
+
+    // The still-current cached icon for the request, read straight from the
+    // mapping, or null. Does no filesystem work: entries are checked once, on
+    // the worker, and until that is done every lookup misses and the request
+    // is served by the worker instead.
+    const SIconCacheRecord*   cached(const std::string& appId, const std::string& theme, int pixelSize) const;
+
+    // Queues appId for decoding at pixelSize x pixelSize. An empty theme
+    // means hicolor.
+    void                      request(const std::string& appId, const std::string& theme, int pixelSize);
+
+    // Takes up to max finished icons, oldest first.
+    std::vector<SDecodedIcon> takeDecoded(size_t max);
+    bool                      hasDecoded();
+
+    // Becomes readable whenever an icon finishes; the owner reads it to clear it.
+    int                       notifyFd() const;
+
+  private:
+    struct SRequest {
+        std::string appId;
+        std::string theme;
+        int         pixelSize = 0;
+    };
+
+    void                                         workerMain();
+    void                                         validateCache();
+    const SIconCacheRecord*                      validCached(const std::string& appId, const std::string& theme, int pixelSize) const;
+    std::string                                  resolve(const SRequest& req);
+    void                                         loadPathCache();
+    void                                         savePathCache();
+    void                                         saveIconCache();
+
+    // Mapped before the worker starts and never remapped, so both threads read it freely
+    CIconCache                                   m_cache;
+    // Whether each m_cache record was current when the plugin loaded, indexed
+    // like its records(). Written by the worker before it sets m_cacheValidated,
+    // read-only after.
+    std::vector<uint8_t>                         m_cacheValid;
+    std::atomic<bool>                            m_cacheValidated = false;
+
+    std::mutex                                   m_mutex;
+    std::condition_variable                      m_cv;
+    std::deque<SRequest>                         m_requests;
+    std::deque<SDecodedIcon>                     m_decoded;
+    bool                                         m_stop     = false;
+    int                                          m_notifyFd = -1;
+
+    // Worker thread only. Keyed by app id, theme and size; unresolvable ids
+    // map to an empty path and are not persisted, so newly installed apps
+    // get found next session.
+    std::unordered_map<std::string, std::string> m_pathCache;
+    bool                                         m_pathCacheDirty = false;
+    std::vector<SDecodedIcon>                    m_fresh; // decoded since the last icons.bin write
+    bool                                         m_freshUnsaved = false;
+    // The icons.bin this session last wrote, mapped again; what the next write
+    // carries forward. Null until the first write.
+    std::unique_ptr<CIconCache>                  m_written;
+
+    std::thread                                  m_worker;
+};
@@ -2,6 +2,7 @@
   lib,
   hyprland,
   hyprlandPlugins,
+  librsvg,
 }:
 hyprlandPlugins.mkHyprlandPlugin {
   pluginName = "liquiddock";
@@ -9,6 +10,7 @@ hyprlandPlugins.mkHyprlandPlugin {
   src = ./.;
 
   inherit (hyprland) nativeBuildInputs;
+  buildInputs = [ librsvg ];
 
   meta = with lib; {
     homepage = "https://github.com/hyprwm/hyprland-plugins/tree/main/liquiddock";
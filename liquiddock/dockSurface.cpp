@@ -11,7 +11,13 @@
 #include <hyprland/src/managers/animation/AnimationManager.hpp>
 #include <hyprland/src/debug/log/Logger.hpp>
 #include <algorithm>
+#include <bit>
+#include <cstddef>
 #include <cmath>
+#include <ctime>
+#include <format>
+#include <string>
+#include <unistd.h>
 
 #include "globals.hpp"
 #include "DockPassElement.hpp"
@@ -23,6 +29,14 @@
 static constexpr float DOT_RADIUS     = 2.5F;  // Running indicator dot radius
 static constexpr float DOT_OFFSET_Y   = 4.F;   // Vertical offset of dots below icons
 static constexpr float DOT_MARGIN     = 10.F;   // Extra render area for indicator dots
+static constexpr GLuint ICONS_BINDING  = 0;     // Storage buffer binding points of the shape arrays
+static constexpr GLuint DOTS_BINDING   = 1;
+static constexpr GLuint TILES_BINDING  = 2;
+static constexpr GLuint SHAPES_BINDING = 0;     // Uniform buffer binding point of the bounded fallback's DockShapes
+static constexpr GLint  SHAPES_STORAGE_BLOCKS = 3; // Fragment storage blocks the unbounded shader binds
+static constexpr auto   AUTOHIDE_DELAY = std::chrono::milliseconds(1500); // Hide after this long without hover
+static constexpr size_t SHAPES_MIN_BYTES = 4096; // Initial storage buffer size; they grow in powers of two
+static constexpr size_t INSTANCES_MIN_BYTES = 4096; // Same for the icon instance buffer
 
 // ────────────────────────────────────────────────────────────────────────────
 // Gooey SDF fragment shader source (embedded)
@@ -34,21 +48,37 @@ precision highp float;
 in vec2 v_texcoord;
 out vec4 fragColor;
 
-#define MAX_ICONS 32
+#ifdef BOUNDED_SHAPES
+// Fallback for drivers without three fragment storage blocks: all shapes in
+// one fixed-size uniform block, which the CPU side never overfills
+layout(std140) uniform DockShapes {
+    vec4  u_icons[BOUNDED_SHAPES]; // xy: center, z: size, w: rounding
+    vec4  u_dots[BOUNDED_SHAPES];  // xy: center, z: radius
+    ivec4 u_tiles[BOUNDED_TILES];  // x: first icon, y: icon count, z: first dot, w: dot count
+};
+#else
+// Icon and dot shapes, sized to however many items the dock holds
+layout(std430, binding = 0) readonly buffer DockIcons {
+    vec4 u_icons[]; // xy: center, z: size, w: rounding
+};
+layout(std430, binding = 1) readonly buffer DockDots {
+    vec4 u_dots[]; // xy: center, z: radius
+};
+layout(std430, binding = 2) readonly buffer DockTiles {
+    ivec4 u_tiles[]; // x: first icon, y: icon count, z: first dot, w: dot count
+};
+#endif
 
 // Icon shapes — their gooey-merged SDF forms the dock surface
-uniform vec2  u_iconPositions[MAX_ICONS];
-uniform vec2  u_iconSizes[MAX_ICONS];
-uniform float u_iconRoundings[MAX_ICONS];
-uniform int   u_numIcons;
 uniform float u_threshold;
 
 // Running indicator dots
-uniform vec2  u_dotPositions[MAX_ICONS];
-uniform float u_dotRadii[MAX_ICONS];
-uniform int   u_numDots;
 uniform vec4  u_dotColor;
 
+// Horizontal tiles; each lists only the shapes that can reach it
+uniform float u_tileWidth;
+uniform int   u_numTiles;
+
 // Common
 uniform vec4  u_dockColor;
 uniform vec2  u_resolution;
@@ -65,16 +95,16 @@ float circleSDF(vec2 p, float r) {
 
 void main() {
     vec2 fragPos = v_texcoord * u_resolution;
+    ivec4 tile = u_tiles[clamp(int(fragPos.x / u_tileWidth), 0, u_numTiles - 1)];
 
     // --- Dock surface: gooey-merged icon blobs ---
     float dockAlpha = 0.0;
-    if (u_numIcons > 0) {
+    if (tile.y > 0) {
         float combinedSDF = 1e20;
-        for (int i = 0; i < u_numIcons; ++i) {
-            if (i >= MAX_ICONS)
-                break;
-            vec2 p = fragPos - u_iconPositions[i];
-            float currentSDF = roundRectSDF(p, u_iconSizes[i], u_iconRoundings[i]);
+        for (int n = 0; n < tile.y; ++n) {
+            int i = tile.x + n;
+            vec2 p = fragPos - u_icons[i].xy;
+            float currentSDF = roundRectSDF(p, vec2(u_icons[i].z), u_icons[i].w);
 
             // Smooth minimum for gooey blobbing
             float k = u_threshold;
@@ -86,10 +116,9 @@ void main() {
 
     // --- Running indicator dots ---
     float dotAlpha = 0.0;
-    for (int i = 0; i < u_numDots; ++i) {
-        if (i >= MAX_ICONS)
-            break;
-        float d = circleSDF(fragPos - u_dotPositions[i], u_dotRadii[i]);
+    for (int n = 0; n < tile.w; ++n) {
+        int i = tile.z + n;
+        float d = circleSDF(fragPos - u_dots[i].xy, u_dots[i].z);
         dotAlpha = max(dotAlpha, smoothstep(1.0, -1.0, d));
     }
 
@@ -112,6 +141,29 @@ void main() {
 }
 )glsl";
 
+// Composites the cached SDF pass output. The cache was drawn through the same
+// Y-flipping vertex shader, so its top row is the last one in GL order.
+static const char* CACHE_FRAG_SRC = R"glsl(#version 320 es
+precision highp float;
+
+in vec2 v_texcoord;
+out vec4 fragColor;
+
+uniform sampler2D u_tex;
+uniform float     u_alpha;
+
+void main() {
+    vec4 color = texture(u_tex, vec2(v_texcoord.x, 1.0 - v_texcoord.y));
+    color.a *= u_alpha;
+
+    if (color.a > 0.001) {
+        fragColor = color;
+    } else {
+        discard;
+    }
+}
+)glsl";
+
 static const char* GOOEY_VERT_SRC = R"glsl(#version 320 es
 precision highp float;
 
@@ -134,6 +186,74 @@ void main() {
 }
 )glsl";
 
+// Icons and placeholders, one instance each. Atlas texels are cairo's BGRA
+// bytes, premultiplied, so the output is blended as premultiplied too.
+static const char* ICON_VERT_SRC = R"glsl(#version 320 es
+precision highp float;
+
+layout(location = 0) in vec2 a_position;
+
+// Per instance
+layout(location = 1) in vec4 a_box;    // monitor-local x, y, w, h
+layout(location = 2) in vec4 a_uv;     // atlas u0, v0, u1, v1
+layout(location = 3) in vec4 a_color;  // placeholder rgb, alpha
+layout(location = 4) in vec2 a_params; // x: placeholder rounding, y: textured
+
+uniform vec2 u_monitorSize;
+
+out vec2      v_uv;
+out vec2      v_local;
+flat out vec4 v_color;
+flat out vec4 v_shape; // size, rounding, textured
+
+void main() {
+    v_uv    = mix(a_uv.xy, a_uv.zw, a_position);
+    v_local = (a_position - 0.5) * a_box.zw;
+    v_color = a_color;
+    v_shape = vec4(a_box.zw, a_params);
+
+    vec2 pos = a_box.xy + a_position * a_box.zw;
+    vec2 ndc = (pos / u_monitorSize) * 2.0 - 1.0;
+    ndc.y = -ndc.y; // flip Y for GL
+    gl_Position = vec4(ndc, 0.0, 1.0);
+}
+)glsl";
+
+static const char* ICON_FRAG_SRC = R"glsl(#version 320 es
+precision highp float;
+
+in vec2      v_uv;
+in vec2      v_local;
+flat in vec4 v_color;
+flat in vec4 v_shape;
+out vec4 fragColor;
+
+uniform sampler2D u_atlas;
+
+float roundRectSDF(vec2 p, vec2 size, float r) {
+    vec2 halfSize = size * 0.5;
+    vec2 d = abs(p) - (halfSize - r);
+    return min(max(d.x, d.y), 0.0) + length(max(d, 0.0)) - r;
+}
+
+void main() {
+    vec4 color;
+    if (v_shape.w > 0.5) {
+        // Mip level follows the magnified size on its own
+        color = texture(u_atlas, v_uv).bgra * v_color.a;
+    } else {
+        float coverage = smoothstep(1.0, -1.0, roundRectSDF(v_local, v_shape.xy, v_shape.z));
+        color = vec4(v_color.rgb, 1.0) * (v_color.a * coverage);
+    }
+
+    if (color.a > 0.001) {
+        fragColor = color;
+    } else {
+        discard;
+    }
+}
+)glsl";
+
 // ────────────────────────────────────────────────────────────────────────────
 // Construction / Destruction
 // ────────────────────────────────────────────────────────────────────────────
@@ -147,10 +267,21 @@ CLiquidDock::CLiquidDock() {
     initShader();
     rebuildDockItems();
     layoutIcons();
+    m_layoutBox = dockBoxGlobal();
     damageEntire();
+
+    m_iconLoader      = makeUnique<CIconLoader>();
+    m_iconEventSource = wl_event_loop_add_fd(g_pCompositor->m_wlEventLoop, m_iconLoader->notifyFd(), WL_EVENT_READABLE, onIconsReady, this);
+    m_autoHideTimer   = wl_event_loop_add_timer(g_pCompositor->m_wlEventLoop, onAutoHideTimer, this);
 }
 
 CLiquidDock::~CLiquidDock() {
+    if (m_iconEventSource)
+        wl_event_source_remove(m_iconEventSource);
+    if (m_autoHideTimer)
+        wl_event_source_remove(m_autoHideTimer);
+    m_iconLoader.reset();
+
     destroyShader();
     m_pMouseButtonCallback.reset();
     m_pMouseMoveCallback.reset();
@@ -177,42 +308,253 @@ static GLuint compileShader(GLenum type, const char* src) {
     return shader;
 }
 
-void CLiquidDock::initShader() {
-    GLuint vert = compileShader(GL_VERTEX_SHADER, GOOEY_VERT_SRC);
-    GLuint frag = compileShader(GL_FRAGMENT_SHADER, GOOEY_FRAG_SRC);
+static GLuint linkProgram(const char* vertSrc, const char* fragSrc) {
+    GLuint vert = compileShader(GL_VERTEX_SHADER, vertSrc);
+    GLuint frag = compileShader(GL_FRAGMENT_SHADER, fragSrc);
 
     if (!vert || !frag) {
         if (vert)
             glDeleteShader(vert);
         if (frag)
             glDeleteShader(frag);
-        return;
+        return 0;
     }
 
-    m_shaderProgram = glCreateProgram();
-    glAttachShader(m_shaderProgram, vert);
-    glAttachShader(m_shaderProgram, frag);
-    glLinkProgram(m_shaderProgram);
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vert);
+    glAttachShader(program, frag);
+    glLinkProgram(program);
 
     GLint linked = 0;
-    glGetProgramiv(m_shaderProgram, GL_LINK_STATUS, &linked);
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
     if (!linked) {
         char log[512];
-        glGetProgramInfoLog(m_shaderProgram, sizeof(log), nullptr, log);
+        glGetProgramInfoLog(program, sizeof(log), nullptr, log);
         Log::logger->log(Log::ERR, "[LiquidDock] Shader link error: {}", log);
-        glDeleteProgram(m_shaderProgram);
-        m_shaderProgram = 0;
+        glDeleteProgram(program);
+        program = 0;
     }
 
     glDeleteShader(vert);
     glDeleteShader(frag);
+
+    return program;
+}
+
+// The gooey shader with its shapes in the DockShapes uniform block
+static std::string boundedGooeySource() {
+    std::string src = GOOEY_FRAG_SRC;
+    src.insert(src.find('\n') + 1, std::format("#define BOUNDED_SHAPES {}\n#define BOUNDED_TILES {}\n", GOOEY_BOUNDED_SHAPES, GOOEY_BOUNDED_TILES));
+    return src;
+}
+
+void CLiquidDock::initShader() {
+    // Each pass checks its own objects, so a program that fails to link only
+    // disables what it draws
+    initQuad();
+    initGooeyProgram();
+    initCacheProgram();
+    initIconProgram();
+}
+
+void CLiquidDock::initQuad() {
+    // Unit quad, mapped onto the dock render area by the vertex shader
+    // clang-format off
+    const float vertices[] = {
+        0.F, 0.F,  0.F, 0.F,
+        1.F, 0.F,  1.F, 0.F,
+        1.F, 1.F,  1.F, 1.F,
+        0.F, 1.F,  0.F, 1.F,
+    };
+    // clang-format on
+
+    glGenVertexArrays(1, &m_quadVAO);
+    glGenBuffers(1, &m_quadVBO);
+
+    glBindVertexArray(m_quadVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // VAO and VBO
+    g_pGlobalState->glStats.objectsCreated += 2;
+}
+
+void CLiquidDock::initGooeyProgram() {
+    // GLES 3.1 only guarantees four storage blocks across all stages, and
+    // some drivers allow none in fragment shaders
+    GLint storageBlocks = 0;
+    glGetIntegerv(GL_MAX_FRAGMENT_SHADER_STORAGE_BLOCKS, &storageBlocks);
+    m_boundedShapes = storageBlocks < SHAPES_STORAGE_BLOCKS;
+
+    if (m_boundedShapes) {
+        Log::logger->log(Log::WARN, "[LiquidDock] {} fragment storage blocks, need {}; drawing at most {} items", storageBlocks, SHAPES_STORAGE_BLOCKS,
+                         GOOEY_BOUNDED_SHAPES);
+        m_shaderProgram = linkProgram(GOOEY_VERT_SRC, boundedGooeySource().c_str());
+    } else
+        m_shaderProgram = linkProgram(GOOEY_VERT_SRC, GOOEY_FRAG_SRC);
+    if (!m_shaderProgram)
+        return;
+
+    // Resolve every location once; renderDockSDF only uploads values
+    m_uniforms.topLeft     = glGetUniformLocation(m_shaderProgram, "u_topLeft");
+    m_uniforms.fullSize    = glGetUniformLocation(m_shaderProgram, "u_fullSize");
+    m_uniforms.monitorSize = glGetUniformLocation(m_shaderProgram, "u_monitorSize");
+    m_uniforms.resolution  = glGetUniformLocation(m_shaderProgram, "u_resolution");
+    m_uniforms.dockColor   = glGetUniformLocation(m_shaderProgram, "u_dockColor");
+    m_uniforms.threshold   = glGetUniformLocation(m_shaderProgram, "u_threshold");
+    m_uniforms.dotColor    = glGetUniformLocation(m_shaderProgram, "u_dotColor");
+    m_uniforms.tileWidth   = glGetUniformLocation(m_shaderProgram, "u_tileWidth");
+    m_uniforms.numTiles    = glGetUniformLocation(m_shaderProgram, "u_numTiles");
+
+    size_t shapeBuffers = m_shapeBuffers.size();
+    if (m_boundedShapes) {
+        const GLuint shapesBlock = glGetUniformBlockIndex(m_shaderProgram, "DockShapes");
+        if (shapesBlock != GL_INVALID_INDEX)
+            glUniformBlockBinding(m_shaderProgram, shapesBlock, SHAPES_BINDING);
+
+        // One buffer holds all three arrays
+        shapeBuffers = 1;
+        glGenBuffers(1, &m_shapeBuffers[0]);
+        glBindBuffer(GL_UNIFORM_BUFFER, m_shapeBuffers[0]);
+        glBufferData(GL_UNIFORM_BUFFER, (2 * GOOEY_BOUNDED_SHAPES + GOOEY_BOUNDED_TILES) * sizeof(SGooeyShapes::icons[0]), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    } else {
+        glGenBuffers(m_shapeBuffers.size(), m_shapeBuffers.data());
+        for (const auto buffer : m_shapeBuffers) {
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, SHAPES_MIN_BYTES, nullptr, GL_DYNAMIC_DRAW);
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        m_shapeBufferBytes.fill(SHAPES_MIN_BYTES);
+    }
+
+    // Program and shape buffers
+    g_pGlobalState->glStats.objectsCreated += 1 + shapeBuffers;
+}
+
+void CLiquidDock::initCacheProgram() {
+    // Optional; without it the SDF is always drawn straight to the monitor
+    if (!m_shaderProgram)
+        return;
+
+    m_cacheProgram = linkProgram(GOOEY_VERT_SRC, CACHE_FRAG_SRC);
+    if (!m_cacheProgram)
+        return;
+
+    m_cacheUniforms.topLeft     = glGetUniformLocation(m_cacheProgram, "u_topLeft");
+    m_cacheUniforms.fullSize    = glGetUniformLocation(m_cacheProgram, "u_fullSize");
+    m_cacheUniforms.monitorSize = glGetUniformLocation(m_cacheProgram, "u_monitorSize");
+    m_cacheUniforms.tex         = glGetUniformLocation(m_cacheProgram, "u_tex");
+    m_cacheUniforms.alpha       = glGetUniformLocation(m_cacheProgram, "u_alpha");
+
+    g_pGlobalState->glStats.objectsCreated++;
+}
+
+void CLiquidDock::initIconProgram() {
+    // Icons draw on their own, even when the SDF programs didn't link
+    m_iconProgram = linkProgram(ICON_VERT_SRC, ICON_FRAG_SRC);
+    if (!m_iconProgram)
+        return;
+
+    m_iconUniforms.monitorSize = glGetUniformLocation(m_iconProgram, "u_monitorSize");
+    m_iconUniforms.atlas       = glGetUniformLocation(m_iconProgram, "u_atlas");
+
+    // The unit quad again, plus one SIconInstance per icon
+    glGenVertexArrays(1, &m_iconVAO);
+    glGenBuffers(1, &m_instanceVBO);
+
+    glBindVertexArray(m_iconVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_quadVBO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, INSTANCES_MIN_BYTES, nullptr, GL_DYNAMIC_DRAW);
+    m_instanceBytes = INSTANCES_MIN_BYTES;
+
+    const auto instanceAttrib = [](GLuint location, GLint components, size_t offset) {
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, components, GL_FLOAT, GL_FALSE, sizeof(SIconInstance), (void*)offset);
+        glVertexAttribDivisor(location, 1);
+    };
+    instanceAttrib(1, 4, offsetof(SIconInstance, box));
+    instanceAttrib(2, 4, offsetof(SIconInstance, uv));
+    instanceAttrib(3, 4, offsetof(SIconInstance, color));
+    instanceAttrib(4, 2, offsetof(SIconInstance, radius));
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Program, VAO and instance buffer
+    g_pGlobalState->glStats.objectsCreated += 3;
 }
 
 void CLiquidDock::destroyShader() {
+    uint64_t deleted = 0;
+
+    // Counts its own texture
+    m_iconAtlas.release();
+
+    if (m_iconVAO) {
+        glDeleteVertexArrays(1, &m_iconVAO);
+        m_iconVAO = 0;
+        deleted++;
+    }
+    if (m_instanceVBO) {
+        glDeleteBuffers(1, &m_instanceVBO);
+        m_instanceVBO = 0;
+        deleted++;
+    }
+    if (m_iconProgram) {
+        glDeleteProgram(m_iconProgram);
+        m_iconProgram = 0;
+        deleted++;
+    }
+
+    if (m_sdfCache.isAllocated()) {
+        m_sdfCache.release();
+        deleted += 2; // framebuffer and its texture
+    }
+    if (m_cacheProgram) {
+        glDeleteProgram(m_cacheProgram);
+        m_cacheProgram = 0;
+        deleted++;
+    }
+
+    if (m_quadVAO) {
+        glDeleteVertexArrays(1, &m_quadVAO);
+        m_quadVAO = 0;
+        deleted++;
+    }
+    if (m_quadVBO) {
+        glDeleteBuffers(1, &m_quadVBO);
+        m_quadVBO = 0;
+        deleted++;
+    }
+    for (auto& buffer : m_shapeBuffers) {
+        if (!buffer)
+            continue;
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+        deleted++;
+    }
     if (m_shaderProgram) {
         glDeleteProgram(m_shaderProgram);
         m_shaderProgram = 0;
+        deleted++;
     }
+
+    // The dock may outlive the global state during plugin teardown
+    if (g_pGlobalState)
+        g_pGlobalState->glStats.objectsDeleted += deleted;
 }
 
 // ────────────────────────────────────────────────────────────────────────────
@@ -268,46 +610,136 @@ CBox CLiquidDock::dockBoxGlobal() const {
 // Dock item management
 // ────────────────────────────────────────────────────────────────────────────
 
+void createItemAnimations(SDockItem& item) {
+    if (item.position)
+        return;
+
+    const auto MOVE = g_pConfigManager->getAnimationPropertyConfig("windowsMove");
+    const auto FADE = g_pConfigManager->getAnimationPropertyConfig("fadeIn");
+
+    // The dock damages itself while any of these move
+    g_pAnimationManager->createAnimation(Vector2D{}, item.position, MOVE, AVARDAMAGE_NONE);
+    g_pAnimationManager->createAnimation(Vector2D{}, item.size, MOVE, AVARDAMAGE_NONE);
+    g_pAnimationManager->createAnimation(1.F, item.scale, MOVE, AVARDAMAGE_NONE);
+    g_pAnimationManager->createAnimation(1.F, item.alpha, FADE, AVARDAMAGE_NONE);
+}
+
 void CLiquidDock::rebuildDockItems() {
-    // Scan running windows and update items
+    // Full rescan, on init only; window events keep the items current afterwards
     auto& items = g_pGlobalState->items;
 
-    // Mark all non-pinned items as not running
+    m_windowApps.clear();
+    m_focusedApp.clear();
     for (auto& item : items) {
-        if (!item.pinned)
-            item.running = false;
+        item.windows = 0;
+        item.running = false;
         item.focused = false;
     }
+    std::erase_if(items, [](const SDockItem& item) { return !item.pinned; });
+    for (auto& item : items)
+        createItemAnimations(item);
+    indexItems();
 
-    // Track running windows
     for (auto& w : g_pCompositor->m_windows) {
         if (w->isHidden() || !w->m_isMapped)
             continue;
 
-        const std::string appId = w->m_initialClass;
-        if (appId.empty())
-            continue;
+        addWindow(w);
+    }
 
-        // Check if this app already exists in the dock
-        auto it = std::find_if(items.begin(), items.end(), [&appId](const SDockItem& item) { return item.appId == appId; });
+    if (const auto FOCUSED = Desktop::focusState()->window())
+        onWindowFocus(FOCUSED);
+}
 
-        if (it != items.end()) {
-            it->running = true;
-            if (w == Desktop::focusState()->window())
-                it->focused = true;
-        } else {
-            // Add new running app to dock
-            SDockItem newItem;
-            newItem.appId       = appId;
-            newItem.displayName = w->m_title.empty() ? appId : w->m_title;
-            newItem.running     = true;
-            newItem.focused     = (w == Desktop::focusState()->window());
-            items.push_back(std::move(newItem));
+void CLiquidDock::indexItems() {
+    auto& items = g_pGlobalState->items;
+
+    // Pins from the config may name an app that's already in the dock; fold them into one item
+    m_itemIndex.clear();
+    std::vector<SDockItem> unique;
+    unique.reserve(items.size());
+    for (auto& item : items) {
+        const auto IT = m_itemIndex.find(item.appId);
+        if (IT == m_itemIndex.end()) {
+            m_itemIndex[item.appId] = unique.size();
+            unique.push_back(std::move(item));
+            continue;
         }
+
+        auto& kept = unique[IT->second];
+        if (item.pinned) {
+            kept.pinned      = true;
+            kept.command     = item.command;
+            kept.displayName = item.displayName;
+        }
+        kept.windows += item.windows;
+        kept.running = kept.windows > 0;
+        kept.focused = kept.focused || item.focused;
+    }
+
+    if (unique.size() != items.size())
+        m_bItemsDirty = true;
+    items = std::move(unique);
+}
+
+SDockItem* CLiquidDock::findItem(const std::string& appId) {
+    const auto IT = m_itemIndex.find(appId);
+    return IT == m_itemIndex.end() ? nullptr : &g_pGlobalState->items[IT->second];
+}
+
+void CLiquidDock::addWindow(PHLWINDOW window) {
+    const std::string appId = window->m_initialClass;
+    if (appId.empty() || m_windowApps.contains(window.get()))
+        return;
+
+    m_windowApps[window.get()] = appId;
+
+    auto* item = findItem(appId);
+    if (!item) {
+        // New running app; appended, so every other index stays valid
+        SDockItem newItem;
+        newItem.appId       = appId;
+        newItem.displayName = window->m_title.empty() ? appId : window->m_title;
+        newItem.focused     = appId == m_focusedApp;
+        createItemAnimations(newItem);
+
+        m_itemIndex[appId] = g_pGlobalState->items.size();
+        g_pGlobalState->items.push_back(std::move(newItem));
+        item          = &g_pGlobalState->items.back();
+        m_bItemsDirty = true;
     }
 
-    // Remove non-pinned, non-running items
-    std::erase_if(items, [](const SDockItem& item) { return !item.pinned && !item.running; });
+    item->windows++;
+    item->running = true;
+}
+
+void CLiquidDock::removeWindow(PHLWINDOW window) {
+    const auto IT = m_windowApps.find(window.get());
+    if (IT == m_windowApps.end())
+        return;
+
+    const auto appId = IT->second;
+    m_windowApps.erase(IT);
+
+    auto* item = findItem(appId);
+    if (!item || --item->windows > 0)
+        return;
+
+    item->running = false;
+    if (!item->pinned)
+        removeItem(appId);
+}
+
+void CLiquidDock::removeItem(const std::string& appId) {
+    const auto IT = m_itemIndex.find(appId);
+    if (IT == m_itemIndex.end())
+        return;
+
+    // Everything after the item shifts down; the dock relayouts anyway
+    auto& items = g_pGlobalState->items;
+    items.erase(items.begin() + IT->second);
+    indexItems();
+    m_bItemsDirty = true;
 }
 
 void CLiquidDock::layoutIcons() {
@@ -324,16 +756,22 @@ void CLiquidDock::layoutIcons() {
         const float x = box.x + padding + i * (iconSize + spacing) + iconSize * 0.5F;
         const float y = box.y + box.h * 0.5F;
 
-        // Set target positions; Hyprland's animation system interpolates
         auto& item = g_pGlobalState->items[i];
-        if (item.position)
+        if (!item.position)
+            continue;
+
+        // A new item appears in its slot, so the first frame shows the whole
+        // dock in place; later moves go through Hyprland's animation system
+        if (!item.placed) {
+            item.position->setValueAndWarp(Vector2D{x, y});
+            item.size->setValueAndWarp(Vector2D{(float)iconSize, (float)iconSize});
+            item.placed = true;
+        } else {
             *item.position = Vector2D{x, y};
-        if (item.size)
-            *item.size = Vector2D{(float)iconSize, (float)iconSize};
-        if (item.scale)
-            *item.scale = 1.F;
-        if (item.alpha)
-            *item.alpha = 1.F;
+            *item.size     = Vector2D{(float)iconSize, (float)iconSize};
+        }
+        *item.scale = 1.F;
+        *item.alpha = 1.F;
     }
 }
 
@@ -373,17 +811,29 @@ float CLiquidDock::getMagnificationScale(int iconIndex, float cursorX) const {
 // ────────────────────────────────────────────────────────────────────────────
 
 void CLiquidDock::onWindowOpen(PHLWINDOW window) {
-    m_bItemsDirty = true;
+    damageLayoutBox();
+    addWindow(window);
     damageEntire();
 }
 
 void CLiquidDock::onWindowClose(PHLWINDOW window) {
-    m_bItemsDirty = true;
+    damageLayoutBox();
+    removeWindow(window);
     damageEntire();
 }
 
 void CLiquidDock::onWindowFocus(PHLWINDOW window) {
-    m_bItemsDirty = true;
+    const std::string appId = window ? window->m_initialClass : "";
+    if (appId == m_focusedApp)
+        return;
+
+    // Only the item losing focus and the one gaining it change
+    if (auto* item = findItem(m_focusedApp))
+        item->focused = false;
+    if (auto* item = findItem(appId))
+        item->focused = true;
+
+    m_focusedApp = appId;
     damageEntire();
 }
 
@@ -430,10 +880,11 @@ void CLiquidDock::onMouseButton(SCallbackInfo& info, IPointer::SButtonEvent e) {
         if (idx >= 0) {
             info.cancelled = true;
             auto& item = g_pGlobalState->items[idx];
+            damageLayoutBox();
             if (item.pinned) {
                 item.pinned = false;
                 if (!item.running)
-                    m_bItemsDirty = true;
+                    removeItem(std::string{item.appId}); // a copy: the item goes away
             } else {
                 item.pinned = true;
             }
@@ -443,19 +894,19 @@ void CLiquidDock::onMouseButton(SCallbackInfo& info, IPointer::SButtonEvent e) {
 }
 
 void CLiquidDock::onMouseMove(Vector2D coords) {
-    const auto box = dockBoxGlobal();
+    static auto* const PMAGNIFY = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:liquiddock:magnification")->getDataStaticPtr();
 
-    m_fCursorX = coords.x;
-    m_fCursorY = coords.y;
+    const auto box = dockBoxGlobal();
 
     bool wasHovered          = g_pGlobalState->dockHovered;
     g_pGlobalState->dockHovered = box.containsPoint(coords);
 
-    if (wasHovered != g_pGlobalState->dockHovered)
-        damageEntire();
+    // Magnification follows the cursor only while it is over the dock
+    const float prevCursorX = m_fCursorX;
+    m_fCursorX              = g_pGlobalState->dockHovered ? coords.x : -1.F;
+    m_fCursorY              = coords.y;
 
-    // Update magnification when cursor is over dock
-    if (g_pGlobalState->dockHovered)
+    if (wasHovered != g_pGlobalState->dockHovered || (**PMAGNIFY && m_fCursorX != prevCursorX))
         damageEntire();
 }
 
@@ -480,10 +931,90 @@ void CLiquidDock::launchApp(const SDockItem& item) {
     }
 }
 
+// ────────────────────────────────────────────────────────────────────────────
+// Icons
+// ────────────────────────────────────────────────────────────────────────────
+
+int CLiquidDock::onIconsReady(int fd, uint32_t mask, void* data) {
+    uint64_t count = 0;
+    [[maybe_unused]] const auto READ = read(fd, &count, sizeof(count));
+
+    // Uploads happen while rendering, within the per-frame budget
+    static_cast<CLiquidDock*>(data)->damageEntire();
+    return 0;
+}
+
+void CLiquidDock::requestIcons(PHLMONITOR monitor) {
+    static auto* const PICONSIZE     = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:liquiddock:icon_size")->getDataStaticPtr();
+    static auto* const PMAGNIFY      = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:liquiddock:magnification")->getDataStaticPtr();
+    static auto* const PMAGNIFYSCALE = (Hyprlang::FLOAT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:liquiddock:magnification_scale")->getDataStaticPtr();
+    static auto* const PICONTHEME    = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:liquiddock:icon_theme")->getDataStaticPtr();
+
+    // Decode at the largest size an icon is drawn at, so magnified icons stay sharp
+    const float maxScale  = **PMAGNIFY ? std::max(1.F, **PMAGNIFYSCALE) : 1.F;
+    const int   pixelSize = std::ceil(**PICONSIZE * maxScale * monitor->m_scale);
+
+    // A new size empties the atlas; every item below asks again
+    m_iconAtlas.setPixelSize(pixelSize);
+
+    for (auto& item : g_pGlobalState->items) {
+        if (item.iconPixelSize == pixelSize)
+            continue;
+
+        item.iconPixelSize = pixelSize;
+
+        // Current cache entries upload straight from the mapping, outside the
+        // upload budget, so a warm start shows every icon on its first frame
+        if (const auto* CACHED = m_iconLoader->cached(item.appId, *PICONTHEME, pixelSize)) {
+            item.iconPath = CACHED->path;
+            m_iconAtlas.store(item.appId, CACHED->pixels, CACHED->stride);
+            g_pGlobalState->iconsFromCache++;
+            continue;
+        }
+
+        m_iconLoader->request(item.appId, *PICONTHEME, pixelSize);
+    }
+}
+
+void CLiquidDock::uploadIcons() {
+    static auto* const PBUDGET = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:liquiddock:icon_upload_budget")->getDataStaticPtr();
+
+    for (const auto& icon : m_iconLoader->takeDecoded(std::max<Hyprlang::INT>(1, **PBUDGET))) {
+        bool wanted = false;
+        for (auto& item : g_pGlobalState->items) {
+            // Stale if the item went away or wants another size by now
+            if (item.appId != icon.appId || item.iconPixelSize != icon.pixelSize)
+                continue;
+
+            item.iconPath = icon.path;
+            wanted        = true;
+        }
+
+        // Items sharing an app id share its atlas cell
+        const uint8_t* PIXELS = icon.cached ? icon.cached->pixels : icon.pixels.data();
+        if (!wanted || (!icon.cached && icon.pixels.empty()) || !m_iconAtlas.store(icon.appId, PIXELS, icon.stride))
+            continue;
+
+        if (icon.cached)
+            g_pGlobalState->iconsFromCache++;
+        else
+            g_pGlobalState->iconsDecoded++;
+    }
+
+    // Cache hits from requestIcons included
+    m_iconAtlas.finishUploads();
+}
+
 // ────────────────────────────────────────────────────────────────────────────
 // Rendering
 // ────────────────────────────────────────────────────────────────────────────
 
+static uint64_t threadCpuNs() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
 void CLiquidDock::damageEntire() {
     const auto box = dockBoxGlobal();
     if (box.empty())
@@ -493,17 +1024,37 @@ void CLiquidDock::damageEntire() {
     g_pHyprRenderer->damageBox(box.copy().expand(DOT_MARGIN));
 }
 
+void CLiquidDock::damageLayoutBox() {
+    // dockBoxGlobal() follows the item count at once; the dock on screen keeps
+    // the box of the last layout until the next frame lays it out again
+    if (!m_layoutBox.empty())
+        g_pHyprRenderer->damageBox(m_layoutBox.copy().expand(DOT_MARGIN));
+}
+
+// Uploads data into a shape storage buffer, growing it first when it is too small
+static void uploadShapes(GLuint buffer, size_t& capacity, GLuint binding, const void* data, size_t bytes) {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    if (bytes > capacity) {
+        capacity = std::bit_ceil(bytes);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, capacity, nullptr, GL_DYNAMIC_DRAW);
+    }
+    if (bytes)
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, bytes, data);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, buffer);
+}
+
 void CLiquidDock::renderDockSDF(PHLMONITOR monitor, float alpha) {
     static auto* const PCOLOR          = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:liquiddock:dock_color")->getDataStaticPtr();
     static auto* const PICONSIZE       = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:liquiddock:icon_size")->getDataStaticPtr();
     static auto* const PTHRESHOLD      = (Hyprlang::FLOAT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:liquiddock:gooey_threshold")->getDataStaticPtr();
     static auto* const PINDICATORCOLOR = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:liquiddock:indicator_color")->getDataStaticPtr();
+    static auto* const PCACHE          = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:liquiddock:sdf_cache")->getDataStaticPtr();
 
-    if (!m_shaderProgram)
+    if (!m_shaderProgram || !m_shapeBuffers[0] || !m_quadVAO)
         return;
 
-    const int numIcons = std::min((int)g_pGlobalState->items.size(), 32);
-    if (numIcons == 0)
+    const auto& items = g_pGlobalState->items;
+    if (items.empty())
         return;
 
     const CBox globalBox = dockBoxGlobal();
@@ -518,112 +1069,165 @@ void CLiquidDock::renderDockSDF(PHLMONITOR monitor, float alpha) {
     const float renderH = renderBox.h;
     const int   iconSize = **PICONSIZE;
 
-    glUseProgram(m_shaderProgram);
-    GLint loc;
-
-    // Vertex shader uniforms: map quad to monitor-local coordinates
-    loc = glGetUniformLocation(m_shaderProgram, "u_topLeft");
-    glUniform2f(loc, localRenderBox.x, localRenderBox.y);
-    loc = glGetUniformLocation(m_shaderProgram, "u_fullSize");
-    glUniform2f(loc, localRenderBox.w, localRenderBox.h);
-    loc = glGetUniformLocation(m_shaderProgram, "u_monitorSize");
-    glUniform2f(loc, monitor->m_size.x, monitor->m_size.y);
-
-    // Fragment shader uniforms
-    loc = glGetUniformLocation(m_shaderProgram, "u_resolution");
-    glUniform2f(loc, renderW, renderH);
-
-    CHyprColor dockColor = **PCOLOR;
-    loc = glGetUniformLocation(m_shaderProgram, "u_dockColor");
-    glUniform4f(loc, dockColor.r, dockColor.g, dockColor.b, dockColor.a * alpha);
-
-    // Icon blobs — these merge together via smooth-min to form the dock
-    loc = glGetUniformLocation(m_shaderProgram, "u_numIcons");
-    glUniform1i(loc, numIcons);
-    loc = glGetUniformLocation(m_shaderProgram, "u_threshold");
-    glUniform1f(loc, **PTHRESHOLD);
-
-    for (int i = 0; i < numIcons; ++i) {
-        const auto& item = g_pGlobalState->items[i];
+    // Icon blobs — these merge together via smooth-min to form the dock —
+    // and the running indicator dots below them
+    m_shapes.icons.clear();
+    m_shapes.dots.clear();
+    for (size_t i = 0; i < items.size(); ++i) {
+        const auto& item = items[i];
         if (!item.position || !item.size)
             continue;
 
         // Icon positions relative to the render area
-        const auto globalPos = item.position->value();
-        const float posX = globalPos.x - renderBox.x;
-        const float posY = globalPos.y - renderBox.y;
+        const auto  globalPos = item.position->value();
+        const float posX      = globalPos.x - renderBox.x;
+        const float posY      = globalPos.y - renderBox.y;
 
         const float scale = getMagnificationScale(i, m_fCursorX);
-        const float sz = iconSize * scale;
+        const float sz    = iconSize * scale;
+
+        m_shapes.icons.push_back({posX, posY, sz, sz * 0.2F});
 
-        char buf[128];
-        snprintf(buf, sizeof(buf), "u_iconPositions[%d]", i);
-        loc = glGetUniformLocation(m_shaderProgram, buf);
-        glUniform2f(loc, posX, posY);
+        if (item.running)
+            m_shapes.dots.push_back({posX, posY + sz * 0.5F + DOT_OFFSET_Y, DOT_RADIUS, 0.F});
+    }
 
-        snprintf(buf, sizeof(buf), "u_iconSizes[%d]", i);
-        loc = glGetUniformLocation(m_shaderProgram, buf);
-        glUniform2f(loc, sz, sz);
+    if (m_boundedShapes) {
+        // Items past the uniform block's arrays are left out of the SDF
+        m_shapes.icons.resize(std::min(m_shapes.icons.size(), GOOEY_BOUNDED_SHAPES));
+        m_shapes.dots.resize(std::min(m_shapes.dots.size(), GOOEY_BOUNDED_SHAPES));
+        binShapesIntoTiles(m_shapes, renderW, **PTHRESHOLD, GOOEY_BOUNDED_TILES);
+    } else
+        binShapesIntoTiles(m_shapes, renderW, **PTHRESHOLD);
+
+    const SGooeyParams params = {
+        .resolution = {renderW, renderH},
+        .scale      = monitor->m_scale,
+        .threshold  = **PTHRESHOLD,
+        .dockColor  = **PCOLOR,
+        .dotColor   = **PINDICATORCOLOR,
+    };
 
-        snprintf(buf, sizeof(buf), "u_iconRoundings[%d]", i);
-        loc = glGetUniformLocation(m_shaderProgram, buf);
-        glUniform1f(loc, sz * 0.2F);
+    if (!**PCACHE || !m_cacheProgram) {
+        drawGooeyShapes(localRenderBox, monitor->m_size, params, alpha, true);
+        return;
     }
 
-    // Running indicator dots
-    int numDots = 0;
-    for (int i = 0; i < numIcons; ++i) {
-        const auto& item = g_pGlobalState->items[i];
-        if (!item.running || !item.position)
-            continue;
+    // Shapes are relative to the render area, so moving the dock alone keeps the cache valid
+    const Vector2D cacheSize = {std::ceil(renderW * params.scale), std::ceil(renderH * params.scale)};
+    if (!m_sdfCache.isAllocated() || m_sdfCache.m_size != cacheSize || params != m_cachedParams || m_shapes != m_cachedShapes) {
+        renderSDFCache(cacheSize, params);
+        g_pGlobalState->sdfCacheRenders++;
+    } else
+        g_pGlobalState->sdfCacheHits++;
 
-        const auto globalPos = item.position->value();
-        const float scale = getMagnificationScale(i, m_fCursorX);
-        const float half = iconSize * scale * 0.5F;
+    compositeSDFCache(localRenderBox, monitor->m_size, alpha);
+}
+
+void CLiquidDock::drawGooeyShapes(const CBox& target, const Vector2D& viewport, const SGooeyParams& params, float alpha, bool blend) {
+    glUseProgram(m_shaderProgram);
+
+    // Vertex shader uniforms: map quad to viewport-local coordinates
+    glUniform2f(m_uniforms.topLeft, target.x, target.y);
+    glUniform2f(m_uniforms.fullSize, target.w, target.h);
+    glUniform2f(m_uniforms.monitorSize, viewport.x, viewport.y);
+
+    // Fragment shader uniforms
+    glUniform2f(m_uniforms.resolution, params.resolution.x, params.resolution.y);
+
+    CHyprColor dockColor = params.dockColor;
+    glUniform4f(m_uniforms.dockColor, dockColor.r, dockColor.g, dockColor.b, dockColor.a * alpha);
+
+    glUniform1f(m_uniforms.threshold, params.threshold);
+    glUniform1f(m_uniforms.tileWidth, m_shapes.tileWidth);
+    glUniform1i(m_uniforms.numTiles, m_shapes.tiles.size());
+
+    CHyprColor indicatorColor = params.dotColor;
+    glUniform4f(m_uniforms.dotColor, indicatorColor.r, indicatorColor.g, indicatorColor.b, indicatorColor.a * alpha);
+
+    // One update per array; the tiles keep the shader inside what was uploaded
+    if (m_boundedShapes) {
+        // std140 gives the vec4 and ivec4 arrays a 16 byte stride, like the CPU side
+        constexpr size_t STRIDE = sizeof(SGooeyShapes::icons[0]);
+        glBindBuffer(GL_UNIFORM_BUFFER, m_shapeBuffers[0]);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, m_shapes.icons.size() * STRIDE, m_shapes.icons.data());
+        glBufferSubData(GL_UNIFORM_BUFFER, GOOEY_BOUNDED_SHAPES * STRIDE, m_shapes.dots.size() * STRIDE, m_shapes.dots.data());
+        glBufferSubData(GL_UNIFORM_BUFFER, 2 * GOOEY_BOUNDED_SHAPES * STRIDE, m_shapes.tiles.size() * STRIDE, m_shapes.tiles.data());
+        glBindBufferBase(GL_UNIFORM_BUFFER, SHAPES_BINDING, m_shapeBuffers[0]);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    } else {
+        uploadShapes(m_shapeBuffers[0], m_shapeBufferBytes[0], ICONS_BINDING, m_shapes.icons.data(), m_shapes.icons.size() * sizeof(m_shapes.icons[0]));
+        uploadShapes(m_shapeBuffers[1], m_shapeBufferBytes[1], DOTS_BINDING, m_shapes.dots.data(), m_shapes.dots.size() * sizeof(m_shapes.dots[0]));
+        uploadShapes(m_shapeBuffers[2], m_shapeBufferBytes[2], TILES_BINDING, m_shapes.tiles.data(), m_shapes.tiles.size() * sizeof(m_shapes.tiles[0]));
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
 
-        const float dotX = globalPos.x - renderBox.x;
-        const float dotY = globalPos.y + half + DOT_OFFSET_Y - renderBox.y;
+    // Draw quad mapped to the dock render area. Without blending the pass
+    // output is stored as is, for the cache to be blended once when composited.
+    glBindVertexArray(m_quadVAO);
 
-        char buf[128];
-        snprintf(buf, sizeof(buf), "u_dotPositions[%d]", numDots);
-        loc = glGetUniformLocation(m_shaderProgram, buf);
-        glUniform2f(loc, dotX, dotY);
+    glEnable(GL_BLEND);
+    if (blend)
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    else
+        glBlendFunc(GL_ONE, GL_ZERO);
 
-        snprintf(buf, sizeof(buf), "u_dotRadii[%d]", numDots);
-        loc = glGetUniformLocation(m_shaderProgram, buf);
-        glUniform1f(loc, DOT_RADIUS);
+    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
 
-        numDots++;
+    glBindVertexArray(0);
+    if (m_boundedShapes)
+        glBindBufferBase(GL_UNIFORM_BUFFER, SHAPES_BINDING, 0);
+    else {
+        for (const auto binding : {ICONS_BINDING, DOTS_BINDING, TILES_BINDING})
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, 0);
     }
-    loc = glGetUniformLocation(m_shaderProgram, "u_numDots");
-    glUniform1i(loc, numDots);
+    glUseProgram(0);
+}
 
-    CHyprColor indicatorColor = **PINDICATORCOLOR;
-    loc = glGetUniformLocation(m_shaderProgram, "u_dotColor");
-    glUniform4f(loc, indicatorColor.r, indicatorColor.g, indicatorColor.b, indicatorColor.a * alpha);
+void CLiquidDock::renderSDFCache(const Vector2D& size, const SGooeyParams& params) {
+    if (!m_sdfCache.isAllocated())
+        g_pGlobalState->glStats.objectsCreated += 2; // framebuffer and its texture
 
-    // Draw quad mapped to the dock render area
-    // clang-format off
-    float vertices[] = {
-        0.F, 0.F,  0.F, 0.F,
-        1.F, 0.F,  1.F, 0.F,
-        1.F, 1.F,  1.F, 1.F,
-        0.F, 1.F,  0.F, 1.F,
-    };
-    // clang-format on
+    m_sdfCache.alloc(size.x, size.y);
 
-    GLuint vao, vbo;
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
+    // The cache is redrawn whole, whatever part of the monitor is damaged
+    const bool scissor = glIsEnabled(GL_SCISSOR_TEST);
+    glDisable(GL_SCISSOR_TEST);
 
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    // Through Hyprland, which skips glViewport calls matching the last one it
+    // made; both changes have to go past it to keep that in step
+    std::array<GLint, 4> viewport = {};
+    glGetIntegerv(GL_VIEWPORT, viewport.data());
 
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+    m_sdfCache.bind();
+    g_pHyprOpenGL->setViewport(0, 0, size.x, size.y);
+    glClearColor(0.F, 0.F, 0.F, 0.F);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    drawGooeyShapes(CBox{{}, params.resolution}, params.resolution, params, 1.F, false);
+
+    g_pHyprOpenGL->m_renderData.currentFB->bind();
+    g_pHyprOpenGL->setViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    if (scissor)
+        glEnable(GL_SCISSOR_TEST);
+
+    m_cachedParams = params;
+    m_cachedShapes = m_shapes;
+}
+
+void CLiquidDock::compositeSDFCache(const CBox& target, const Vector2D& viewport, float alpha) {
+    glUseProgram(m_cacheProgram);
+
+    glUniform2f(m_cacheUniforms.topLeft, target.x, target.y);
+    glUniform2f(m_cacheUniforms.fullSize, target.w, target.h);
+    glUniform2f(m_cacheUniforms.monitorSize, viewport.x, viewport.y);
+    glUniform1i(m_cacheUniforms.tex, 0);
+    glUniform1f(m_cacheUniforms.alpha, alpha);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_sdfCache.getTexture()->m_texID);
+
+    glBindVertexArray(m_quadVAO);
 
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -631,17 +1235,19 @@ void CLiquidDock::renderDockSDF(PHLMONITOR monitor, float alpha) {
     glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
 
     glBindVertexArray(0);
-    glDeleteBuffers(1, &vbo);
-    glDeleteVertexArrays(1, &vao);
-
+    glBindTexture(GL_TEXTURE_2D, 0);
     glUseProgram(0);
 }
 
 void CLiquidDock::renderDockIcons(PHLMONITOR monitor, float alpha) {
     static auto* const PICONSIZE = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:liquiddock:icon_size")->getDataStaticPtr();
 
+    if (!m_iconProgram || !m_iconVAO)
+        return;
+
     const int iconSize = **PICONSIZE;
 
+    m_iconInstances.clear();
     for (size_t i = 0; i < g_pGlobalState->items.size(); ++i) {
         const auto& item = g_pGlobalState->items[i];
         if (!item.position)
@@ -652,17 +1258,83 @@ void CLiquidDock::renderDockIcons(PHLMONITOR monitor, float alpha) {
         const float sz    = iconSize * scale;
         const float half  = sz * 0.5F;
 
-        CBox iconBox = {pos.x - half - monitor->m_position.x, pos.y - half - monitor->m_position.y, sz, sz};
+        SIconInstance instance = {.box = {(float)(pos.x - half - monitor->m_position.x), (float)(pos.y - half - monitor->m_position.y), sz, sz}};
 
-        // Render icon texture if available, otherwise render a placeholder rounded rect
-        if (item.iconTex && item.iconTex->m_texID) {
-            g_pHyprOpenGL->renderTexture(item.iconTex, iconBox, {.a = alpha});
+        // Atlas icon if it arrived, otherwise a placeholder rounded rect
+        if (const auto UV = m_iconAtlas.uvRect(item.appId)) {
+            instance.uv       = *UV;
+            instance.color    = {1.F, 1.F, 1.F, alpha};
+            instance.textured = 1.F;
         } else {
-            // Placeholder: colored rounded square with first letter
-            CHyprColor iconColor = item.focused ? CHyprColor{0.4F, 0.6F, 1.F, alpha} : CHyprColor{0.5F, 0.5F, 0.5F, alpha};
-            g_pHyprOpenGL->renderRect(iconBox, iconColor, {.round = static_cast<int>(sz * 0.2F)});
+            instance.color  = item.focused ? std::array<float, 4>{0.4F, 0.6F, 1.F, alpha} : std::array<float, 4>{0.5F, 0.5F, 0.5F, alpha};
+            instance.radius = sz * 0.2F;
         }
+
+        m_iconInstances.push_back(instance);
+    }
+
+    if (m_iconInstances.empty())
+        return;
+
+    const size_t bytes = m_iconInstances.size() * sizeof(SIconInstance);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    if (bytes > m_instanceBytes) {
+        m_instanceBytes = std::bit_ceil(bytes);
+        glBufferData(GL_ARRAY_BUFFER, m_instanceBytes, nullptr, GL_DYNAMIC_DRAW);
     }
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, m_iconInstances.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glUseProgram(m_iconProgram);
+    glUniform2f(m_iconUniforms.monitorSize, monitor->m_size.x, monitor->m_size.y);
+    glUniform1i(m_iconUniforms.atlas, 0);
+
+    // Bound even while empty; placeholders never sample it
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_iconAtlas.texture());
+
+    glBindVertexArray(m_iconVAO);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, m_iconInstances.size());
+
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+}
+
+bool CLiquidDock::autoHidePending() const {
+    return m_bAutoHideActive && Time::steadyNow() - m_lastHoverTime < AUTOHIDE_DELAY;
+}
+
+int CLiquidDock::onAutoHideTimer(void* data) {
+    // The delay ran out: one frame to take the dock off screen
+    static_cast<CLiquidDock*>(data)->damageEntire();
+    return 0;
+}
+
+bool CLiquidDock::needsFrame() const {
+    const auto animating = [](const auto& var) { return var && var->isBeingAnimated(); };
+
+    if (animating(m_vPosition) || animating(m_vSize) || animating(m_fAlpha))
+        return true;
+
+    for (const auto& item : g_pGlobalState->items) {
+        if (animating(item.position) || animating(item.size) || animating(item.scale) || animating(item.alpha))
+            return true;
+    }
+
+    // Icons left over by the upload budget go up next frame
+    return m_iconLoader && m_iconLoader->hasDecoded();
+}
+
+void CLiquidDock::onConfigReloaded() {
+    // The reload dropped and re-added pinned items behind the index's back
+    indexItems();
+    m_bItemsDirty = true;
+    damageEntire();
 }
 
 void CLiquidDock::renderPass(PHLMONITOR monitor, float const& a) {
@@ -682,26 +1354,55 @@ void CLiquidDock::renderPass(PHLMONITOR monitor, float const& a) {
         if (!m_bAutoHideActive) {
             m_bAutoHideActive = true;
             m_lastHoverTime   = Time::steadyNow();
+            if (m_autoHideTimer)
+                wl_event_source_timer_update(m_autoHideTimer, AUTOHIDE_DELAY.count());
         }
-        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Time::steadyNow() - m_lastHoverTime).count();
-        if (elapsed > 1500) // Hide after 1.5s without hover
+        if (!autoHidePending()) {
+            // Hidden; nothing changes until hover or a window event damages the dock again
             return;
-    } else {
+        }
+    } else if (m_bAutoHideActive) {
         m_bAutoHideActive = false;
+        if (m_autoHideTimer)
+            wl_event_source_timer_update(m_autoHideTimer, 0);
     }
 
     // Update dock items only when state has changed
     if (m_bItemsDirty) {
-        rebuildDockItems();
+        const CBox oldBox = m_layoutBox;
+
         layoutIcons();
+        m_layoutBox   = dockBoxGlobal();
         m_bItemsDirty = false;
+
+        // The atlas only changes hands when the item set does
+        std::vector<std::string> appIds;
+        for (const auto& item : g_pGlobalState->items)
+            appIds.push_back(item.appId);
+        m_iconAtlas.retain(appIds);
+
+        // The dock resizes with its items: repaint both the area it left and the one it grew into
+        if (m_layoutBox != oldBox) {
+            g_pHyprRenderer->damageBox(oldBox.copy().expand(DOT_MARGIN));
+            damageEntire();
+        }
     }
 
+    requestIcons(monitor);
+    uploadIcons();
+
     // Render layers: SDF pass draws dock background, gooey blobs, and indicator dots
+    auto&      glStats  = g_pGlobalState->glStats;
+    const auto churn    = glStats.objectsCreated + glStats.objectsDeleted;
+    const auto sdfStart = threadCpuNs();
     renderDockSDF(monitor, a);
-    // Icon textures/placeholders are rendered separately on top
+    g_pGlobalState->sdfTiming.record(threadCpuNs() - sdfStart);
+    glStats.lastFrameChurn = glStats.objectsCreated + glStats.objectsDeleted - churn;
+    glStats.frameChurn += glStats.lastFrameChurn;
+    // Icons and placeholders go on top in one instanced draw
     renderDockIcons(monitor, a);
 
-    // Request damage so the dock area is redrawn next frame
-    damageEntire();
+    // Only ask for another frame while something is still moving; an idle dock draws nothing
+    if (needsFrame())
+        damageEntire();
 }
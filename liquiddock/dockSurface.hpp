@@ -3,10 +3,67 @@
 #define WLR_USE_UNSTABLE
 
 #include <hyprland/src/render/OpenGL.hpp>
+#include <hyprland/src/render/Framebuffer.hpp>
 #include <hyprland/src/devices/IPointer.hpp>
 #include <hyprland/src/helpers/AnimatedVariable.hpp>
 #include <hyprland/src/helpers/time/Time.hpp>
+#include <array>
+#include <unordered_map>
 #include "globals.hpp"
+#include "GooeyShapes.hpp"
+#include "IconAtlas.hpp"
+#include "IconLoader.hpp"
+
+// Creates the animated properties of a new dock item
+void createItemAnimations(SDockItem& item);
+
+// Everything besides the shapes that decides what the SDF pass draws
+struct SGooeyParams {
+    Vector2D      resolution;
+    double        scale     = 1.0;
+    float         threshold = 0.F;
+    Hyprlang::INT dockColor = 0;
+    Hyprlang::INT dotColor  = 0;
+
+    bool          operator==(const SGooeyParams&) const = default;
+};
+
+// Uniform locations of the gooey shader, resolved once at link time
+struct SGooeyUniforms {
+    GLint topLeft     = -1;
+    GLint fullSize    = -1;
+    GLint monitorSize = -1;
+    GLint resolution  = -1;
+    GLint dockColor   = -1;
+    GLint threshold   = -1;
+    GLint dotColor    = -1;
+    GLint tileWidth   = -1;
+    GLint numTiles    = -1;
+};
+
+// One icon, or its placeholder, in the instanced icon pass
+struct SIconInstance {
+    std::array<float, 4> box;            // monitor-local x, y, w, h
+    std::array<float, 4> uv;             // atlas u0, v0, u1, v1
+    std::array<float, 4> color;          // placeholder rgb, alpha
+    float                radius   = 0.F; // placeholder rounding
+    float                textured = 0.F; // 1 samples the atlas, 0 draws the placeholder
+};
+
+// Uniform locations of the icon shader
+struct SIconUniforms {
+    GLint monitorSize = -1;
+    GLint atlas       = -1;
+};
+
+// Uniform locations of the shader compositing the cached SDF
+struct SCacheUniforms {
+    GLint topLeft     = -1;
+    GLint fullSize    = -1;
+    GLint monitorSize = -1;
+    GLint tex         = -1;
+    GLint alpha       = -1;
+};
 
 class CLiquidDock {
   public:
@@ -20,6 +77,7 @@ class CLiquidDock {
     void         onWindowClose(PHLWINDOW window);
     void         onWindowFocus(PHLWINDOW window);
     void         damageEntire();
+    void         onConfigReloaded();
 
     WP<CLiquidDock> m_self;
 
@@ -32,16 +90,67 @@ class CLiquidDock {
     // Auto-hide state
     bool                 m_bAutoHideActive = false;
     Time::steady_tp      m_lastHoverTime   = Time::steadyNow();
+    wl_event_source*     m_autoHideTimer   = nullptr;
+    static int           onAutoHideTimer(void* data);
 
     // Shader program
     GLuint               m_shaderProgram = 0;
+    SGooeyUniforms       m_uniforms;
+    std::array<GLuint, 3> m_shapeBuffers     = {}; // icons, dots, tiles
+    std::array<size_t, 3> m_shapeBufferBytes = {};
+    bool                 m_boundedShapes    = false; // one DockShapes uniform buffer instead of three storage buffers
+    SGooeyShapes         m_shapes;
+    GLuint               m_quadVAO = 0;
+    GLuint               m_quadVBO = 0;
+
+    // SDF pass output, redrawn only when its inputs change (sdf_cache)
+    GLuint               m_cacheProgram = 0;
+    SCacheUniforms       m_cacheUniforms;
+    CFramebuffer         m_sdfCache;
+    SGooeyParams         m_cachedParams;
+    SGooeyShapes         m_cachedShapes;
+
+    // Icons: one atlas, drawn with one instanced call
+    GLuint               m_iconProgram = 0;
+    SIconUniforms        m_iconUniforms;
+    GLuint               m_iconVAO        = 0;
+    GLuint               m_instanceVBO    = 0;
+    size_t               m_instanceBytes  = 0;
+    std::vector<SIconInstance> m_iconInstances;
+    CIconAtlas           m_iconAtlas;
+
+    // Frame scheduling
+    bool                 needsFrame() const;
+    bool                 autoHidePending() const;
+    void                 damageLayoutBox();
 
     // Icon management
+    UP<CIconLoader>      m_iconLoader;
+    wl_event_source*     m_iconEventSource = nullptr;
+    static int           onIconsReady(int fd, uint32_t mask, void* data);
+    void                 requestIcons(PHLMONITOR monitor);
+    void                 uploadIcons();
     void                 rebuildDockItems();
+    void                 indexItems();
+    SDockItem*           findItem(const std::string& appId);
+    void                 addWindow(PHLWINDOW window);
+    void                 removeWindow(PHLWINDOW window);
+    void                 removeItem(const std::string& appId);
     void                 layoutIcons();
     void                 renderDockSDF(PHLMONITOR monitor, float alpha);
+    void                 drawGooeyShapes(const CBox& target, const Vector2D& viewport, const SGooeyParams& params, float alpha, bool blend);
+    void                 renderSDFCache(const Vector2D& size, const SGooeyParams& params);
+    void                 compositeSDFCache(const CBox& target, const Vector2D& viewport, float alpha);
     void                 renderDockIcons(PHLMONITOR monitor, float alpha);
 
+    // Item bookkeeping, kept current by the window events. Indices into
+    // g_pGlobalState->items, rebuilt only when items are removed or the
+    // config changes the pinned set.
+    std::unordered_map<std::string, size_t> m_itemIndex;
+    std::unordered_map<const void*, std::string> m_windowApps; // counted windows, by address, and the app they count for
+    std::string                             m_focusedApp;
+    CBox                                    m_layoutBox; // dock box at the last layout
+
     // Input handling
     void                 onMouseButton(SCallbackInfo& info, IPointer::SButtonEvent e);
     void                 onMouseMove(Vector2D coords);
@@ -53,6 +162,10 @@ class CLiquidDock {
 
     // Shader helpers
     void                 initShader();
+    void                 initQuad();
+    void                 initGooeyProgram();
+    void                 initCacheProgram();
+    void                 initIconProgram();
     void                 destroyShader();
 
     // Callbacks
@@ -4,6 +4,9 @@
 #include <hyprland/src/render/Texture.hpp>
 #include <hyprland/src/helpers/AnimatedVariable.hpp>
 
+#include <algorithm>
+#include <array>
+
 inline HANDLE PHANDLE = nullptr;
 
 // Represents a single item in the dock (pinned app, running app, or custom button)
@@ -15,23 +18,58 @@ struct SDockItem {
     bool        pinned  = false;
     bool        running = false;
     bool        focused = false;
-    SP<CTexture> iconTex;
+    int         windows = 0; // mapped windows of this app; running while above zero
+    int          iconPixelSize = 0; // size the icon was last requested at; the icon itself lives in the dock's atlas
 
-    // Animated properties for physics-based animation
+    // Animated properties for physics-based animation, created with the item
+    // by createItemAnimations()
     PHLANIMVAR<Vector2D> position;
     PHLANIMVAR<Vector2D> size;
     PHLANIMVAR<float>    scale;
     PHLANIMVAR<float>    alpha;
+    bool                 placed = false; // warped to its first layout slot
 };
 
 class CLiquidDock;
 
+// GL objects the dock has created and deleted. Render-time churn should stay
+// at zero: everything the SDF pass draws with lives as long as the shader.
+struct SGlObjectStats {
+    uint64_t objectsCreated = 0;
+    uint64_t objectsDeleted = 0;
+    uint64_t frameChurn     = 0; // created + deleted while rendering, all frames
+    uint64_t lastFrameChurn = 0;
+};
+
+// CPU time spent building and submitting the SDF pass, over the last FRAMES frames
+struct SSdfPassTiming {
+    static constexpr size_t        FRAMES = 240;
+
+    std::array<uint64_t, FRAMES>   samplesNs = {};
+    size_t                         head      = 0;
+    size_t                         count     = 0;
+    uint64_t                       frames    = 0;
+
+    void record(uint64_t ns) {
+        samplesNs[head] = ns;
+        head            = (head + 1) % FRAMES;
+        count           = std::min(count + 1, FRAMES);
+        frames++;
+    }
+};
+
 struct SGlobalState {
-    WP<CLiquidDock>         dock;
+    SP<CLiquidDock>         dock; // owned until PLUGIN_EXIT
     std::vector<SDockItem>  items;
     int                     dragIndex     = -1;
     bool                    dockVisible   = true;
     bool                    dockHovered   = false;
+    SSdfPassTiming          sdfTiming;
+    SGlObjectStats          glStats;
+    uint64_t                sdfCacheHits    = 0;
+    uint64_t                sdfCacheRenders = 0;
+    uint64_t                iconsFromCache  = 0;
+    uint64_t                iconsDecoded    = 0;
 };
 
 inline UP<SGlobalState> g_pGlobalState;
@@ -2,7 +2,10 @@
 
 #include <unistd.h>
 
+#include <algorithm>
 #include <any>
+#include <format>
+#include <vector>
 #include <hyprland/src/Compositor.hpp>
 #include <hyprland/src/SharedDefs.hpp>
 #include <hyprland/src/desktop/view/Window.hpp>
@@ -22,21 +25,21 @@ APICALL EXPORT std::string PLUGIN_API_VERSION() {
 static void onNewWindow(void* self, std::any data) {
     const auto PWINDOW = std::any_cast<PHLWINDOW>(data);
 
-    if (auto dock = g_pGlobalState->dock.lock())
+    if (auto dock = g_pGlobalState->dock)
         dock->onWindowOpen(PWINDOW);
 }
 
 static void onCloseWindow(void* self, std::any data) {
     const auto PWINDOW = std::any_cast<PHLWINDOW>(data);
 
-    if (auto dock = g_pGlobalState->dock.lock())
+    if (auto dock = g_pGlobalState->dock)
         dock->onWindowClose(PWINDOW);
 }
 
 static void onWindowFocus(void* self, std::any data) {
     const auto PWINDOW = std::any_cast<PHLWINDOW>(data);
 
-    if (auto dock = g_pGlobalState->dock.lock())
+    if (auto dock = g_pGlobalState->dock)
         dock->onWindowFocus(PWINDOW);
 }
 
@@ -57,6 +60,7 @@ Hyprlang::CParseResult onPinnedApp(const char* K, const char* V) {
     item.command     = vars.size() > 1 ? vars[1] : vars[0];
     item.displayName = vars.size() > 2 ? vars[2] : vars[0];
     item.pinned      = true;
+    createItemAnimations(item);
 
     g_pGlobalState->items.push_back(std::move(item));
 
@@ -68,6 +72,34 @@ static void onPreConfigReload() {
     std::erase_if(g_pGlobalState->items, [](const SDockItem& item) { return item.pinned && !item.running; });
 }
 
+static std::string onStatsCommand(eHyprCtlOutputFormat format, std::string request) {
+    const auto&           TIMING = g_pGlobalState->sdfTiming;
+    const auto&           GL     = g_pGlobalState->glStats;
+    std::vector<uint64_t> samples(TIMING.samplesNs.begin(), TIMING.samplesNs.begin() + TIMING.count);
+    std::ranges::sort(samples);
+
+    double meanUs = 0.0;
+    for (const auto NS : samples)
+        meanUs += NS / 1000.0;
+    if (!samples.empty())
+        meanUs /= samples.size();
+
+    const auto percentileUs = [&](double p) { return samples.empty() ? 0.0 : samples[(size_t)(p * (samples.size() - 1))] / 1000.0; };
+
+    if (format == eHyprCtlOutputFormat::FORMAT_JSON)
+        return std::format(R"({{"items": {}, "frames": {}, "sdfPass": {{"samples": {}, "meanUs": {:.2f}, "p50Us": {:.2f}, "p99Us": {:.2f}, "maxUs": {:.2f}}}, )"
+                           R"("glObjects": {{"created": {}, "deleted": {}, "frameChurn": {}, "lastFrameChurn": {}}}, "sdfCache": {{"hits": {}, "renders": {}}}, "icons": {{"fromCache": {}, "decoded": {}}}}})",
+                           g_pGlobalState->items.size(), TIMING.frames, samples.size(), meanUs, percentileUs(0.5), percentileUs(0.99), percentileUs(1.0), GL.objectsCreated,
+                           GL.objectsDeleted, GL.frameChurn, GL.lastFrameChurn, g_pGlobalState->sdfCacheHits, g_pGlobalState->sdfCacheRenders,
+                           g_pGlobalState->iconsFromCache, g_pGlobalState->iconsDecoded);
+
+    return std::format("items: {}\nframes: {}\nsdf pass cpu time over the last {} frames: mean {:.2f}us, p50 {:.2f}us, p99 {:.2f}us, max {:.2f}us\n"
+                       "gl objects: {} created, {} deleted, {} during frames ({} last frame)\nsdf cache: {} hits, {} renders\nicons: {} from cache, {} decoded\n",
+                       g_pGlobalState->items.size(), TIMING.frames, samples.size(), meanUs, percentileUs(0.5), percentileUs(0.99), percentileUs(1.0), GL.objectsCreated,
+                       GL.objectsDeleted, GL.frameChurn, GL.lastFrameChurn, g_pGlobalState->sdfCacheHits, g_pGlobalState->sdfCacheRenders,
+                       g_pGlobalState->iconsFromCache, g_pGlobalState->iconsDecoded);
+}
+
 APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
     PHANDLE = handle;
 
@@ -92,13 +124,19 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
         if (stage != RENDER_POST_WINDOWS)
             return;
 
-        auto dock = g_pGlobalState->dock.lock();
+        auto dock = g_pGlobalState->dock;
         if (!dock)
             return;
 
         auto passData = CDockPassElement::SDockData{dock.get(), 1.F};
         g_pHyprRenderer->m_renderPass.add(makeUnique<CDockPassElement>(passData));
     });
+    static auto P6 = HyprlandAPI::registerCallbackDynamic(PHANDLE, "configReloaded", [&](void* self, SCallbackInfo& info, std::any data) {
+        if (auto dock = g_pGlobalState->dock)
+            dock->onConfigReloaded();
+    });
+
+    HyprlandAPI::registerHyprCtlCommand(PHANDLE, SHyprCtlCommand{.name = "liquiddockstats", .exact = true, .fn = onStatsCommand});
 
     // Register configuration values
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:liquiddock:enabled", Hyprlang::INT{1});
@@ -116,11 +154,14 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:liquiddock:magnification_scale", Hyprlang::FLOAT{1.5F});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:liquiddock:gooey_effect", Hyprlang::INT{1});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:liquiddock:gooey_threshold", Hyprlang::FLOAT{15.F});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:liquiddock:sdf_cache", Hyprlang::INT{0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:liquiddock:icon_theme", Hyprlang::STRING{""});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:liquiddock:icon_upload_budget", Hyprlang::INT{2});
 
     // Register custom keyword for pinning apps
     HyprlandAPI::addConfigKeyword(PHANDLE, "plugin:liquiddock:liquiddock-pin", onPinnedApp, Hyprlang::SHandlerOptions{});
 
-    // Create the dock
+    // Create the dock; the global state owns it until PLUGIN_EXIT
     auto dock          = makeShared<CLiquidDock>();
     g_pGlobalState->dock = dock;
 
@@ -139,5 +180,7 @@ APICALL EXPORT void PLUGIN_EXIT() {
 
     g_pHyprRenderer->m_renderPass.removeAllOfType("CDockPassElement");
 
+    // Tear the dock down while the items it reads are still there
+    g_pGlobalState->dock.reset();
     g_pGlobalState.reset();
 }
@@ -0,0 +1,107 @@
+// Stresses the SDF data path with synthetic docks of 8, 32, 128 and 512
+// items: times packing and tile binning on the CPU and reports how many
+// blobs a fragment blends per tile, which is what the shader pays per pixel.
+// Needs no GPU or compositor.
+//
+// usage: liquiddock-bench [-j]
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <format>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../GooeyShapes.hpp"
+
+namespace {
+constexpr std::array<size_t, 4> ITEMCOUNTS  = {8, 32, 128, 512};
+constexpr float                 ICONSIZE    = 48.F;
+constexpr float                 SPACING     = 8.F;
+constexpr float                 PADDING     = 8.F;
+constexpr float                 THRESHOLD   = 15.F;
+constexpr float                 MAXSCALE    = 1.5F;
+constexpr auto                  MINDURATION = std::chrono::milliseconds(20);
+
+// Keeps the measured work from being optimized away.
+volatile size_t g_sink = 0;
+
+struct SBenchResult {
+    size_t items      = 0;
+    size_t tiles      = 0;
+    size_t iterations = 0;
+    double nsPerFrame = 0.0;
+    double meanBlobs  = 0.0; // icons blended per tile, averaged over tiles
+    size_t maxBlobs   = 0;
+};
+
+// Lays the dock out the way layoutIcons does, magnified around the middle
+// as if the cursor hovered there, with every other app running.
+void buildShapes(SGooeyShapes& shapes, size_t count, float& renderWidth) {
+    renderWidth         = count * ICONSIZE + (count - 1) * SPACING + 2 * PADDING;
+    const float CURSORX = renderWidth / 2.F;
+
+    shapes.icons.clear();
+    shapes.dots.clear();
+    for (size_t i = 0; i < count; ++i) {
+        const float x      = PADDING + i * (ICONSIZE + SPACING) + ICONSIZE * 0.5F;
+        const float factor = std::max(0.F, 1.F - std::abs(CURSORX - x) / 150.F);
+        const float sz     = ICONSIZE * (1.F + (MAXSCALE - 1.F) * factor * factor);
+
+        shapes.icons.push_back({x, 42.F, sz, sz * 0.2F});
+        if (i % 2 == 0)
+            shapes.dots.push_back({x, 42.F + sz * 0.5F + 4.F, 2.5F, 0.F});
+    }
+
+    binShapesIntoTiles(shapes, renderWidth, THRESHOLD);
+}
+}
+
+int main(int argc, char** argv) {
+    const bool                json = argc > 1 && std::string_view{argv[1]} == "-j";
+    std::vector<SBenchResult> results;
+
+    for (const auto COUNT : ITEMCOUNTS) {
+        SGooeyShapes shapes;
+        float        renderWidth = 0.F;
+
+        size_t     iterations = 0;
+        const auto START      = std::chrono::steady_clock::now();
+        auto       elapsed    = std::chrono::steady_clock::duration{};
+        while (elapsed < MINDURATION) {
+            buildShapes(shapes, COUNT, renderWidth);
+            g_sink = g_sink + shapes.tiles.size();
+
+            iterations++;
+            elapsed = std::chrono::steady_clock::now() - START;
+        }
+
+        SBenchResult result = {.items = COUNT, .tiles = shapes.tiles.size(), .iterations = iterations};
+        result.nsPerFrame   = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+
+        for (const auto& tile : shapes.tiles) {
+            result.meanBlobs += tile[1];
+            result.maxBlobs = std::max(result.maxBlobs, (size_t)tile[1]);
+        }
+        result.meanBlobs /= shapes.tiles.size();
+
+        results.push_back(result);
+    }
+
+    std::string out = json ? "[" : "";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& R = results[i];
+        if (json)
+            out += std::format(R"({}{{"items": {}, "tiles": {}, "iterations": {}, "nsPerFrame": {:.2f}, "meanBlobsPerTile": {:.2f}, "maxBlobsPerTile": {}}})", i ? "," : "",
+                               R.items, R.tiles, R.iterations, R.nsPerFrame, R.meanBlobs, R.maxBlobs);
+        else
+            out += std::format("{:>4} items {:>4} tiles {:>12.2f} ns/frame, blobs per pixel: mean {:.2f}, max {} ({} iterations)\n", R.items, R.tiles, R.nsPerFrame,
+                               R.meanBlobs, R.maxBlobs, R.iterations);
+    }
+
+    std::fputs((json ? out + "]\n" : out).c_str(), stdout);
+    return 0;
+}
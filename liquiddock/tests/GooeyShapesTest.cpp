@@ -0,0 +1,124 @@
+// Checks binShapesIntoTiles: every tile's icon and dot ranges cover exactly
+// the shapes whose reach touches it, the reach is half the icon size plus
+// the threshold plus a pixel, and the maxTiles cap widens the tiles instead
+// of dropping shapes.
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "../GooeyShapes.hpp"
+
+namespace {
+constexpr float THRESHOLD = 15.F;
+
+int             g_failures = 0;
+
+void expect(bool ok, const char* what, size_t tile, double got, double want) {
+    if (ok)
+        return;
+
+    std::printf("FAIL %s: tile %zu: %.3f, want %.3f\n", what, tile, got, want);
+    g_failures++;
+}
+
+bool reaches(float centerX, float reach, size_t tile, float tileWidth) {
+    return centerX - reach < (tile + 1) * tileWidth && centerX + reach >= tile * tileWidth;
+}
+
+// The range of shapes reaching each tile, recomputed by brute force, must be
+// what the tile stores. Shapes are laid out left to right, so it is exact.
+void checkRanges(const SGooeyShapes& shapes) {
+    for (size_t t = 0; t < shapes.tiles.size(); ++t) {
+        int firstIcon = -1, lastIcon = -1, firstDot = -1, lastDot = -1;
+
+        for (size_t i = 0; i < shapes.icons.size(); ++i) {
+            if (!reaches(shapes.icons[i][0], shapes.icons[i][2] * 0.5F + THRESHOLD + 1.F, t, shapes.tileWidth))
+                continue;
+            firstIcon = firstIcon < 0 ? (int)i : firstIcon;
+            lastIcon  = (int)i;
+        }
+
+        for (size_t i = 0; i < shapes.dots.size(); ++i) {
+            if (!reaches(shapes.dots[i][0], shapes.dots[i][2] + 1.F, t, shapes.tileWidth))
+                continue;
+            firstDot = firstDot < 0 ? (int)i : firstDot;
+            lastDot  = (int)i;
+        }
+
+        const auto& TILE = shapes.tiles[t];
+        expect(TILE[1] == (firstIcon < 0 ? 0 : lastIcon - firstIcon + 1), "icon count", t, TILE[1], firstIcon < 0 ? 0 : lastIcon - firstIcon + 1);
+        expect(TILE[3] == (firstDot < 0 ? 0 : lastDot - firstDot + 1), "dot count", t, TILE[3], firstDot < 0 ? 0 : lastDot - firstDot + 1);
+        if (firstIcon >= 0)
+            expect(TILE[0] == firstIcon, "first icon", t, TILE[0], firstIcon);
+        if (firstDot >= 0)
+            expect(TILE[2] == firstDot, "first dot", t, TILE[2], firstDot);
+    }
+}
+
+// A dock of count 48px icons, the middle ones magnified, with a dot under
+// every other one. Returns its width.
+float buildDock(SGooeyShapes& shapes, size_t count) {
+    constexpr float ICONSIZE = 48.F, SPACING = 8.F, PADDING = 8.F;
+
+    const float     width = count * ICONSIZE + (count - 1) * SPACING + 2 * PADDING;
+    for (size_t i = 0; i < count; ++i) {
+        const float x      = PADDING + i * (ICONSIZE + SPACING) + ICONSIZE * 0.5F;
+        const float factor = std::fmax(0.F, 1.F - std::fabs(width / 2.F - x) / 150.F);
+        const float sz     = ICONSIZE * (1.F + 0.5F * factor * factor);
+
+        shapes.icons.push_back({x, 42.F, sz, sz * 0.2F});
+        if (i % 2 == 0)
+            shapes.dots.push_back({x, 42.F + sz * 0.5F + 4.F, 2.5F, 0.F});
+    }
+    return width;
+}
+}
+
+int main() {
+    // One 20px icon at x = 100 reaches 10 + 15 + 1 = 26px either side, so
+    // [74, 126]: tiles 2 and 3 of 32px, not 1 or 4.
+    {
+        SGooeyShapes shapes;
+        shapes.icons.push_back({100.F, 40.F, 20.F, 4.F});
+        binShapesIntoTiles(shapes, 320.F, THRESHOLD);
+
+        expect(shapes.tiles.size() == 10, "tile count", 0, shapes.tiles.size(), 10);
+        expect(shapes.tileWidth == GOOEY_TILE_WIDTH, "tile width", 0, shapes.tileWidth, GOOEY_TILE_WIDTH);
+        for (size_t t = 0; t < shapes.tiles.size(); ++t)
+            expect(shapes.tiles[t][1] == (t == 2 || t == 3 ? 1 : 0), "single icon reach", t, shapes.tiles[t][1], t == 2 || t == 3);
+    }
+
+    // Real docks, short and long.
+    for (const size_t COUNT : {1, 8, 128}) {
+        SGooeyShapes shapes;
+        binShapesIntoTiles(shapes, buildDock(shapes, COUNT), THRESHOLD);
+        checkRanges(shapes);
+    }
+
+    // The uniform block fallback caps the tiles; they widen to still cover
+    // the whole dock, and every shape still lands in the tiles it reaches.
+    {
+        SGooeyShapes shapes;
+        const float  WIDTH = buildDock(shapes, 128);
+        binShapesIntoTiles(shapes, WIDTH, THRESHOLD, GOOEY_BOUNDED_TILES);
+
+        expect(shapes.tiles.size() == GOOEY_BOUNDED_TILES, "capped tile count", 0, shapes.tiles.size(), GOOEY_BOUNDED_TILES);
+        expect(std::fabs(shapes.tileWidth * GOOEY_BOUNDED_TILES - WIDTH) < 0.01F, "capped tiles span the dock", 0, shapes.tileWidth * GOOEY_BOUNDED_TILES, WIDTH);
+        expect(shapes.tileWidth > GOOEY_TILE_WIDTH, "capped tiles widen", 0, shapes.tileWidth, GOOEY_TILE_WIDTH);
+        checkRanges(shapes);
+    }
+
+    // Nothing to draw still gets one empty tile for the shader.
+    {
+        SGooeyShapes shapes;
+        binShapesIntoTiles(shapes, 0.F, THRESHOLD);
+        expect(shapes.tiles.size() == 1 && shapes.tiles[0][1] == 0 && shapes.tiles[0][3] == 0, "empty dock", 0, shapes.tiles.size(), 1);
+    }
+
+    if (g_failures)
+        return 1;
+
+    std::printf("tiles hold exactly the shapes that reach them, capped or not\n");
+    return 0;
+}
@@ -0,0 +1,173 @@
+// Writes an icons.bin, maps it back and checks every record comes back as
+// written; then truncates and corrupts the file in the ways a crash or a
+// foreign file would, and checks each gives an empty cache rather than
+// records pointing outside the mapping.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../IconCache.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+constexpr size_t HEADERSIZE = 32;
+constexpr size_t ENTRYSIZE  = 56;
+
+int              g_failures = 0;
+
+void expect(bool ok, const char* what) {
+    if (ok)
+        return;
+
+    std::printf("FAIL %s\n", what);
+    g_failures++;
+}
+
+struct STestIcon {
+    std::string          appId;
+    std::string          theme;
+    std::string          path;
+    int                  pixelSize = 0;
+    std::vector<uint8_t> pixels;
+};
+
+std::vector<STestIcon> testIcons() {
+    std::vector<STestIcon> icons;
+    for (const int SIZE : {16, 48, 72}) {
+        STestIcon icon = {.appId = "app" + std::to_string(SIZE), .theme = SIZE == 48 ? "" : "Papirus", .path = "/icons/" + std::to_string(SIZE) + ".png", .pixelSize = SIZE};
+        icon.pixels.resize((size_t)SIZE * SIZE * 4);
+        for (size_t i = 0; i < icon.pixels.size(); ++i)
+            icon.pixels[i] = (uint8_t)(i * 7 + SIZE);
+        icons.push_back(std::move(icon));
+    }
+    return icons;
+}
+
+std::vector<char> readFile(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+void writeFile(const fs::path& path, const std::vector<char>& bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), bytes.size());
+}
+
+// Puts bytes in place of icons.bin and checks they map to nothing.
+void expectEmpty(const fs::path& path, std::vector<char> bytes, const char* what) {
+    writeFile(path, bytes);
+    const CIconCache CACHE;
+    expect(CACHE.records().empty() && !CACHE.find("app16", "Papirus", 16), what);
+}
+
+void patch32(std::vector<char>& bytes, size_t offset, uint32_t value) {
+    std::memcpy(bytes.data() + offset, &value, sizeof(value));
+}
+}
+
+int main() {
+    char dir[] = "/tmp/liquiddock-cache-test-XXXXXX";
+    if (!mkdtemp(dir)) {
+        std::printf("FAIL mkdtemp\n");
+        return 1;
+    }
+    setenv("XDG_CACHE_HOME", dir, 1);
+    const fs::path PATH = fs::path(iconCacheDir()) / "icons.bin";
+
+    // A missing file is an empty cache
+    {
+        const CIconCache CACHE;
+        expect(CACHE.records().empty(), "missing file");
+    }
+
+    const auto                    ICONS = testIcons();
+    std::vector<SIconCacheRecord> records;
+    for (const auto& icon : ICONS) {
+        records.push_back({.appId      = icon.appId,
+                           .theme      = icon.theme,
+                           .path       = icon.path,
+                           .pixelSize  = icon.pixelSize,
+                           .stride     = icon.pixelSize * 4,
+                           .themeStamp = 1000 + icon.pixelSize,
+                           .iconMtime  = -icon.pixelSize,
+                           .pixels     = icon.pixels.data()});
+    }
+    expect(CIconCache::write(records), "write");
+
+    // Round trip: every record, its stamps and its pixels, found by key
+    {
+        const CIconCache CACHE;
+        expect(CACHE.records().size() == ICONS.size(), "record count");
+        for (const auto& icon : ICONS) {
+            const auto* REC = CACHE.find(icon.appId, icon.theme, icon.pixelSize);
+            expect(REC != nullptr, "find");
+            if (!REC)
+                continue;
+
+            expect(REC->path == icon.path, "path");
+            expect(REC->stride == icon.pixelSize * 4, "stride");
+            expect(REC->themeStamp == 1000 + icon.pixelSize && REC->iconMtime == -icon.pixelSize, "stamps");
+            expect(std::memcmp(REC->pixels, icon.pixels.data(), icon.pixels.size()) == 0, "pixels");
+            expect((uintptr_t)REC->pixels % 64 == 0, "pixel rows aligned");
+        }
+        expect(!CACHE.find("app16", "", 16) && !CACHE.find("app48", "", 64), "no match for another theme or size");
+    }
+
+    const auto GOOD = readFile(PATH);
+
+    // Truncated anywhere: in the header, the entries, the strings or the
+    // last icon's pixels
+    for (const size_t SIZE : {(size_t)0, HEADERSIZE - 1, HEADERSIZE + ENTRYSIZE, HEADERSIZE + 3 * ENTRYSIZE + 4, GOOD.size() - 1}) {
+        auto bytes = GOOD;
+        bytes.resize(SIZE);
+        expectEmpty(PATH, bytes, "truncated file");
+    }
+
+    // Another magic or version
+    {
+        auto bytes = GOOD;
+        bytes[0]   = 'X';
+        expectEmpty(PATH, bytes, "foreign magic");
+        bytes = GOOD;
+        patch32(bytes, 4, 99);
+        expectEmpty(PATH, bytes, "other version");
+    }
+
+    // More entries than the header has room for
+    {
+        auto bytes = GOOD;
+        patch32(bytes, 8, 1000);
+        expectEmpty(PATH, bytes, "entry count past the string table");
+    }
+
+    // One entry pointing outside the file: a string, or its pixels. The
+    // others are fine, but a damaged entry means nothing is trusted.
+    {
+        auto bytes = GOOD;
+        patch32(bytes, HEADERSIZE + ENTRYSIZE + 4, 0xFFFFFF); // second entry's app id length
+        expectEmpty(PATH, bytes, "string out of bounds");
+
+        bytes = GOOD;
+        patch32(bytes, HEADERSIZE + 2 * ENTRYSIZE + 32, 0x7FFFFFF0); // third entry's pixel offset, low half
+        expectEmpty(PATH, bytes, "pixels out of bounds");
+
+        bytes = GOOD;
+        patch32(bytes, HEADERSIZE + 28, 4); // first entry's stride, narrower than a row
+        expectEmpty(PATH, bytes, "stride too small");
+    }
+
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+
+    if (g_failures)
+        return 1;
+
+    std::printf("icons.bin round-trips, and damaged files map to an empty cache\n");
+    return 0;
+}